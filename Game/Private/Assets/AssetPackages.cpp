@@ -0,0 +1,57 @@
+#include "Assets/AssetPackages.h"
+
+#include <HalfPipe/Source/Public/HPPackage.h>
+#include <Shared/FileUtils/PathUtils.h>
+#include <Shared/Logging/Logging.h>
+
+#include <filesystem>
+
+namespace AssetPackages
+{
+
+struct AssetPackagesGlobals_s
+{
+	// Its loose dir is the cooked dir, so packaged and loose cooked assets are named the same way
+	HPAssetReader_c CookedReader;
+
+	// With / separators and ending in one, empty until mounted
+	std::wstring CookedDir;
+
+	// Mounts nothing, reads paths outside the cooked dir as they are
+	HPAssetReader_c LooseReader;
+} G;
+
+std::wstring NormalizePath(const std::wstring& Path)
+{
+	return std::filesystem::path(Path).lexically_normal().generic_wstring();
+}
+
+uint32_t Mount(const Path_s& CookedDir)
+{
+	G.CookedReader.UnmountAll();
+
+	G.CookedDir = NormalizePath(CookedDir.ToWString());
+	if (!G.CookedDir.empty() && G.CookedDir.back() != L'/')
+	{
+		G.CookedDir += L'/';
+	}
+
+	G.CookedReader.SetLooseDir(G.CookedDir);
+
+	const uint32_t MountCount = G.CookedReader.MountPackagesInDir(G.CookedDir);
+	LOGINFO("[AssetPackages] Mounted %u packages from %S", MountCount, G.CookedDir.c_str());
+	return MountCount;
+}
+
+bool Load(const std::wstring& Path, HPAssetBytes_s& OutAsset)
+{
+	const std::wstring NormalizedPath = NormalizePath(Path);
+	if (!G.CookedDir.empty() && NormalizedPath.starts_with(G.CookedDir))
+	{
+		return G.CookedReader.Load(NormalizedPath.substr(G.CookedDir.size()), OutAsset);
+	}
+
+	return G.LooseReader.Load(Path, OutAsset);
+}
+
+}
@@ -1,9 +1,11 @@
 #include "Assets/MeshManager.h"
 
+#include "Assets/AssetPackages.h"
 #include "Assets/MaterialManager.h"
 #include "Rendering/Materials.h"
 #include "Rendering/Mesh.h"
 
+#include <HalfPipe/Source/Public/HPPackage.h>
 #include <HalfPipe/Source/Public/WaveFrontReader.h>
 #include <Shared/FileUtils/PathUtils.h>
 #include <Shared/FileUtils/JsonValue.h>
@@ -12,6 +14,7 @@
 #include <Render/Render.h>
 #include <SurfMath.h>
 
+#include <mutex>
 #include <unordered_map>
 
 #define MESH_ASSET_VERSION_INITIAL 1
@@ -20,47 +23,93 @@
 namespace MeshManager
 {
 
+// CPU side of a mesh, everything read from the source file ahead of creating GPU resources
+struct MeshSourceData_s
+{
+	std::vector<float3> Positions;
+	std::vector<uint32_t> Indices; // Grouped by surface
+	std::vector<uint32_t> SurfaceIndexCounts;
+	AABB Bounds = {};
+};
+
+struct PrefetchedMesh_s
+{
+	Json_t Data;
+	MeshSourceData_s Source;
+
+	// PrefetchMesh calls not released yet, dropped when this reaches zero before anything requested it
+	uint32_t HoldCount = 0;
+};
+
 struct MeshManagerGlobals_s
 {
 	// Content addressable storage of loaded meshes.
-	std::unordered_map<uint64_t, std::shared_ptr<Mesh_s>> LoadedMeshes;
+	// Weak, as are the paths below, so a mesh is freed with the last object using it, e.g. when a streamed cell unloads.
+	std::unordered_map<uint64_t, std::weak_ptr<Mesh_s>> LoadedMeshes;
+
+	// Guards the maps below, which PrefetchMesh reaches from other threads
+	std::mutex PathMutex;
+
+	// Meshes already built from an asset path, so repeat requests skip reading the asset file
+	std::unordered_map<std::wstring, std::weak_ptr<Mesh_s>> MeshesByPath;
+
+	// Loaded by PrefetchMesh and waiting on the first RequestMesh for their path to create the GPU resources,
+	// or on every load that prefetched them releasing them
+	std::unordered_map<std::wstring, PrefetchedMesh_s> PrefetchedMeshes;
 } G;
 
-std::shared_ptr<Mesh_s> RequestMeshObj(const JsonValue_s& Data)
+bool IsSupportedMeshData(const JsonValue_s& Data)
 {
-	// Compute hash of data to use as a key for caching
-	auto It = G.LoadedMeshes.find(Data.GetHash());
-	if (It != G.LoadedMeshes.end())
+	int32_t Version = -1;
+	JsonHelpers::ParseInt(Data, "Version", Version);
+	if (!ENSUREMSG(Version == MESH_ASSET_VERSION_CURRENT,"[MeshManager::RequestMesh] Unsupported mesh asset version: %d", Version))
+	{
+		return false;
+	}
+
+	std::string FileFormat;
+	if (!ENSUREMSG(JsonHelpers::ParseString(Data, "SourceFileType", FileFormat), "[MeshManager::RequestMesh] Missing FileFormat field"))
 	{
-		return It->second;
+		return false;
 	}
 
+	if (FileFormat != "obj")
+	{
+		LOGWARNING("[MeshManager::RequestMesh] Unsupported file format for mesh: %s", FileFormat.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+// Touches no GPU or global state, so may run on any thread
+bool LoadMeshSourceObj(const JsonValue_s& Data, MeshSourceData_s& Out)
+{
 	std::wstring Path;
 	if (!ENSUREMSG(JsonHelpers::ParseWString(Data, "SourceFilePath", Path), "[MeshManager::RequestMesh] Missing SourceFile field"))
 	{
-		return nullptr;
+		return false;
 	}
 
 	Path_s FullPath = Path_s(Path);
 
 	LOGINFO("[MeshManager::RequestMesh] Building mesh: %s", FullPath.ToString().c_str());
 
-	std::shared_ptr<Mesh_s> NewMesh = std::make_shared<Mesh_s>();	
-
+	HPAssetBytes_s Asset;
 	WaveFrontReader_c Reader;
-	if (!Reader.Load(FullPath.ToWString().c_str()))
+	if (!AssetPackages::Load(FullPath.ToWString(), Asset) || !Reader.Load(Asset.Bytes, FullPath.ToWString().c_str()))
 	{
 		LOGWARNING("[MeshManager::RequestMesh] Failed to load mesh: %s", FullPath.ToString().c_str());
-		return nullptr;
+		return false;
 	}
 
-	std::vector<float3> Positions;
 	std::vector<std::vector<uint32_t>> SurfaceIndices;
 
-	Positions.resize(Reader.Vertices.size());
+	Out.Positions.resize(Reader.Vertices.size());
 	for (uint32_t VertIt = 0; VertIt < Reader.Vertices.size(); VertIt++)
 	{
-		Positions[VertIt] = Reader.Vertices[VertIt].Position;
+		Out.Positions[VertIt] = Reader.Vertices[VertIt].Position;
+		Out.Bounds.Grow(Out.Positions[VertIt]);
 	}
 
 	for (uint32_t AttrIt = 0; AttrIt < Reader.Attributes.size(); AttrIt++)
@@ -77,22 +126,32 @@ std::shared_ptr<Mesh_s> RequestMeshObj(const JsonValue_s& Data)
 		SurfaceIndices[Attribute].push_back(Reader.Indices[IndexOffset + 2]);
 	}
 
-	std::vector<uint32_t> CombinedIndices;
-	for (const std::vector<uint32_t> Surface : SurfaceIndices)
+	Out.Indices.reserve(Reader.Indices.size());
+	Out.SurfaceIndexCounts.reserve(SurfaceIndices.size());
+	for (const std::vector<uint32_t>& Surface : SurfaceIndices)
 	{
-		CombinedIndices.insert(CombinedIndices.end(), Surface.begin(), Surface.end());
+		Out.Indices.insert(Out.Indices.end(), Surface.begin(), Surface.end());
+		Out.SurfaceIndexCounts.push_back(static_cast<uint32_t>(Surface.size()));
 	}
 
-	NewMesh->PositionBuffer = rl::CreateStructuredBuffer(Positions.data(), Positions.size());
-	NewMesh->PositionBufferSRV = rl::CreateStructuredBufferSRV(NewMesh->PositionBuffer, 0u, static_cast<uint32_t>(Positions.size()), static_cast<uint32_t>(sizeof(float3)));
-	NewMesh->IndexBuffer = rl::CreateIndexBufferFromArray(CombinedIndices.data(), CombinedIndices.size());
+	return true;
+}
+
+std::shared_ptr<Mesh_s> CreateMesh(const JsonValue_s& Data, const MeshSourceData_s& Source)
+{
+	std::shared_ptr<Mesh_s> NewMesh = std::make_shared<Mesh_s>();
+	NewMesh->Bounds = Source.Bounds;
+
+	NewMesh->PositionBuffer = rl::CreateStructuredBuffer(Source.Positions.data(), Source.Positions.size());
+	NewMesh->PositionBufferSRV = rl::CreateStructuredBufferSRV(NewMesh->PositionBuffer, 0u, static_cast<uint32_t>(Source.Positions.size()), static_cast<uint32_t>(sizeof(float3)));
+	NewMesh->IndexBuffer = rl::CreateIndexBufferFromArray(Source.Indices.data(), Source.Indices.size());
 
 	MeshUniformData_s MeshUniformData = {};
 	MeshUniformData.PositionBufferIndex = rl::GetDescriptorIndex(NewMesh->PositionBufferSRV);
 	NewMesh->MeshUniforms = rl::CreateConstantBuffer(&MeshUniformData);
 
 	std::vector<std::shared_ptr<Material_s>> Materials;
-	Materials.reserve(SurfaceIndices.size());
+	Materials.reserve(Source.SurfaceIndexCounts.size());
 	auto MaterialsIt = Data.Json.find("Materials");
 	if (MaterialsIt != Data.Json.end())
 	{
@@ -118,12 +177,12 @@ std::shared_ptr<Mesh_s> RequestMeshObj(const JsonValue_s& Data)
 	}
 
 	uint32_t CurrentIndexOffset = 0;
-	for (const std::vector<uint32_t> Surface : SurfaceIndices)
+	for (uint32_t SurfaceIndexCount : Source.SurfaceIndexCounts)
 	{
 		Surface_s NewSurface = {};
 		NewSurface.Material = nullptr; // Assign Materials later
 		NewSurface.IndexOffset = CurrentIndexOffset;
-		NewSurface.IndexCount = static_cast<uint32_t>(Surface.size());
+		NewSurface.IndexCount = SurfaceIndexCount;
 		CurrentIndexOffset += NewSurface.IndexCount;
 	}
 
@@ -133,39 +192,156 @@ std::shared_ptr<Mesh_s> RequestMeshObj(const JsonValue_s& Data)
 	return NewMesh;
 }
 
+std::shared_ptr<Mesh_s> RequestMeshObj(const JsonValue_s& Data)
+{
+	// Compute hash of data to use as a key for caching
+	auto It = G.LoadedMeshes.find(Data.GetHash());
+	if (It != G.LoadedMeshes.end())
+	{
+		if (std::shared_ptr<Mesh_s> LoadedMesh = It->second.lock())
+			return LoadedMesh;
+
+		G.LoadedMeshes.erase(It);
+	}
+
+	MeshSourceData_s Source;
+	if (!LoadMeshSourceObj(Data, Source))
+	{
+		return nullptr;
+	}
+
+	return CreateMesh(Data, Source);
+}
+
 std::shared_ptr<Mesh_s> RequestMesh(const Path_s& Path)
 {
-	Json_t Json;
-	if (ENSUREMSG(LoadJsonFromFile(Path.ToWString(), Json), "[MeshManager::RequestMesh] Failed to load Mesh json from path %S", Path.ToWString().c_str()))
+	const std::wstring PathString = Path.ToWString();
+
+	std::unique_lock Lock(G.PathMutex);
+
+	auto LoadedIt = G.MeshesByPath.find(PathString);
+	if (LoadedIt != G.MeshesByPath.end())
 	{
-		return RequestMesh(Json);
+		if (std::shared_ptr<Mesh_s> LoadedMesh = LoadedIt->second.lock())
+			return LoadedMesh;
+
+		G.MeshesByPath.erase(LoadedIt);
+	}
+
+	std::shared_ptr<Mesh_s> NewMesh;
+
+	auto PrefetchedIt = G.PrefetchedMeshes.find(PathString);
+	if (PrefetchedIt != G.PrefetchedMeshes.end())
+	{
+		PrefetchedMesh_s Prefetched = std::move(PrefetchedIt->second);
+		G.PrefetchedMeshes.erase(PrefetchedIt);
+		Lock.unlock();
+
+		// Another path may have already built the same data
+		const JsonValue_s Data(Prefetched.Data);
+		auto HashIt = G.LoadedMeshes.find(Data.GetHash());
+		NewMesh = HashIt != G.LoadedMeshes.end() ? HashIt->second.lock() : nullptr;
+		if (!NewMesh)
+		{
+			NewMesh = CreateMesh(Data, Prefetched.Source);
+		}
+	}
+	else
+	{
+		Lock.unlock();
+
+		HPAssetBytes_s Asset;
+		Json_t Json;
+		if (ENSUREMSG(AssetPackages::Load(PathString, Asset) && LoadJsonFromBytes(Asset.Bytes, Json), "[MeshManager::RequestMesh] Failed to load Mesh json from path %S", PathString.c_str()))
+		{
+			NewMesh = RequestMesh(Json);
+		}
+	}
+
+	if (NewMesh)
+	{
+		Lock.lock();
+		G.MeshesByPath[PathString] = NewMesh;
 	}
-	return nullptr;
+
+	return NewMesh;
 }
 
 std::shared_ptr<Mesh_s> RequestMesh(const JsonValue_s& Data)
 {
-	int32_t Version = -1;
-	JsonHelpers::ParseInt(Data, "Version", Version);
-	if (!ENSUREMSG(Version == MESH_ASSET_VERSION_CURRENT,"[MeshManager::RequestMesh] Unsupported mesh asset version: %d", Version))
+	if (!IsSupportedMeshData(Data))
 	{
 		return nullptr;
 	}
 
-	std::string FileFormat;
-	if (!ENSUREMSG(JsonHelpers::ParseString(Data, "SourceFileType", FileFormat), "[MeshManager::RequestMesh] Missing FileFormat field"))
+	return RequestMeshObj(Data);
+}
+
+bool PrefetchMesh(const Path_s& Path, uint64_t* OutSize)
+{
+	const std::wstring PathString = Path.ToWString();
+
+	if (OutSize)
 	{
-		return nullptr;
+		*OutSize = 0;
 	}
 
-	if (FileFormat == "obj")
 	{
-		return RequestMeshObj(Data);
+		std::lock_guard Lock(G.PathMutex);
+		auto LoadedIt = G.MeshesByPath.find(PathString);
+		if (LoadedIt != G.MeshesByPath.end() && !LoadedIt->second.expired())
+			return false;
+
+		auto PrefetchedIt = G.PrefetchedMeshes.find(PathString);
+		if (PrefetchedIt != G.PrefetchedMeshes.end())
+		{
+			PrefetchedIt->second.HoldCount++;
+			return true;
+		}
 	}
-	else
+
+	HPAssetBytes_s Asset;
+	PrefetchedMesh_s Prefetched;
+	if (!AssetPackages::Load(PathString, Asset) || !LoadJsonFromBytes(Asset.Bytes, Prefetched.Data))
 	{
-		LOGWARNING("[MeshManager::RequestMesh] Unsupported file format for mesh: %s", FileFormat.c_str());
-		return nullptr;
+		LOGWARNING("[MeshManager::PrefetchMesh] Failed to load Mesh json from path %S", PathString.c_str());
+		return false;
+	}
+
+	if (!IsSupportedMeshData(Prefetched.Data) || !LoadMeshSourceObj(Prefetched.Data, Prefetched.Source))
+		return false;
+
+	if (OutSize)
+	{
+		*OutSize = Prefetched.Source.Positions.size() * sizeof(float3) + Prefetched.Source.Indices.size() * sizeof(uint32_t);
+	}
+
+	// Another thread may have prefetched the same path meanwhile, hold its copy instead
+	std::lock_guard Lock(G.PathMutex);
+	auto PrefetchedIt = G.PrefetchedMeshes.emplace(PathString, std::move(Prefetched)).first;
+	PrefetchedIt->second.HoldCount++;
+	return true;
+}
+
+void PruneExpiredMeshes()
+{
+	std::erase_if(G.LoadedMeshes, [](const auto& Entry) { return Entry.second.expired(); });
+
+	std::lock_guard Lock(G.PathMutex);
+	std::erase_if(G.MeshesByPath, [](const auto& Entry) { return Entry.second.expired(); });
+}
+
+void ReleasePrefetchedMeshes(const std::vector<std::wstring>& Paths)
+{
+	std::lock_guard Lock(G.PathMutex);
+	for (const std::wstring& Path : Paths)
+	{
+		// Gone once requested, the hold only matters while nothing has
+		auto PrefetchedIt = G.PrefetchedMeshes.find(Path);
+		if (PrefetchedIt != G.PrefetchedMeshes.end() && --PrefetchedIt->second.HoldCount == 0)
+		{
+			G.PrefetchedMeshes.erase(PrefetchedIt);
+		}
 	}
 }
 
@@ -1,5 +1,6 @@
 #include "Core/GameApp.h"
 
+#include "Assets/AssetPackages.h"
 #include "Input/Input.h"
 #include "Object/CameraComponent.h"
 #include "Object/FlyControllerComponent.h"
@@ -11,6 +12,7 @@
 #include "Core/WindowsPlatform.h"
 
 #include <Render/Render.h>
+#include <Shared/FileUtils/PathUtils.h>
 
 bool GameApp_c::Init()
 {
@@ -27,6 +29,9 @@ bool GameApp_c::Init()
 
 	Clock = {};
 
+	// Levels and meshes are read out of the project's cooked packages where they hold them
+	AssetPackages::Mount(Path_s(PathDirectory_e::Project, L"Cooked/"));
+
 	//*InitializeApp();
 
 	return true;
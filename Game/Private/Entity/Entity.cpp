@@ -1,29 +1,33 @@
 #include "Entity/Entity.h"
+#include "Entity/EntityFragments.h"
 
-struct EntityRegistry_s
+EntityRegistry_s& GetEntityRegistry()
 {
-	uint32_t LastEntity = 0;
+	static EntityRegistry_s Registry;
+	return Registry;
+}
 
-	Entity_t CreateEntity()
-	{
-		LastEntity++;
-		return (Entity_t)LastEntity;
-	}
+Entity_t CreateEntity()
+{
+	return GetEntityRegistry().CreateEntity();
+}
 
-	void DestroyEntity(Entity_t Entity)
-	{
-		// Notify fragments
-	}
-};
+void DestroyEntity(Entity_t Entity)
+{
+	GetEntityRegistry().DestroyEntity(Entity);
+}
 
-EntityRegistry_s g_EntityRegistry;
+bool IsEntityValid(Entity_t Entity)
+{
+	return GetEntityRegistry().IsValid(Entity);
+}
 
-Entity_t CreateEntity()
+uint32_t AddEntityDestroyedCallback(EntityDestroyedCallback_t Callback)
 {
-	return g_EntityRegistry.CreateEntity();
+	return GetEntityRegistry().AddDestroyedCallback(std::move(Callback));
 }
 
-void DestroyEntity(Entity_t Entity)
+void RemoveEntityDestroyedCallback(uint32_t CallbackId)
 {
-	g_EntityRegistry.DestroyEntity(Entity);
+	GetEntityRegistry().RemoveDestroyedCallback(CallbackId);
 }
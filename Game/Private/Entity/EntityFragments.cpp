@@ -0,0 +1,1194 @@
+#include "Entity/EntityFragments.h"
+
+#include <Shared/Logging/Logging.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+// "HPES" read as little endian
+#define ENTITY_SNAPSHOT_MAGIC 0x53455048u
+#define ENTITY_SNAPSHOT_VERSION_INITIAL 1u
+#define ENTITY_SNAPSHOT_VERSION_CURRENT ENTITY_SNAPSHOT_VERSION_INITIAL
+
+namespace EntityFragments
+{
+
+struct FragmentTypeGlobals_s
+{
+	// Fixed size so readers never see a reallocation while a type registers on another thread
+	std::array<FragmentTypeInfo_s, MaxFragmentTypes> Types = {};
+	std::atomic<uint32_t> TypeCount = 0;
+	std::mutex RegisterMutex;
+};
+
+static FragmentTypeGlobals_s& GetGlobals()
+{
+	static FragmentTypeGlobals_s Globals;
+	return Globals;
+}
+
+FragmentTypeId_t RegisterFragmentType(const FragmentTypeInfo_s& Info)
+{
+	FragmentTypeGlobals_s& G = GetGlobals();
+
+	std::lock_guard Lock(G.RegisterMutex);
+
+	const FragmentTypeId_t NewType = G.TypeCount.load(std::memory_order_relaxed);
+	CHECK(NewType < MaxFragmentTypes);
+
+	G.Types[NewType] = Info;
+	G.TypeCount.store(NewType + 1, std::memory_order_release);
+
+	return NewType;
+}
+
+uint32_t GetFragmentTypeCount() noexcept
+{
+	return GetGlobals().TypeCount.load(std::memory_order_acquire);
+}
+
+const FragmentTypeInfo_s& GetFragmentTypeInfo(FragmentTypeId_t Type) noexcept
+{
+	return GetGlobals().Types[Type];
+}
+
+}
+
+namespace
+{
+
+uint32_t AlignUp(uint32_t Value, uint32_t Alignment) noexcept
+{
+	return (Value + Alignment - 1) & ~(Alignment - 1);
+}
+
+// Bytes a chunk needs for Capacity rows, and the offset of each column
+uint32_t LayoutChunk(const std::vector<FragmentTypeId_t>& Types, uint32_t Capacity, std::vector<uint32_t>& OutOffsets)
+{
+	OutOffsets.clear();
+
+	uint32_t Offset = Capacity * static_cast<uint32_t>(sizeof(Entity_t));
+	for (FragmentTypeId_t Type : Types)
+	{
+		const FragmentTypeInfo_s& Info = EntityFragments::GetFragmentTypeInfo(Type);
+		Offset = AlignUp(Offset, Info.Alignment);
+		OutOffsets.push_back(Offset);
+		Offset += Capacity * Info.Size;
+	}
+
+	return Offset;
+}
+
+uint32_t FindEdge(const std::vector<std::pair<FragmentTypeId_t, uint32_t>>& Edges, FragmentTypeId_t Type) noexcept
+{
+	for (const std::pair<FragmentTypeId_t, uint32_t>& Edge : Edges)
+	{
+		if (Edge.first == Type)
+			return Edge.second;
+	}
+	return UINT32_MAX;
+}
+
+}
+
+// EntityArchetype_s /////////////////////////////////////////////////////////
+
+EntityArchetype_s::EntityArchetype_s(std::vector<FragmentTypeId_t> InTypes)
+	: Types(std::move(InTypes))
+{
+	for (uint32_t Column = 0; Column < Types.size(); Column++)
+	{
+		const FragmentTypeId_t Type = Types[Column];
+		Signature.SetBit(Type, true);
+
+		if (ColumnsByType.size() <= Type)
+		{
+			ColumnsByType.resize(Type + 1, -1);
+		}
+		ColumnsByType[Type] = static_cast<int32_t>(Column);
+	}
+
+	uint32_t RowSize = sizeof(Entity_t);
+	for (FragmentTypeId_t Type : Types)
+	{
+		RowSize += EntityFragments::GetFragmentTypeInfo(Type).Size;
+	}
+
+	// Alignment padding can push the first guess over, back off a row at a time until it fits
+	ChunkCapacity = std::max(ChunkSize / RowSize, 1u);
+	while (ChunkCapacity > 1 && LayoutChunk(Types, ChunkCapacity, ColumnOffsets) > ChunkSize)
+	{
+		ChunkCapacity--;
+	}
+
+	ChunkBytes = std::max(LayoutChunk(Types, ChunkCapacity, ColumnOffsets), ChunkSize);
+}
+
+EntityArchetype_s::~EntityArchetype_s()
+{
+	Clear();
+}
+
+void EntityArchetype_s::Clear()
+{
+	for (EntityChunk_s& Chunk : Chunks)
+	{
+		for (uint32_t Column = 0; Column < Types.size(); Column++)
+		{
+			const FragmentTypeInfo_s& Info = EntityFragments::GetFragmentTypeInfo(Types[Column]);
+			uint8_t* ColumnData = static_cast<uint8_t*>(GetColumnData(Chunk, Column));
+			for (uint32_t Row = 0; Row < Chunk.Count; Row++)
+			{
+				Info.Destroy(ColumnData + static_cast<size_t>(Row) * Info.Size);
+			}
+		}
+
+		::operator delete(Chunk.Data, std::align_val_t(ChunkAlignment));
+	}
+
+	Chunks.clear();
+	EntityCount = 0;
+}
+
+void EntityArchetype_s::SaveSnapshot(EntitySnapshotWriter_s& Writer) const
+{
+	for (const EntityChunk_s& Chunk : Chunks)
+	{
+		Writer.WriteBytes(GetEntities(Chunk), Chunk.Count * sizeof(Entity_t));
+	}
+
+	for (uint32_t Column = 0; Column < Types.size(); Column++)
+	{
+		const FragmentTypeInfo_s& Info = EntityFragments::GetFragmentTypeInfo(Types[Column]);
+		for (const EntityChunk_s& Chunk : Chunks)
+		{
+			const uint8_t* ColumnData = static_cast<const uint8_t*>(GetColumnData(Chunk, Column));
+			if (Info.TriviallyCopyable)
+			{
+				Writer.WriteBytes(ColumnData, static_cast<size_t>(Chunk.Count) * Info.Size);
+				continue;
+			}
+
+			for (uint32_t Row = 0; Row < Chunk.Count; Row++)
+			{
+				Info.SaveSnapshot(ColumnData + static_cast<size_t>(Row) * Info.Size, Writer);
+			}
+		}
+	}
+}
+
+void EntityArchetype_s::LoadSnapshot(EntitySnapshotReader_s& Reader, uint32_t Count, const std::vector<int32_t>& Columns, uint32_t Version)
+{
+	CHECK(Chunks.empty());
+
+	for (uint32_t Row = 0; Row < Count; Row += ChunkCapacity)
+	{
+		EntityChunk_s& Chunk = Chunks.emplace_back();
+		Chunk.Data = static_cast<uint8_t*>(::operator new(ChunkBytes, std::align_val_t(ChunkAlignment)));
+		Chunk.Count = std::min(ChunkCapacity, Count - Row);
+		Chunk.ColumnVersions.assign(Types.size(), Version);
+
+		Reader.ReadBytes(GetEntities(Chunk), Chunk.Count * sizeof(Entity_t));
+	}
+	EntityCount = Count;
+
+	for (int32_t Column : Columns)
+	{
+		const FragmentTypeInfo_s& Info = EntityFragments::GetFragmentTypeInfo(Types[Column]);
+		for (EntityChunk_s& Chunk : Chunks)
+		{
+			uint8_t* ColumnData = static_cast<uint8_t*>(GetColumnData(Chunk, Column));
+			if (Info.TriviallyCopyable)
+			{
+				Reader.ReadBytes(ColumnData, static_cast<size_t>(Chunk.Count) * Info.Size);
+				continue;
+			}
+
+			for (uint32_t Row = 0; Row < Chunk.Count; Row++)
+			{
+				Reader.Failed |= !Info.LoadSnapshot(ColumnData + static_cast<size_t>(Row) * Info.Size, Reader);
+			}
+		}
+	}
+}
+
+// EntitySparseSet_s /////////////////////////////////////////////////////////
+
+EntitySparseSet_s::EntitySparseSet_s(FragmentTypeId_t InType)
+	: Type(InType)
+	, Info(EntityFragments::GetFragmentTypeInfo(InType))
+{}
+
+EntitySparseSet_s::~EntitySparseSet_s()
+{
+	Clear();
+
+	::operator delete(Fragments, std::align_val_t(Info.Alignment));
+}
+
+void EntitySparseSet_s::Clear()
+{
+	for (uint32_t DenseIt = 0; DenseIt < GetCount(); DenseIt++)
+	{
+		Info.Destroy(GetFragment(DenseIt));
+	}
+
+	Entities.clear();
+	BlockVersions.clear();
+	SparsePages.clear();
+}
+
+void EntitySparseSet_s::SaveSnapshot(EntitySnapshotWriter_s& Writer) const
+{
+	Writer.WriteBytes(Entities.data(), Entities.size() * sizeof(Entity_t));
+
+	if (Info.TriviallyCopyable)
+	{
+		Writer.WriteBytes(Fragments, static_cast<size_t>(GetCount()) * Info.Size);
+		return;
+	}
+
+	for (uint32_t DenseIt = 0; DenseIt < GetCount(); DenseIt++)
+	{
+		Info.SaveSnapshot(GetFragment(DenseIt), Writer);
+	}
+}
+
+void EntitySparseSet_s::LoadSnapshot(EntitySnapshotReader_s& Reader, uint32_t Count, uint32_t Version)
+{
+	CHECK(Entities.empty());
+
+	if (Capacity < Count)
+	{
+		::operator delete(Fragments, std::align_val_t(Info.Alignment));
+		Capacity = std::max(Count, 64u);
+		Fragments = static_cast<uint8_t*>(::operator new(static_cast<size_t>(Capacity) * Info.Size, std::align_val_t(Info.Alignment)));
+	}
+
+	Entities.resize(Count);
+	Reader.ReadBytes(Entities.data(), Count * sizeof(Entity_t));
+
+	if (Info.TriviallyCopyable)
+	{
+		Reader.ReadBytes(Fragments, static_cast<size_t>(Count) * Info.Size);
+	}
+	else
+	{
+		for (uint32_t DenseIt = 0; DenseIt < Count; DenseIt++)
+		{
+			Reader.Failed |= !Info.LoadSnapshot(GetFragment(DenseIt), Reader);
+		}
+	}
+
+	BlockVersions.assign((Count + VersionBlockSize - 1) / VersionBlockSize, Version);
+
+	// Entities are garbage if reading failed, the registry clears the set anyway
+	if (Reader.Failed)
+		return;
+
+	for (uint32_t DenseIt = 0; DenseIt < Count; DenseIt++)
+	{
+		GetSparseEntry(Entities[DenseIt]) = DenseIt;
+	}
+}
+
+uint32_t& EntitySparseSet_s::GetSparseEntry(Entity_t Entity)
+{
+	const uint32_t Index = GetEntityIndex(Entity);
+	const uint32_t Page = Index / SparsePageSize;
+	if (SparsePages.size() <= Page)
+	{
+		SparsePages.resize(Page + 1);
+	}
+
+	if (!SparsePages[Page])
+	{
+		SparsePages[Page] = std::make_unique<uint32_t[]>(SparsePageSize);
+		std::fill_n(SparsePages[Page].get(), SparsePageSize, InvalidIndex);
+	}
+
+	return SparsePages[Page][Index % SparsePageSize];
+}
+
+void* EntitySparseSet_s::Insert(Entity_t Entity, uint32_t Version)
+{
+	const uint32_t DenseIndex = GetCount();
+	if (DenseIndex == Capacity)
+	{
+		const uint32_t NewCapacity = std::max(Capacity * 2, 64u);
+		uint8_t* NewFragments = static_cast<uint8_t*>(::operator new(static_cast<size_t>(NewCapacity) * Info.Size, std::align_val_t(Info.Alignment)));
+
+		for (uint32_t DenseIt = 0; DenseIt < DenseIndex; DenseIt++)
+		{
+			Info.Relocate(NewFragments + static_cast<size_t>(DenseIt) * Info.Size, GetFragment(DenseIt));
+		}
+
+		::operator delete(Fragments, std::align_val_t(Info.Alignment));
+		Fragments = NewFragments;
+		Capacity = NewCapacity;
+	}
+
+	GetSparseEntry(Entity) = DenseIndex;
+	Entities.push_back(Entity);
+
+	if (DenseIndex % VersionBlockSize == 0)
+	{
+		BlockVersions.push_back(Version);
+	}
+	MarkChanged(DenseIndex, Version);
+
+	return GetFragment(DenseIndex);
+}
+
+void EntitySparseSet_s::Remove(Entity_t Entity, uint32_t Version)
+{
+	const uint32_t DenseIndex = Find(Entity);
+	if (DenseIndex == InvalidIndex)
+		return;
+
+	Info.Destroy(GetFragment(DenseIndex));
+
+	const uint32_t LastIndex = GetCount() - 1;
+	if (DenseIndex != LastIndex)
+	{
+		const Entity_t Moved = Entities[LastIndex];
+		Info.Relocate(GetFragment(DenseIndex), GetFragment(LastIndex));
+		Entities[DenseIndex] = Moved;
+		GetSparseEntry(Moved) = DenseIndex;
+		MarkChanged(DenseIndex, Version);
+	}
+
+	Entities.pop_back();
+	if (GetCount() % VersionBlockSize == 0)
+	{
+		BlockVersions.pop_back();
+	}
+	GetSparseEntry(Entity) = InvalidIndex;
+}
+
+// EntityRegistry_s //////////////////////////////////////////////////////////
+
+EntityRegistry_s::EntityRegistry_s()
+{
+	FindOrCreateArchetype({});
+
+	// Index 0 is Entity_t::INVALID
+	Locations.emplace_back();
+	Generations.push_back(0);
+}
+
+EntityRegistry_s::~EntityRegistry_s() = default;
+
+Entity_t EntityRegistry_s::CreateEntity()
+{
+	uint32_t Index;
+	if (!FreeIndices.empty())
+	{
+		Index = FreeIndices.front();
+		FreeIndices.pop_front();
+	}
+	else
+	{
+		Index = static_cast<uint32_t>(Locations.size());
+		if (!ENSUREMSG(Index <= EntityIds::MaxEntities, "[Entity] Out of entity indices, %u entities alive", GetAliveCount()))
+			return Entity_t::INVALID;
+
+		Locations.emplace_back();
+		Generations.push_back(0);
+	}
+
+	const Entity_t Entity = MakeEntity(Index, Generations[Index]);
+
+	Locations[Index].Archetype = 0;
+	Locations[Index].Row = AllocateRow(*Archetypes[0], Entity);
+
+	return Entity;
+}
+
+void EntityRegistry_s::DestroyEntity(Entity_t Entity)
+{
+	if (!IsValid(Entity))
+		return;
+
+	// By index, a callback may add or remove others
+	for (size_t CallbackIt = 0; CallbackIt < DestroyedCallbacks.size(); CallbackIt++)
+	{
+		const EntityDestroyedCallback_t Callback = DestroyedCallbacks[CallbackIt].second;
+		Callback(Entity);
+	}
+
+	// A callback may have destroyed it already
+	if (!IsValid(Entity))
+		return;
+
+	const uint32_t Index = GetEntityIndex(Entity);
+
+	for (const std::unique_ptr<EntitySparseSet_s>& Set : SparseSets)
+	{
+		if (Set && Set->Find(Entity) != EntitySparseSet_s::InvalidIndex)
+		{
+			Set->Remove(Entity, ChangeVersion);
+			SetPresence(Index, Set->Type, false);
+		}
+	}
+
+	EntityLocation_s& Location = GetLocation(Entity);
+	EntityArchetype_s& Archetype = *Archetypes[Location.Archetype];
+	for (uint32_t Column = 0; Column < Archetype.Types.size(); Column++)
+	{
+		EntityFragments::GetFragmentTypeInfo(Archetype.Types[Column]).Destroy(Archetype.GetFragment(Location.Row, Column));
+		SetPresence(Index, Archetype.Types[Column], false);
+	}
+	ReleaseRow(Archetype, Location.Row);
+	Location = EntityLocation_s();
+	Generations[Index] = static_cast<uint8_t>((Generations[Index] + 1) & EntityIds::MaxGeneration);
+	FreeIndices.push_back(Index);
+}
+
+bool EntityRegistry_s::IsValid(Entity_t Entity) const noexcept
+{
+	const uint32_t Index = GetEntityIndex(Entity);
+	return Index != 0 && Index < Locations.size() && Generations[Index] == GetEntityGeneration(Entity)
+		&& Locations[Index].Archetype != EntityLocation_s::FreeArchetype;
+}
+
+uint32_t EntityRegistry_s::AddDestroyedCallback(EntityDestroyedCallback_t Callback)
+{
+	const uint32_t CallbackId = NextCallbackId++;
+	DestroyedCallbacks.emplace_back(CallbackId, std::move(Callback));
+	return CallbackId;
+}
+
+void EntityRegistry_s::RemoveDestroyedCallback(uint32_t CallbackId)
+{
+	std::erase_if(DestroyedCallbacks, [CallbackId](const std::pair<uint32_t, EntityDestroyedCallback_t>& Entry)
+	{
+		return Entry.first == CallbackId;
+	});
+}
+
+void* EntityRegistry_s::AddFragment(Entity_t Entity, FragmentTypeId_t Type, bool& OutConstruct)
+{
+	OutConstruct = false;
+
+	if (!ENSUREMSG(IsValid(Entity), "[Entity] Adding a fragment to invalid entity %u", (uint32_t)Entity))
+		return nullptr;
+
+	if (EntityFragments::GetFragmentTypeInfo(Type).Storage == FragmentStorage_e::SparseSet)
+	{
+		EntitySparseSet_s& Set = GetOrCreateSparseSet(Type);
+		const uint32_t DenseIndex = Set.Find(Entity);
+		if (DenseIndex != EntitySparseSet_s::InvalidIndex)
+		{
+			Set.MarkChanged(DenseIndex, ChangeVersion);
+			return Set.GetFragment(DenseIndex);
+		}
+
+		OutConstruct = true;
+		SetPresence(GetEntityIndex(Entity), Type, true);
+		return Set.Insert(Entity, ChangeVersion);
+	}
+
+	const EntityLocation_s& Location = GetLocation(Entity);
+	const int32_t Column = Archetypes[Location.Archetype]->GetColumn(Type);
+	if (Column >= 0)
+		return GetFragmentForWrite(Entity, Type);
+
+	MoveEntity(Entity, GetArchetypeWith(Location.Archetype, Type));
+	SetPresence(GetEntityIndex(Entity), Type, true);
+
+	OutConstruct = true;
+	return GetFragment(Entity, Type);
+}
+
+void EntityRegistry_s::RemoveFragment(Entity_t Entity, FragmentTypeId_t Type)
+{
+	if (!IsValid(Entity))
+		return;
+
+	if (EntityFragments::GetFragmentTypeInfo(Type).Storage == FragmentStorage_e::SparseSet)
+	{
+		if (Type < SparseSets.size() && SparseSets[Type] && SparseSets[Type]->Find(Entity) != EntitySparseSet_s::InvalidIndex)
+		{
+			SparseSets[Type]->Remove(Entity, ChangeVersion);
+			SetPresence(GetEntityIndex(Entity), Type, false);
+		}
+		return;
+	}
+
+	const EntityLocation_s& Location = GetLocation(Entity);
+	if (Archetypes[Location.Archetype]->GetColumn(Type) < 0)
+		return;
+
+	MoveEntity(Entity, GetArchetypeWithout(Location.Archetype, Type));
+	SetPresence(GetEntityIndex(Entity), Type, false);
+}
+
+void* EntityRegistry_s::GetFragment(Entity_t Entity, FragmentTypeId_t Type) const noexcept
+{
+	if (!IsValid(Entity))
+		return nullptr;
+
+	if (EntityFragments::GetFragmentTypeInfo(Type).Storage == FragmentStorage_e::SparseSet)
+	{
+		const EntitySparseSet_s* Set = FindSparseSet(Type);
+		const uint32_t DenseIndex = Set ? Set->Find(Entity) : EntitySparseSet_s::InvalidIndex;
+		return DenseIndex != EntitySparseSet_s::InvalidIndex ? Set->GetFragment(DenseIndex) : nullptr;
+	}
+
+	const EntityLocation_s& Location = GetLocation(Entity);
+	const EntityArchetype_s& Archetype = *Archetypes[Location.Archetype];
+	const int32_t Column = Archetype.GetColumn(Type);
+
+	return Column >= 0 ? Archetype.GetFragment(Location.Row, Column) : nullptr;
+}
+
+void* EntityRegistry_s::GetFragmentForWrite(Entity_t Entity, FragmentTypeId_t Type) noexcept
+{
+	if (!IsValid(Entity))
+		return nullptr;
+
+	if (EntityFragments::GetFragmentTypeInfo(Type).Storage == FragmentStorage_e::SparseSet)
+	{
+		EntitySparseSet_s* Set = FindSparseSet(Type);
+		const uint32_t DenseIndex = Set ? Set->Find(Entity) : EntitySparseSet_s::InvalidIndex;
+		if (DenseIndex == EntitySparseSet_s::InvalidIndex)
+			return nullptr;
+
+		Set->MarkChanged(DenseIndex, ChangeVersion);
+		return Set->GetFragment(DenseIndex);
+	}
+
+	const EntityLocation_s& Location = GetLocation(Entity);
+	EntityArchetype_s& Archetype = *Archetypes[Location.Archetype];
+	const int32_t Column = Archetype.GetColumn(Type);
+	if (Column < 0)
+		return nullptr;
+
+	EntityFragments::MarkVersion(Archetype.Chunks[Location.Row / Archetype.ChunkCapacity].ColumnVersions[Column], ChangeVersion);
+	return Archetype.GetFragment(Location.Row, Column);
+}
+
+uint32_t EntityRegistry_s::GetFragmentVersion(Entity_t Entity, FragmentTypeId_t Type) const noexcept
+{
+	if (!IsValid(Entity))
+		return 0;
+
+	if (EntityFragments::GetFragmentTypeInfo(Type).Storage == FragmentStorage_e::SparseSet)
+	{
+		const EntitySparseSet_s* Set = FindSparseSet(Type);
+		const uint32_t DenseIndex = Set ? Set->Find(Entity) : EntitySparseSet_s::InvalidIndex;
+		return DenseIndex != EntitySparseSet_s::InvalidIndex ? Set->GetVersion(DenseIndex) : 0;
+	}
+
+	const EntityLocation_s& Location = GetLocation(Entity);
+	const EntityArchetype_s& Archetype = *Archetypes[Location.Archetype];
+	const int32_t Column = Archetype.GetColumn(Type);
+
+	return Column >= 0 ? EntityFragments::LoadVersion(Archetype.Chunks[Location.Row / Archetype.ChunkCapacity].ColumnVersions[Column]) : 0;
+}
+
+EntityQueryCache_s& EntityRegistry_s::GetQueryCache(std::vector<FragmentTypeId_t> Types)
+{
+	CHECK(!Types.empty());
+
+	std::sort(Types.begin(), Types.end());
+	Types.erase(std::unique(Types.begin(), Types.end()), Types.end());
+
+	std::unique_ptr<EntityQueryCache_s>& Query = QueryCaches[Types];
+	if (Query)
+		return *Query;
+
+	Query = std::make_unique<EntityQueryCache_s>();
+	Query->Types = Types;
+
+	if (FragmentPresence.size() <= Types.back())
+	{
+		FragmentPresence.resize(Types.back() + 1);
+	}
+
+	if (QueriesByType.size() <= Types.back())
+	{
+		QueriesByType.resize(Types.back() + 1);
+	}
+
+	std::vector<const EntityBitField_s*> Fields;
+	for (FragmentTypeId_t Type : Types)
+	{
+		Fields.push_back(&FragmentPresence[Type]);
+		QueriesByType[Type].push_back(Query.get());
+	}
+	Query->Matches.AssignIntersection(Fields.data(), Fields.size());
+
+	return *Query;
+}
+
+bool EntityRegistry_s::SaveSnapshot(std::vector<uint8_t>& Out) const
+{
+	// Only the types in use are written, numbered in the order first seen
+	std::vector<FragmentTypeId_t> SnapshotTypes;
+	std::vector<uint32_t> SnapshotIndices(EntityFragments::GetFragmentTypeCount(), UINT32_MAX);
+	size_t EstimatedSize = 0;
+
+	auto UseType = [&SnapshotTypes, &SnapshotIndices](FragmentTypeId_t Type)
+	{
+		if (SnapshotIndices[Type] != UINT32_MAX)
+			return true;
+
+		const FragmentTypeInfo_s& Info = EntityFragments::GetFragmentTypeInfo(Type);
+		if (!Info.TriviallyCopyable && !Info.SaveSnapshot)
+		{
+			LOGERROR("[Entity] Can not snapshot fragment type %s, it is not trivially copyable and has no SaveSnapshot and LoadSnapshot", Info.Name);
+			return false;
+		}
+
+		SnapshotIndices[Type] = static_cast<uint32_t>(SnapshotTypes.size());
+		SnapshotTypes.push_back(Type);
+		return true;
+	};
+
+	uint32_t ArchetypeCount = 0;
+	for (const std::unique_ptr<EntityArchetype_s>& Archetype : Archetypes)
+	{
+		if (Archetype->EntityCount == 0)
+			continue;
+
+		size_t RowSize = sizeof(Entity_t);
+		for (FragmentTypeId_t Type : Archetype->Types)
+		{
+			if (!UseType(Type))
+				return false;
+
+			RowSize += EntityFragments::GetFragmentTypeInfo(Type).Size;
+		}
+
+		EstimatedSize += RowSize * Archetype->EntityCount;
+		ArchetypeCount++;
+	}
+
+	uint32_t SparseSetCount = 0;
+	for (const std::unique_ptr<EntitySparseSet_s>& Set : SparseSets)
+	{
+		if (!Set || Set->GetCount() == 0)
+			continue;
+
+		if (!UseType(Set->Type))
+			return false;
+
+		EstimatedSize += (sizeof(Entity_t) + Set->Info.Size) * static_cast<size_t>(Set->GetCount());
+		SparseSetCount++;
+	}
+
+	Out.reserve(Out.size() + EstimatedSize + Generations.size() + FreeIndices.size() * sizeof(uint32_t) + 4096);
+	EntitySnapshotWriter_s Writer{ Out };
+
+	Writer.Write(ENTITY_SNAPSHOT_MAGIC);
+	Writer.Write(ENTITY_SNAPSHOT_VERSION_CURRENT);
+
+	Writer.Write(static_cast<uint32_t>(SnapshotTypes.size()));
+	for (FragmentTypeId_t Type : SnapshotTypes)
+	{
+		const FragmentTypeInfo_s& Info = EntityFragments::GetFragmentTypeInfo(Type);
+		const uint32_t NameLength = static_cast<uint32_t>(std::strlen(Info.Name));
+		Writer.Write(NameLength);
+		Writer.WriteBytes(Info.Name, NameLength);
+		Writer.Write(Info.Size);
+		Writer.Write(Info.Alignment);
+		Writer.Write(Info.Storage);
+	}
+
+	Writer.Write(static_cast<uint32_t>(Generations.size()));
+	Writer.WriteBytes(Generations.data(), Generations.size());
+	Writer.Write(static_cast<uint32_t>(FreeIndices.size()));
+	for (uint32_t FreeIndex : FreeIndices)
+	{
+		Writer.Write(FreeIndex);
+	}
+
+	Writer.Write(ArchetypeCount);
+	for (const std::unique_ptr<EntityArchetype_s>& Archetype : Archetypes)
+	{
+		if (Archetype->EntityCount == 0)
+			continue;
+
+		Writer.Write(static_cast<uint32_t>(Archetype->Types.size()));
+		for (FragmentTypeId_t Type : Archetype->Types)
+		{
+			Writer.Write(SnapshotIndices[Type]);
+		}
+		Writer.Write(Archetype->EntityCount);
+		Archetype->SaveSnapshot(Writer);
+	}
+
+	Writer.Write(SparseSetCount);
+	for (const std::unique_ptr<EntitySparseSet_s>& Set : SparseSets)
+	{
+		if (!Set || Set->GetCount() == 0)
+			continue;
+
+		Writer.Write(SnapshotIndices[Set->Type]);
+		Writer.Write(Set->GetCount());
+		Set->SaveSnapshot(Writer);
+	}
+
+	return true;
+}
+
+bool EntityRegistry_s::RestoreSnapshot(const uint8_t* Data, size_t Size)
+{
+	EntitySnapshotReader_s Reader{ Data, Data + Size };
+
+	uint32_t Magic = 0;
+	uint32_t Version = 0;
+	Reader.Read(Magic);
+	Reader.Read(Version);
+	if (Magic != ENTITY_SNAPSHOT_MAGIC || Version != ENTITY_SNAPSHOT_VERSION_CURRENT)
+	{
+		LOGERROR("[Entity] Not an entity snapshot, or unsupported snapshot version %u, expected %u", Version, ENTITY_SNAPSHOT_VERSION_CURRENT);
+		return false;
+	}
+
+	// Snapshot type index to the type in this run
+	std::vector<FragmentTypeId_t> Types;
+
+	uint32_t TypeCount = 0;
+	Reader.Read(TypeCount);
+	std::string Name;
+	for (uint32_t TypeIt = 0; TypeIt < TypeCount && !Reader.Failed; TypeIt++)
+	{
+		uint32_t NameLength = 0;
+		Reader.Read(NameLength);
+		Name.resize(std::min<size_t>(NameLength, Reader.GetRemaining()));
+		Reader.ReadBytes(Name.data(), NameLength);
+
+		FragmentTypeInfo_s Saved;
+		Reader.Read(Saved.Size);
+		Reader.Read(Saved.Alignment);
+		Reader.Read(Saved.Storage);
+		if (Reader.Failed)
+			break;
+
+		FragmentTypeId_t Type = 0;
+		while (Type < EntityFragments::GetFragmentTypeCount() && Name != EntityFragments::GetFragmentTypeInfo(Type).Name)
+		{
+			Type++;
+		}
+
+		if (Type == EntityFragments::GetFragmentTypeCount())
+		{
+			LOGERROR("[Entity] Snapshot fragment type %s is not registered, it must be used once before restoring", Name.c_str());
+			return false;
+		}
+
+		const FragmentTypeInfo_s& Info = EntityFragments::GetFragmentTypeInfo(Type);
+		if (Info.Size != Saved.Size || Info.Alignment != Saved.Alignment || Info.Storage != Saved.Storage)
+		{
+			LOGERROR("[Entity] Snapshot fragment type %s changed size, alignment or storage since the snapshot was saved", Name.c_str());
+			return false;
+		}
+
+		if (!Info.TriviallyCopyable && !Info.LoadSnapshot)
+		{
+			LOGERROR("[Entity] Can not restore fragment type %s, it is not trivially copyable and has no SaveSnapshot and LoadSnapshot", Name.c_str());
+			return false;
+		}
+
+		Types.push_back(Type);
+	}
+
+	if (Reader.Failed)
+	{
+		LOGERROR("[Entity] Snapshot is truncated");
+		return false;
+	}
+
+	Clear();
+
+	// Everything restored reads as changed, whatever version a pass last ran at
+	const uint32_t RestoreVersion = AdvanceChangeVersion();
+
+	uint32_t SlotCount = 0;
+	Reader.Read(SlotCount);
+	if (SlotCount == 0 || SlotCount > EntityIds::MaxEntities + 1 || SlotCount > Reader.GetRemaining())
+	{
+		Reader.Failed = true;
+		SlotCount = 1;
+	}
+
+	Generations.resize(SlotCount);
+	Reader.ReadBytes(Generations.data(), SlotCount);
+	Locations.assign(SlotCount, EntityLocation_s());
+
+	uint32_t FreeCount = 0;
+	Reader.Read(FreeCount);
+	for (uint32_t FreeIt = 0; FreeIt < FreeCount && !Reader.Failed; FreeIt++)
+	{
+		uint32_t FreeIndex = 0;
+		Reader.Read(FreeIndex);
+		Reader.Failed |= FreeIndex == 0 || FreeIndex >= SlotCount;
+		FreeIndices.push_back(FreeIndex);
+	}
+
+	// Each entity must be one of the snapshot's allocated slots and appear once
+	auto ClaimSlot = [this, SlotCount](Entity_t Entity, uint32_t ArchetypeIndex, uint32_t Row)
+	{
+		const uint32_t Index = GetEntityIndex(Entity);
+		if (Index == 0 || Index >= SlotCount || Generations[Index] != GetEntityGeneration(Entity) || Locations[Index].Archetype != EntityLocation_s::FreeArchetype)
+			return false;
+
+		Locations[Index] = EntityLocation_s{ ArchetypeIndex, Row };
+		return true;
+	};
+
+	uint32_t AliveCount = 0;
+
+	uint32_t ArchetypeCount = 0;
+	Reader.Read(ArchetypeCount);
+	std::vector<FragmentTypeId_t> ArchetypeTypes;
+	std::vector<int32_t> Columns;
+	for (uint32_t ArchetypeIt = 0; ArchetypeIt < ArchetypeCount && !Reader.Failed; ArchetypeIt++)
+	{
+		uint32_t ColumnCount = 0;
+		Reader.Read(ColumnCount);
+		ArchetypeTypes.clear();
+		for (uint32_t ColumnIt = 0; ColumnIt < ColumnCount && !Reader.Failed; ColumnIt++)
+		{
+			uint32_t SnapshotType = UINT32_MAX;
+			Reader.Read(SnapshotType);
+			Reader.Failed |= SnapshotType >= Types.size() || EntityFragments::GetFragmentTypeInfo(Types[SnapshotType]).Storage != FragmentStorage_e::Table;
+			ArchetypeTypes.push_back(Reader.Failed ? 0 : Types[SnapshotType]);
+		}
+
+		uint32_t EntityCount = 0;
+		Reader.Read(EntityCount);
+		Reader.Failed |= EntityCount == 0 || EntityCount >= SlotCount || static_cast<size_t>(EntityCount) * sizeof(Entity_t) > Reader.GetRemaining();
+
+		std::vector<FragmentTypeId_t> SortedTypes = ArchetypeTypes;
+		std::sort(SortedTypes.begin(), SortedTypes.end());
+		Reader.Failed |= std::adjacent_find(SortedTypes.begin(), SortedTypes.end()) != SortedTypes.end();
+		if (Reader.Failed)
+			break;
+
+		const uint32_t ArchetypeIndex = FindOrCreateArchetype(SortedTypes);
+		EntityArchetype_s& Archetype = *Archetypes[ArchetypeIndex];
+		if (Archetype.EntityCount != 0)
+		{
+			Reader.Failed = true;
+			break;
+		}
+
+		Columns.clear();
+		for (FragmentTypeId_t Type : ArchetypeTypes)
+		{
+			Columns.push_back(Archetype.GetColumn(Type));
+		}
+
+		Archetype.LoadSnapshot(Reader, EntityCount, Columns, RestoreVersion);
+		if (Reader.Failed)
+			break;
+
+		uint32_t Row = 0;
+		for (const EntityChunk_s& Chunk : Archetype.Chunks)
+		{
+			const Entity_t* Entities = Archetype.GetEntities(Chunk);
+			for (uint32_t ChunkRow = 0; ChunkRow < Chunk.Count; ChunkRow++)
+			{
+				Reader.Failed |= !ClaimSlot(Entities[ChunkRow], ArchetypeIndex, Row++);
+			}
+		}
+		AliveCount += EntityCount;
+	}
+
+	uint32_t SparseSetCount = 0;
+	Reader.Read(SparseSetCount);
+	for (uint32_t SetIt = 0; SetIt < SparseSetCount && !Reader.Failed; SetIt++)
+	{
+		uint32_t SnapshotType = UINT32_MAX;
+		uint32_t Count = 0;
+		Reader.Read(SnapshotType);
+		Reader.Read(Count);
+		Reader.Failed |= SnapshotType >= Types.size() || EntityFragments::GetFragmentTypeInfo(Types[SnapshotType]).Storage != FragmentStorage_e::SparseSet
+			|| Count >= SlotCount || static_cast<size_t>(Count) * sizeof(Entity_t) > Reader.GetRemaining();
+		if (Reader.Failed)
+			break;
+
+		EntitySparseSet_s& Set = GetOrCreateSparseSet(Types[SnapshotType]);
+		if (Set.GetCount() != 0)
+		{
+			Reader.Failed = true;
+			break;
+		}
+
+		Set.LoadSnapshot(Reader, Count, RestoreVersion);
+		for (uint32_t DenseIt = 0; DenseIt < Count && !Reader.Failed; DenseIt++)
+		{
+			// A duplicate leaves the sparse entry pointing at its last copy
+			Reader.Failed |= !IsValid(Set.Entities[DenseIt]) || Set.Find(Set.Entities[DenseIt]) != DenseIt;
+		}
+	}
+
+	// Every slot is either alive or free, never both, or the allocator would hand out live indices
+	if (!Reader.Failed && AliveCount + FreeIndices.size() == SlotCount - 1)
+	{
+		std::vector<bool> Freed(SlotCount, false);
+		for (uint32_t FreeIndex : FreeIndices)
+		{
+			Reader.Failed |= Freed[FreeIndex] || Locations[FreeIndex].Archetype != EntityLocation_s::FreeArchetype;
+			Freed[FreeIndex] = true;
+		}
+	}
+	else
+	{
+		Reader.Failed = true;
+	}
+
+	if (Reader.Failed || Reader.GetRemaining() != 0)
+	{
+		LOGERROR("[Entity] Snapshot is corrupt or truncated, the registry is left empty");
+		Clear();
+		RebuildPresence();
+		return false;
+	}
+
+	RebuildPresence();
+	return true;
+}
+
+void EntityRegistry_s::Clear()
+{
+	for (const std::unique_ptr<EntityArchetype_s>& Archetype : Archetypes)
+	{
+		Archetype->Clear();
+	}
+
+	for (const std::unique_ptr<EntitySparseSet_s>& Set : SparseSets)
+	{
+		if (Set)
+		{
+			Set->Clear();
+		}
+	}
+
+	// Keeps index 0, Entity_t::INVALID
+	Locations.resize(1);
+	Generations.resize(1);
+	FreeIndices.clear();
+}
+
+void EntityRegistry_s::RebuildPresence()
+{
+	for (EntityBitField_s& Presence : FragmentPresence)
+	{
+		Presence.Pages.clear();
+	}
+
+	if (FragmentPresence.size() < EntityFragments::GetFragmentTypeCount())
+	{
+		FragmentPresence.resize(EntityFragments::GetFragmentTypeCount());
+	}
+
+	for (const std::unique_ptr<EntityArchetype_s>& Archetype : Archetypes)
+	{
+		for (const EntityChunk_s& Chunk : Archetype->Chunks)
+		{
+			const Entity_t* Entities = Archetype->GetEntities(Chunk);
+			for (FragmentTypeId_t Type : Archetype->Types)
+			{
+				EntityBitField_s& Presence = FragmentPresence[Type];
+				for (uint32_t Row = 0; Row < Chunk.Count; Row++)
+				{
+					Presence.SetBit(GetEntityIndex(Entities[Row]), true);
+				}
+			}
+		}
+	}
+
+	for (const std::unique_ptr<EntitySparseSet_s>& Set : SparseSets)
+	{
+		if (!Set)
+			continue;
+
+		EntityBitField_s& Presence = FragmentPresence[Set->Type];
+		for (Entity_t Entity : Set->Entities)
+		{
+			Presence.SetBit(GetEntityIndex(Entity), true);
+		}
+	}
+
+	std::vector<const EntityBitField_s*> Fields;
+	for (const auto& [Types, Query] : QueryCaches)
+	{
+		Fields.clear();
+		for (FragmentTypeId_t Type : Types)
+		{
+			Fields.push_back(&FragmentPresence[Type]);
+		}
+		Query->Matches.AssignIntersection(Fields.data(), Fields.size());
+	}
+}
+
+void EntityRegistry_s::SetPresence(uint32_t Index, FragmentTypeId_t Type, bool Present)
+{
+	if (FragmentPresence.size() <= Type)
+	{
+		FragmentPresence.resize(Type + 1);
+	}
+
+	FragmentPresence[Type].SetBit(Index, Present);
+
+	if (Type >= QueriesByType.size())
+		return;
+
+	for (EntityQueryCache_s* Query : QueriesByType[Type])
+	{
+		const bool Matches = Present && std::all_of(Query->Types.begin(), Query->Types.end(), [this, Index](FragmentTypeId_t QueryType)
+		{
+			return FragmentPresence[QueryType].GetBit(Index);
+		});
+		Query->Matches.SetBit(Index, Matches);
+	}
+}
+
+EntitySparseSet_s& EntityRegistry_s::GetOrCreateSparseSet(FragmentTypeId_t Type)
+{
+	if (SparseSets.size() <= Type)
+	{
+		SparseSets.resize(Type + 1);
+	}
+
+	if (!SparseSets[Type])
+	{
+		SparseSets[Type] = std::make_unique<EntitySparseSet_s>(Type);
+	}
+
+	return *SparseSets[Type];
+}
+
+uint32_t EntityRegistry_s::FindOrCreateArchetype(const std::vector<FragmentTypeId_t>& Types)
+{
+	auto Found = ArchetypesByTypes.find(Types);
+	if (Found != ArchetypesByTypes.end())
+		return Found->second;
+
+	const uint32_t Index = static_cast<uint32_t>(Archetypes.size());
+	Archetypes.push_back(std::make_unique<EntityArchetype_s>(Types));
+	ArchetypesByTypes.emplace(Types, Index);
+
+	return Index;
+}
+
+uint32_t EntityRegistry_s::GetArchetypeWith(uint32_t From, FragmentTypeId_t Type)
+{
+	uint32_t To = FindEdge(Archetypes[From]->AddEdges, Type);
+	if (To != UINT32_MAX)
+		return To;
+
+	std::vector<FragmentTypeId_t> Types = Archetypes[From]->Types;
+	Types.insert(std::upper_bound(Types.begin(), Types.end(), Type), Type);
+
+	To = FindOrCreateArchetype(Types);
+	Archetypes[From]->AddEdges.emplace_back(Type, To);
+	if (FindEdge(Archetypes[To]->RemoveEdges, Type) == UINT32_MAX)
+	{
+		Archetypes[To]->RemoveEdges.emplace_back(Type, From);
+	}
+
+	return To;
+}
+
+uint32_t EntityRegistry_s::GetArchetypeWithout(uint32_t From, FragmentTypeId_t Type)
+{
+	uint32_t To = FindEdge(Archetypes[From]->RemoveEdges, Type);
+	if (To != UINT32_MAX)
+		return To;
+
+	std::vector<FragmentTypeId_t> Types = Archetypes[From]->Types;
+	std::erase(Types, Type);
+
+	To = FindOrCreateArchetype(Types);
+	Archetypes[From]->RemoveEdges.emplace_back(Type, To);
+	if (FindEdge(Archetypes[To]->AddEdges, Type) == UINT32_MAX)
+	{
+		Archetypes[To]->AddEdges.emplace_back(Type, From);
+	}
+
+	return To;
+}
+
+uint32_t EntityRegistry_s::AllocateRow(EntityArchetype_s& Archetype, Entity_t Entity)
+{
+	if (Archetype.Chunks.empty() || Archetype.Chunks.back().Count == Archetype.ChunkCapacity)
+	{
+		EntityChunk_s& Chunk = Archetype.Chunks.emplace_back();
+		Chunk.Data = static_cast<uint8_t*>(::operator new(Archetype.ChunkBytes, std::align_val_t(EntityArchetype_s::ChunkAlignment)));
+		Chunk.ColumnVersions.resize(Archetype.Types.size());
+	}
+
+	EntityChunk_s& Chunk = Archetype.Chunks.back();
+	Archetype.MarkChunkChanged(Chunk, ChangeVersion);
+	Archetype.GetEntities(Chunk)[Chunk.Count++] = Entity;
+
+	return Archetype.EntityCount++;
+}
+
+void EntityRegistry_s::ReleaseRow(EntityArchetype_s& Archetype, uint32_t Row)
+{
+	const uint32_t LastRow = Archetype.EntityCount - 1;
+	EntityChunk_s& LastChunk = Archetype.Chunks.back();
+
+	if (Row != LastRow)
+	{
+		EntityChunk_s& Chunk = Archetype.Chunks[Row / Archetype.ChunkCapacity];
+		const Entity_t Moved = Archetype.GetEntities(LastChunk)[LastChunk.Count - 1];
+
+		for (uint32_t Column = 0; Column < Archetype.Types.size(); Column++)
+		{
+			const FragmentTypeInfo_s& Info = EntityFragments::GetFragmentTypeInfo(Archetype.Types[Column]);
+			Info.Relocate(Archetype.GetFragment(Row, Column), Archetype.GetFragment(LastRow, Column));
+		}
+
+		Archetype.GetEntities(Chunk)[Row % Archetype.ChunkCapacity] = Moved;
+		Archetype.MarkChunkChanged(Chunk, ChangeVersion);
+		GetLocation(Moved).Row = Row;
+	}
+
+	Archetype.EntityCount--;
+	if (--LastChunk.Count == 0)
+	{
+		::operator delete(LastChunk.Data, std::align_val_t(EntityArchetype_s::ChunkAlignment));
+		Archetype.Chunks.pop_back();
+	}
+}
+
+void EntityRegistry_s::MoveEntity(Entity_t Entity, uint32_t ToArchetype)
+{
+	EntityLocation_s& Location = GetLocation(Entity);
+	EntityArchetype_s& From = *Archetypes[Location.Archetype];
+	EntityArchetype_s& To = *Archetypes[ToArchetype];
+
+	const uint32_t FromRow = Location.Row;
+	const uint32_t ToRow = AllocateRow(To, Entity);
+
+	for (uint32_t Column = 0; Column < From.Types.size(); Column++)
+	{
+		const FragmentTypeInfo_s& Info = EntityFragments::GetFragmentTypeInfo(From.Types[Column]);
+		const int32_t ToColumn = To.GetColumn(From.Types[Column]);
+		if (ToColumn >= 0)
+		{
+			Info.Relocate(To.GetFragment(ToRow, ToColumn), From.GetFragment(FromRow, Column));
+		}
+		else
+		{
+			Info.Destroy(From.GetFragment(FromRow, Column));
+		}
+	}
+
+	ReleaseRow(From, FromRow);
+
+	Location.Archetype = ToArchetype;
+	Location.Row = ToRow;
+}
@@ -0,0 +1,282 @@
+#include "Entity/EntitySystems.h"
+
+#include <Shared/Logging/Logging.h>
+#include <Shared/Threading/TaskPool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+
+bool Overlaps(const std::vector<FragmentTypeId_t>& A, const std::vector<FragmentTypeId_t>& B) noexcept
+{
+	for (FragmentTypeId_t Type : A)
+	{
+		if (std::find(B.begin(), B.end(), Type) != B.end())
+			return true;
+	}
+
+	return false;
+}
+
+void AppendTypes(std::string& Out, const char* Label, const std::vector<FragmentTypeId_t>& Types)
+{
+	if (Types.empty())
+		return;
+
+	Out += Label;
+	for (size_t TypeIt = 0; TypeIt < Types.size(); TypeIt++)
+	{
+		Out += TypeIt == 0 ? " " : ", ";
+		Out += EntityFragments::GetFragmentTypeInfo(Types[TypeIt]).Name;
+	}
+}
+
+}
+
+bool EntitySystemAccess_s::ConflictsWith(const EntitySystemAccess_s& Other) const noexcept
+{
+	if (Structural || Other.Structural)
+		return true;
+
+	return Overlaps(Writes, Other.Writes) || Overlaps(Writes, Other.Reads) || Overlaps(Reads, Other.Writes);
+}
+
+EntitySystemScheduler_c::EntitySystemScheduler_c(TaskPool_c& InPool)
+	: Pool(InPool)
+{}
+
+EntitySystemId_t EntitySystemScheduler_c::AddSystem(std::string Name, EntitySystemAccess_s Access, EntitySystemFunction_t Function)
+{
+	if (!ENSUREMSG(static_cast<bool>(Function), "[EntitySystemScheduler] System %s has no function and will not be added", Name.c_str()))
+		return 0;
+
+	System_s& System = Systems.emplace_back();
+	System.Id = NextSystemId++;
+	System.Name = std::move(Name);
+	System.Access = std::move(Access);
+	System.Function = std::move(Function);
+
+	return System.Id;
+}
+
+void EntitySystemScheduler_c::RemoveSystem(EntitySystemId_t Id)
+{
+	std::erase_if(Systems, [Id](const System_s& System) { return System.Id == Id; });
+
+	// Indexes into Systems, rebuilt by the next Run
+	Nodes.clear();
+}
+
+void EntitySystemScheduler_c::SetSystemEnabled(EntitySystemId_t Id, bool Enabled)
+{
+	for (System_s& System : Systems)
+	{
+		if (System.Id == Id)
+		{
+			System.Enabled = Enabled;
+			return;
+		}
+	}
+
+	LOGWARNING("[EntitySystemScheduler] No system with id %u", Id);
+}
+
+void EntitySystemScheduler_c::BuildGraph()
+{
+	uint32_t EnabledCount = 0;
+	for (const System_s& System : Systems)
+	{
+		EnabledCount += System.Enabled ? 1 : 0;
+	}
+
+	Nodes = std::vector<Node_s>(EnabledCount);
+
+	uint32_t NodeIndex = 0;
+	for (uint32_t SystemIt = 0; SystemIt < Systems.size(); SystemIt++)
+	{
+		if (!Systems[SystemIt].Enabled)
+			continue;
+
+		Node_s& Node = Nodes[NodeIndex];
+		Node.System = SystemIt;
+
+		// Only earlier systems are considered, which keeps the graph acyclic and conflicting systems in the order added
+		for (uint32_t EarlierIt = 0; EarlierIt < NodeIndex; EarlierIt++)
+		{
+			Node_s& Earlier = Nodes[EarlierIt];
+			if (!Systems[SystemIt].Access.ConflictsWith(Systems[Earlier.System].Access))
+				continue;
+
+			Node.Dependencies.push_back(EarlierIt);
+			Node.Depth = std::max(Node.Depth, Earlier.Depth + 1);
+			Earlier.Dependents.push_back(NodeIndex);
+		}
+
+		Node.PendingDependencies.store(static_cast<uint32_t>(Node.Dependencies.size()), std::memory_order_relaxed);
+		NodeIndex++;
+	}
+}
+
+void EntitySystemScheduler_c::Run(float Delta)
+{
+	BuildGraph();
+	if (Nodes.empty())
+		return;
+
+	FrameDelta = Delta;
+	CompletedNodes.store(0, std::memory_order_relaxed);
+
+	for (uint32_t NodeIt = 0; NodeIt < Nodes.size(); NodeIt++)
+	{
+		if (Nodes[NodeIt].Dependencies.empty())
+		{
+			Launch(NodeIt);
+		}
+	}
+
+	while (CompletedNodes.load(std::memory_order_acquire) < Nodes.size())
+	{
+		uint32_t StructuralNode = UINT32_MAX;
+		{
+			std::lock_guard Lock(StructuralMutex);
+			if (!ReadyStructural.empty())
+			{
+				StructuralNode = ReadyStructural.back();
+				ReadyStructural.pop_back();
+			}
+		}
+
+		if (StructuralNode != UINT32_MAX)
+		{
+			RunNode(StructuralNode);
+			continue;
+		}
+
+		const uint32_t ParallelNode = TakeReadyNode(*ReadyParallel);
+		if (ParallelNode != UINT32_MAX)
+		{
+			RunNode(ParallelNode);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void EntitySystemScheduler_c::Launch(uint32_t NodeIndex)
+{
+	if (Systems[Nodes[NodeIndex].System].Access.Structural)
+	{
+		std::lock_guard Lock(StructuralMutex);
+		ReadyStructural.push_back(NodeIndex);
+		return;
+	}
+
+	{
+		std::lock_guard Lock(ReadyParallel->Mutex);
+		ReadyParallel->Nodes.push_back(NodeIndex);
+	}
+
+	// Runs whichever node is ready by then, possibly none if the thread in Run took it first. A node taken here
+	// counts towards CompletedNodes, so Run and the scheduler outlive it.
+	Pool.Push([this, Ready = ReadyParallel]()
+	{
+		const uint32_t ReadyNode = TakeReadyNode(*Ready);
+		if (ReadyNode != UINT32_MAX)
+		{
+			RunNode(ReadyNode);
+		}
+	});
+}
+
+uint32_t EntitySystemScheduler_c::TakeReadyNode(ReadyNodes_s& Ready)
+{
+	std::lock_guard Lock(Ready.Mutex);
+	if (Ready.Nodes.empty())
+		return UINT32_MAX;
+
+	const uint32_t NodeIndex = Ready.Nodes.back();
+	Ready.Nodes.pop_back();
+	return NodeIndex;
+}
+
+void EntitySystemScheduler_c::RunNode(uint32_t NodeIndex)
+{
+	Node_s& Node = Nodes[NodeIndex];
+	System_s& System = Systems[Node.System];
+
+	EntitySystemContext_s Context;
+	Context.Delta = FrameDelta;
+	Context.LastRunVersion = System.LastRunVersion;
+
+	// Writes from here on are stamped after anything the system saw, systems running alongside may advance
+	// it further, which at worst has the system see some of its own writes as changed next time
+	const uint32_t StartVersion = GetEntityRegistry().AdvanceChangeVersion();
+
+	const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	System.Function(Context);
+	System.LastRunMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+	System.LastRunVersion = StartVersion;
+
+	for (uint32_t Dependent : Node.Dependents)
+	{
+		if (Nodes[Dependent].PendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			Launch(Dependent);
+		}
+	}
+
+	CompletedNodes.fetch_add(1, std::memory_order_release);
+}
+
+std::string EntitySystemScheduler_c::DumpSchedule() const
+{
+	uint32_t MaxDepth = 0;
+	size_t EdgeCount = 0;
+	for (const Node_s& Node : Nodes)
+	{
+		MaxDepth = std::max(MaxDepth, Node.Depth);
+		EdgeCount += Node.Dependencies.size();
+	}
+
+	char Line[160];
+	snprintf(Line, sizeof(Line), "%zu systems, %zu dependencies, %u steps on the longest path\n", Nodes.size(), EdgeCount, Nodes.empty() ? 0 : MaxDepth + 1);
+	std::string Out = Line;
+
+	for (const Node_s& Node : Nodes)
+	{
+		const System_s& System = Systems[Node.System];
+
+		snprintf(Line, sizeof(Line), "  [%u] %s%s, %.3f ms.", Node.Depth, System.Name.c_str(), System.Access.Structural ? " (structural)" : "", System.LastRunMs);
+		Out += Line;
+
+		AppendTypes(Out, " Reads", System.Access.Reads);
+		AppendTypes(Out, " Writes", System.Access.Writes);
+
+		if (!Node.Dependencies.empty())
+		{
+			Out += " After";
+			for (size_t DependencyIt = 0; DependencyIt < Node.Dependencies.size(); DependencyIt++)
+			{
+				Out += DependencyIt == 0 ? " " : ", ";
+				Out += Systems[Nodes[Node.Dependencies[DependencyIt]].System].Name;
+			}
+		}
+
+		Out += "\n";
+	}
+
+	for (const System_s& System : Systems)
+	{
+		if (!System.Enabled)
+		{
+			Out += "  (disabled) " + System.Name + "\n";
+		}
+	}
+
+	return Out;
+}
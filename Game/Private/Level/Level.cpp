@@ -1,10 +1,15 @@
 #include "Level/Level.h"
 
+#include "Assets/AssetPackages.h"
 #include "Space/Space.h"
 
+#include <HalfPipe/Source/Public/HPLevel.h>
+#include <HalfPipe/Source/Public/HPPackage.h>
 #include <Shared/Logging/Logging.h>
 #include <Shared/FileUtils/JsonHelpers.h>
 #include <Shared/FileUtils/JsonValue.h>
+#include <Shared/FileUtils/PathUtils.h>
+#include <Shared/StringUtils/StringUtils.h>
 
 #include <fstream>
 
@@ -145,45 +150,398 @@ bool ParseLevel(const Json_t& Root, LevelData_s& Out)
 	return true;
 }
 
+// Checks every table in a cooked level lies inside the file, so the loader can index them freely
+bool ValidateCookedLevel(const uint8_t* Data, size_t Size, const std::wstring& LevelPath)
+{
+	if (Size < sizeof(HPLevelHeader_s))
+	{
+		LOGERROR("[Level] Cooked level %S is too small for its header", LevelPath.c_str());
+		return false;
+	}
+
+	const HPLevelHeader_s& Header = *reinterpret_cast<const HPLevelHeader_s*>(Data);
+	if (Header.Magic != HPLevelMagic)
+	{
+		LOGERROR("[Level] %S is not a cooked level", LevelPath.c_str());
+		return false;
+	}
+
+	if (Header.Version != HPLevelVersion_e::CURRENT)
+	{
+		LOGERROR("[Level] Cooked level %S has version %u, expected %u. Recook it.", LevelPath.c_str(), static_cast<uint32_t>(Header.Version), static_cast<uint32_t>(HPLevelVersion_e::CURRENT));
+		return false;
+	}
+
+	auto TableFits = [Size](uint64_t Offset, uint64_t Count, uint64_t Stride)
+	{
+		return Offset + Count * Stride <= Size;
+	};
+
+	if (!TableFits(Header.ClassTableOffset, Header.ClassCount, sizeof(HPLevelClass_s))
+		|| !TableFits(Header.ObjectTableOffset, Header.ObjectCount, sizeof(HPLevelObject_s))
+		|| !TableFits(Header.ComponentTableOffset, Header.ComponentCount, sizeof(HPLevelComponent_s))
+		|| !TableFits(Header.StringTableOffset, Header.StringTableSize, 1)
+		|| !TableFits(Header.PayloadOffset, Header.PayloadSize, 1))
+	{
+		LOGERROR("[Level] Cooked level %S is truncated", LevelPath.c_str());
+		return false;
+	}
+
+	return true;
 }
 
-void Level_c::Deserialize(const std::wstring& LevelPath)
+// Queues the mesh asset an object or component node refers to, if any, so it can be read ahead of spawning
+void GatherMeshAsset(const Json_t& Node, std::vector<std::wstring>& OutMeshAssetPaths)
 {
-	Json_t Data;
-	if (!LoadJsonFromFile(LevelPath, Data))
+	std::wstring MeshAssetPath;
+	if (JsonHelpers::ParseWString(Node, "MeshAssetPath", MeshAssetPath))
 	{
-		LOGERROR("[Level] Failed to load json from file %S", LevelPath.c_str());
-		return;
+		OutMeshAssetPaths.push_back(std::move(MeshAssetPath));
 	}
+}
 
+}
+
+// A level read from disk that has not been spawned yet.
+// Parse and GatherMeshAssets touch nothing outside the source so may run on any thread, the rest run on the main thread.
+struct LevelSource_s
+{
+	virtual ~LevelSource_s() = default;
+
+	virtual bool Parse(const std::wstring& LevelPath) = 0;
+	virtual void GatherMeshAssets(std::vector<std::wstring>& OutMeshAssetPaths) = 0;
+
+	// Called once before the first SpawnObject
+	virtual void Resolve(Space_c& Space) {}
+
+	virtual uint32_t GetObjectCount() const = 0;
+
+	// Null if the object's class is unknown
+	virtual std::shared_ptr<Object_c> SpawnObject(Space_c& Space, uint32_t Index) = 0;
+};
+
+namespace
+{
+
+struct JsonLevelSource_s : LevelSource_s
+{
 	LevelData_s LevelData;
-	if (!ParseLevel(Data, LevelData))
+
+	bool Parse(const std::wstring& LevelPath) override
 	{
-		LOGERROR("[Level] Failed to deserialize level %S", LevelPath.c_str());
-		return;
+		HPAssetBytes_s Asset;
+		Json_t Data;
+		if (!AssetPackages::Load(LevelPath, Asset) || !LoadJsonFromBytes(Asset.Bytes, Data))
+		{
+			LOGERROR("[Level] Failed to load json from file %S", LevelPath.c_str());
+			return false;
+		}
+
+		if (!ParseLevel(Data, LevelData))
+		{
+			LOGERROR("[Level] Failed to deserialize level %S", LevelPath.c_str());
+			return false;
+		}
+
+		LOGINFO("[Level] Deserialized %S, version %d, %zu objects", LevelPath.c_str(), LevelData.Version, LevelData.Objects.size());
+		return true;
 	}
 
-	LOGINFO("[Level] Deserialized %S, version %d, %zu objects", LevelPath.c_str(), LevelData.Version, LevelData.Objects.size());
+	void GatherMeshAssets(std::vector<std::wstring>& OutMeshAssetPaths) override
+	{
+		for (const LevelData_s::ObjectData_s& Object : LevelData.Objects)
+		{
+			GatherMeshAsset(Object.Data, OutMeshAssetPaths);
 
-	// TODO: Spawn the objects described by LevelData
+			for (const LevelData_s::ComponentData_s& Component : Object.Components)
+			{
+				GatherMeshAsset(Component.Data, OutMeshAssetPaths);
+			}
+		}
+	}
 
-	if (Space_c* Space = GetSpace())
+	uint32_t GetObjectCount() const override
+	{
+		return static_cast<uint32_t>(LevelData.Objects.size());
+	}
+
+	std::shared_ptr<Object_c> SpawnObject(Space_c& Space, uint32_t Index) override
 	{
-		for (LevelData_s::ObjectData_s& Object : LevelData.Objects)
+		LevelData_s::ObjectData_s& Object = LevelData.Objects[Index];
+		JsonValue_s ObjectData(Object.Data);
+		std::shared_ptr<Object_c> NewObject = Space.CreateObjectByName(Object.Class, &ObjectData);
+
+		// Nothing reads the node again, free it as we go
+		Object.Data = Json_t();
+		Object.Components.clear();
+
+		return NewObject;
+	}
+};
+
+struct CookedLevelSource_s : LevelSource_s
+{
+	// Points into the mapped package when packaged, so the tables are read in place
+	HPAssetBytes_s Asset;
+
+	const HPLevelHeader_s* Header = nullptr;
+	const HPLevelObject_s* LevelObjects = nullptr;
+	const HPLevelComponent_s* LevelComponents = nullptr;
+	const uint8_t* Payload = nullptr;
+
+	std::vector<std::wstring> ClassNames;
+	std::vector<HPLevelClassKind_e> ClassKinds;
+
+	// Resolved once per class rather than looking up a name per object
+	std::vector<const Space_c::ObjectFactory_t*> ObjectFactories;
+	std::vector<const Space_c::ComponentFactory_t*> ComponentFactories;
+
+	Json_t PayloadJson;
+
+	bool Parse(const std::wstring& LevelPath) override
+	{
+		if (!AssetPackages::Load(LevelPath, Asset))
 		{
-			JsonValue_s ObjectData(Object.Data);
-			Space->CreateObjectByName(Object.Class, &ObjectData);
+			LOGERROR("[Level] Failed to open cooked level %S", LevelPath.c_str());
+			return false;
 		}
+
+		if (!ValidateCookedLevel(Asset.Bytes.data(), Asset.Bytes.size(), LevelPath))
+			return false;
+
+		const uint8_t* const Data = Asset.Bytes.data();
+		Header = reinterpret_cast<const HPLevelHeader_s*>(Data);
+		LevelObjects = reinterpret_cast<const HPLevelObject_s*>(Data + Header->ObjectTableOffset);
+		LevelComponents = reinterpret_cast<const HPLevelComponent_s*>(Data + Header->ComponentTableOffset);
+		Payload = Data + Header->PayloadOffset;
+
+		const HPLevelClass_s* const Classes = reinterpret_cast<const HPLevelClass_s*>(Data + Header->ClassTableOffset);
+		const char* const Strings = reinterpret_cast<const char*>(Data + Header->StringTableOffset);
+
+		ClassNames.reserve(Header->ClassCount);
+		ClassKinds.reserve(Header->ClassCount);
+		for (uint32_t ClassIt = 0; ClassIt < Header->ClassCount; ClassIt++)
+		{
+			const HPLevelClass_s& Class = Classes[ClassIt];
+			if (static_cast<uint64_t>(Class.NameOffset) + Class.NameLength > Header->StringTableSize)
+			{
+				LOGERROR("[Level] Cooked level %S has a class name outside its string table", LevelPath.c_str());
+				return false;
+			}
+
+			ClassNames.push_back(NarrowToWide(std::string(Strings + Class.NameOffset, Class.NameLength)));
+			ClassKinds.push_back(Class.Kind);
+		}
+
+		LOGINFO("[Level] Opened cooked level %S, %u objects", LevelPath.c_str(), Header->ObjectCount);
+		return true;
+	}
+
+	bool DecodePayload(uint32_t Offset, uint32_t Size, Json_t& OutJson) const
+	{
+		if (Size == 0 || static_cast<uint64_t>(Offset) + Size > Header->PayloadSize)
+			return false;
+
+		OutJson = Json_t::from_cbor(Payload + Offset, Payload + Offset + Size, true, false);
+		return !OutJson.is_discarded();
 	}
+
+	void GatherMeshAssets(std::vector<std::wstring>& OutMeshAssetPaths) override
+	{
+		for (uint32_t ObjectIt = 0; ObjectIt < Header->ObjectCount; ObjectIt++)
+		{
+			const HPLevelObject_s& LevelObject = LevelObjects[ObjectIt];
+			if (DecodePayload(LevelObject.PayloadOffset, LevelObject.PayloadSize, PayloadJson))
+			{
+				GatherMeshAsset(PayloadJson, OutMeshAssetPaths);
+			}
+		}
+
+		for (uint32_t ComponentIt = 0; ComponentIt < Header->ComponentCount; ComponentIt++)
+		{
+			const HPLevelComponent_s& LevelComponent = LevelComponents[ComponentIt];
+			if (DecodePayload(LevelComponent.PayloadOffset, LevelComponent.PayloadSize, PayloadJson))
+			{
+				GatherMeshAsset(PayloadJson, OutMeshAssetPaths);
+			}
+		}
+	}
+
+	void Resolve(Space_c& Space) override
+	{
+		ObjectFactories.assign(ClassNames.size(), nullptr);
+		ComponentFactories.assign(ClassNames.size(), nullptr);
+
+		for (size_t ClassIt = 0; ClassIt < ClassNames.size(); ClassIt++)
+		{
+			const std::wstring& ClassName = ClassNames[ClassIt];
+			if (ClassKinds[ClassIt] == HPLevelClassKind_e::OBJECT)
+			{
+				ObjectFactories[ClassIt] = Space.FindObjectFactory(ClassName);
+				ENSUREMSG(ObjectFactories[ClassIt], "[Level] No object class registered for name '%S', its objects will be skipped", ClassName.c_str());
+			}
+			else
+			{
+				ComponentFactories[ClassIt] = Space.FindComponentFactory(ClassName);
+				ENSUREMSG(ComponentFactories[ClassIt], "[Level] No component class registered for name '%S', its components will be skipped", ClassName.c_str());
+			}
+		}
+	}
+
+	uint32_t GetObjectCount() const override
+	{
+		return Header->ObjectCount;
+	}
+
+	std::shared_ptr<Object_c> SpawnObject(Space_c& Space, uint32_t Index) override
+	{
+		const HPLevelObject_s& LevelObject = LevelObjects[Index];
+		if (LevelObject.ClassIndex >= Header->ClassCount || !ObjectFactories[LevelObject.ClassIndex])
+			return nullptr;
+
+		std::shared_ptr<Object_c> NewObject;
+		if (DecodePayload(LevelObject.PayloadOffset, LevelObject.PayloadSize, PayloadJson))
+		{
+			JsonValue_s ObjectData(PayloadJson);
+			NewObject = Space.CreateObjectFromFactory(*ObjectFactories[LevelObject.ClassIndex], &ObjectData);
+		}
+		else
+		{
+			NewObject = Space.CreateObjectFromFactory(*ObjectFactories[LevelObject.ClassIndex]);
+		}
+
+		if (LevelObject.Flags & HPLEVEL_OBJECT_HAS_TRANSFORM)
+		{
+			if (SpatialObject_c* SpatialObject = dynamic_cast<SpatialObject_c*>(NewObject.get()))
+			{
+				SpatialObject->SetTransform(
+					float3(LevelObject.Position[0], LevelObject.Position[1], LevelObject.Position[2]),
+					float3(LevelObject.Rotation[0], LevelObject.Rotation[1], LevelObject.Rotation[2]),
+					LevelObject.Scale);
+			}
+		}
+
+		const uint64_t ComponentEnd = static_cast<uint64_t>(LevelObject.FirstComponent) + LevelObject.ComponentCount;
+		for (uint64_t ComponentIt = LevelObject.FirstComponent; ComponentIt < ComponentEnd && ComponentIt < Header->ComponentCount; ComponentIt++)
+		{
+			const HPLevelComponent_s& LevelComponent = LevelComponents[ComponentIt];
+			if (LevelComponent.ClassIndex >= Header->ClassCount || !ComponentFactories[LevelComponent.ClassIndex])
+				continue;
+
+			const Space_c::ComponentFactory_t& Factory = *ComponentFactories[LevelComponent.ClassIndex];
+			if (DecodePayload(LevelComponent.PayloadOffset, LevelComponent.PayloadSize, PayloadJson))
+			{
+				JsonValue_s ComponentData(PayloadJson);
+				Space.CreateComponentFromFactory(NewObject.get(), Factory, &ComponentData);
+			}
+			else
+			{
+				Space.CreateComponentFromFactory(NewObject.get(), Factory);
+			}
+		}
+
+		return NewObject;
+	}
+};
+
+}
+
+Level_c::Level_c(const std::shared_ptr<Space_c>& InOwningSpace)
+	: OwningSpace(InOwningSpace)
+{
+}
+
+Level_c::~Level_c() = default;
+
+void Level_c::Deserialize(const std::wstring& LevelPath)
+{
+	if (ParseSource(LevelPath))
+	{
+		SpawnSourceObjects(std::chrono::steady_clock::time_point::max());
+	}
+}
+
+bool Level_c::ParseSource(const std::wstring& LevelPath)
+{
+	NextSourceObject = 0;
+
+	if (HasPathExtension(LevelPath, L".hp_clv"))
+	{
+		Source = std::make_unique<CookedLevelSource_s>();
+	}
+	else
+	{
+		Source = std::make_unique<JsonLevelSource_s>();
+	}
+
+	if (!Source->Parse(LevelPath))
+	{
+		Source.reset();
+		return false;
+	}
+
+	return true;
+}
+
+void Level_c::GatherSourceMeshAssets(std::vector<std::wstring>& OutMeshAssetPaths)
+{
+	if (Source)
+	{
+		Source->GatherMeshAssets(OutMeshAssetPaths);
+	}
+}
+
+uint32_t Level_c::GetSourceObjectCount() const
+{
+	return Source ? Source->GetObjectCount() : 0;
+}
+
+bool Level_c::SpawnSourceObjects(std::chrono::steady_clock::time_point Deadline)
+{
+	Space_c* Space = GetSpace();
+	if (!Space || !Source)
+	{
+		Source.reset();
+		return true;
+	}
+
+	const uint32_t ObjectCount = Source->GetObjectCount();
+	if (NextSourceObject == 0)
+	{
+		Source->Resolve(*Space);
+
+		Space->ReserveObjects(ObjectCount);
+		Objects.reserve(Objects.size() + ObjectCount);
+	}
+
+	// Always make some progress, however little budget is left
+	do
+	{
+		if (NextSourceObject >= ObjectCount)
+			break;
+
+		if (std::shared_ptr<Object_c> NewObject = Source->SpawnObject(*Space, NextSourceObject))
+		{
+			Objects.push_back(NewObject->GetHandle());
+		}
+		NextSourceObject++;
+	}
+	while (std::chrono::steady_clock::now() < Deadline);
+
+	if (NextSourceObject < ObjectCount)
+		return false;
+
+	Source.reset();
+	return true;
 }
 
 void Level_c::Unload()
 {
 	if (Space_c* Space = GetSpace())
 	{
-		for (const std::shared_ptr<class Object_c>& LevelObject : Objects)
+		for (ObjectHandle_s LevelObject : Objects)
 		{
-			Space->DestroyObject(LevelObject.get());
+			Space->DestroyObject(LevelObject);
 		}
 	}
 
@@ -0,0 +1,276 @@
+#include "Level/LevelStreamer.h"
+
+#include "Assets/AssetPackages.h"
+#include "Level/Level.h"
+#include "Level/LevelLoad.h"
+#include "Space/Space.h"
+
+#include <HalfPipe/Source/Public/HPPackage.h>
+#include <Shared/FileUtils/JsonHelpers.h>
+#include <Shared/FileUtils/JsonValue.h>
+#include <Shared/FileUtils/PathUtils.h>
+#include <Shared/Logging/Logging.h>
+
+#include <algorithm>
+
+#define WORLD_VERSION_INITIAL 1
+#define WORLD_VERSION_CURRENT WORLD_VERSION_INITIAL
+
+namespace
+{
+
+float DistanceToBox(const AABB& Box, const float3& Point) noexcept
+{
+	const float3 Delta = MinVector(MaxVector(Point, Box.mins), Box.maxs) - Point;
+	return sqrtf(Dot(Delta, Delta));
+}
+
+}
+
+LevelStreamer_c::~LevelStreamer_c() = default;
+
+bool LevelStreamer_c::LoadWorld(const Path_s& WorldPath)
+{
+	UnloadWorld();
+
+	const std::wstring WorldPathString = WorldPath.ToWString();
+
+	HPAssetBytes_s Asset;
+	Json_t Root;
+	if (!AssetPackages::Load(WorldPathString, Asset) || !LoadJsonFromBytes(Asset.Bytes, Root) || !Root.is_object())
+	{
+		LOGERROR("[LevelStreamer] Failed to load world %S", WorldPathString.c_str());
+		return false;
+	}
+
+	int32_t Version = -1;
+	JsonHelpers::ParseInt(Root, "Version", Version);
+	if (Version != WORLD_VERSION_CURRENT)
+	{
+		LOGERROR("[LevelStreamer] Unsupported world version %d in %S, expected %d", Version, WorldPathString.c_str(), WORLD_VERSION_CURRENT);
+		return false;
+	}
+
+	auto CellsIt = Root.find("Cells");
+	if (CellsIt == Root.end() || !CellsIt->is_array())
+	{
+		LOGERROR("[LevelStreamer] World %S requires a 'Cells' array", WorldPathString.c_str());
+		return false;
+	}
+
+	float NewLoadDistance = LoadDistance;
+	float NewUnloadDistance = UnloadDistance;
+	JsonHelpers::ParseFloat(Root, "LoadDistance", NewLoadDistance);
+	JsonHelpers::ParseFloat(Root, "UnloadDistance", NewUnloadDistance);
+	SetDistances(NewLoadDistance, NewUnloadDistance);
+
+	// Cell levels are relative to the world file
+	const size_t DirectoryEnd = WorldPathString.find_last_of(L"/\\");
+	const std::wstring WorldDirectory = DirectoryEnd == std::wstring::npos ? std::wstring() : WorldPathString.substr(0, DirectoryEnd + 1);
+
+	Cells.reserve(CellsIt->size());
+	for (const Json_t& CellNode : *CellsIt)
+	{
+		Cell_s Cell;
+		if (!JsonHelpers::ParseWString(CellNode, "Level", Cell.LevelPath) || Cell.LevelPath.empty())
+		{
+			LOGWARNING("[LevelStreamer] Skipping cell without a 'Level' in world %S", WorldPathString.c_str());
+			continue;
+		}
+
+		float3 Min;
+		float3 Max;
+		if (!JsonHelpers::ParseFloat3(CellNode, "Min", Min) || !JsonHelpers::ParseFloat3(CellNode, "Max", Max))
+		{
+			LOGWARNING("[LevelStreamer] Skipping cell %S without 'Min' and 'Max' bounds", Cell.LevelPath.c_str());
+			continue;
+		}
+
+		Cell.LevelPath = WorldDirectory + Cell.LevelPath;
+		Cell.Bounds = AABB(Min, Max);
+		JsonHelpers::ParseInt(CellNode, "Size", Cell.SizeEstimate);
+
+		Cells.push_back(std::move(Cell));
+	}
+
+	Stats = {};
+	Stats.CellCount = static_cast<uint32_t>(Cells.size());
+
+	LOGINFO("[LevelStreamer] Loaded world %S, %zu cells", WorldPathString.c_str(), Cells.size());
+	return true;
+}
+
+void LevelStreamer_c::UnloadWorld()
+{
+	for (Cell_s& Cell : Cells)
+	{
+		UnloadCell(Cell);
+		CancelLoad(Cell);
+	}
+
+	Cells.clear();
+	PendingBytes = 0;
+	Stats = {};
+}
+
+void LevelStreamer_c::SetDistances(float InLoadDistance, float InUnloadDistance) noexcept
+{
+	LoadDistance = std::max(InLoadDistance, 0.0f);
+	UnloadDistance = std::max(InUnloadDistance, LoadDistance);
+}
+
+void LevelStreamer_c::Update(const float3& ViewPosition, float Delta)
+{
+	std::erase_if(AbandonedLoads, [this](const std::shared_ptr<LevelLoadHandle_c>& Load)
+	{
+		if (!Load->IsDone())
+			return false;
+
+		Space.UnloadLevel(Load->GetLevel());
+		return true;
+	});
+
+	if (Cells.empty())
+		return;
+
+	for (Cell_s& Cell : Cells)
+	{
+		Cell.Distance = DistanceToBox(Cell.Bounds, ViewPosition);
+	}
+
+	PollLoads();
+
+	for (Cell_s& Cell : Cells)
+	{
+		if (Cell.Distance > UnloadDistance)
+		{
+			UnloadCell(Cell);
+			CancelLoad(Cell);
+		}
+	}
+
+	CellOrder.clear();
+	for (uint32_t CellIt = 0; CellIt < Cells.size(); CellIt++)
+	{
+		const Cell_s& Cell = Cells[CellIt];
+		if (!Cell.Level && !Cell.Load && !Cell.Failed && Cell.Distance <= LoadDistance)
+		{
+			CellOrder.push_back(CellIt);
+		}
+	}
+
+	std::sort(CellOrder.begin(), CellOrder.end(), [this](uint32_t A, uint32_t B)
+	{
+		return Cells[A].Distance < Cells[B].Distance;
+	});
+
+	Stats.DeferredCells = 0;
+	for (size_t OrderIt = 0; OrderIt < CellOrder.size(); OrderIt++)
+	{
+		if (Stats.PendingLoads >= MaxConcurrentLoads)
+			break;
+
+		Cell_s& Cell = Cells[CellOrder[OrderIt]];
+		if (!MakeRoom(Cell.SizeEstimate, Cell.Distance))
+		{
+			// Anything farther would only need more room
+			Stats.DeferredCells = static_cast<uint32_t>(CellOrder.size() - OrderIt);
+			break;
+		}
+
+		Cell.Load = Space.LoadLevelAsync(Path_s(Cell.LevelPath));
+		PendingBytes += Cell.SizeEstimate;
+		Stats.PendingLoads++;
+	}
+
+	BandwidthWindowTime += Delta;
+	if (BandwidthWindowTime >= 1.0f)
+	{
+		Stats.BytesPerSecond = static_cast<float>(BandwidthWindowBytes) / BandwidthWindowTime;
+		BandwidthWindowBytes = 0;
+		BandwidthWindowTime = 0.0f;
+	}
+}
+
+void LevelStreamer_c::PollLoads()
+{
+	for (Cell_s& Cell : Cells)
+	{
+		if (!Cell.Load || !Cell.Load->IsDone())
+			continue;
+
+		const std::shared_ptr<LevelLoadHandle_c> Load = std::move(Cell.Load);
+		PendingBytes -= Cell.SizeEstimate;
+		Stats.PendingLoads--;
+
+		const uint64_t BytesRead = Load->GetBytesRead();
+		Stats.TotalBytesStreamed += BytesRead;
+		BandwidthWindowBytes += BytesRead;
+
+		Cell.Level = Load->GetLevel();
+		if (!Cell.Level)
+		{
+			LOGWARNING("[LevelStreamer] Cell %S failed to load and will not be retried", Cell.LevelPath.c_str());
+			Cell.Failed = true;
+			continue;
+		}
+
+		// Meshes shared with cells already resident are not read again, so this undercounts them, which only
+		// makes the budget more lenient
+		Cell.SizeEstimate = BytesRead;
+		Stats.ResidentBytes += Cell.SizeEstimate;
+		Stats.ResidentCells++;
+	}
+}
+
+void LevelStreamer_c::UnloadCell(Cell_s& Cell)
+{
+	if (!Cell.Level)
+		return;
+
+	Space.UnloadLevel(Cell.Level);
+	Cell.Level = nullptr;
+
+	Stats.ResidentBytes -= std::min(Cell.SizeEstimate, Stats.ResidentBytes);
+	Stats.ResidentCells--;
+}
+
+void LevelStreamer_c::CancelLoad(Cell_s& Cell)
+{
+	if (!Cell.Load)
+		return;
+
+	// Loads that already started spawning finish anyway, their levels are unloaded as they do
+	Cell.Load->Cancel();
+	AbandonedLoads.push_back(std::move(Cell.Load));
+
+	PendingBytes -= std::min(Cell.SizeEstimate, PendingBytes);
+	Stats.PendingLoads--;
+}
+
+bool LevelStreamer_c::MakeRoom(uint64_t NeededBytes, float Distance)
+{
+	auto Fits = [this, NeededBytes]()
+	{
+		return Stats.ResidentBytes + PendingBytes + NeededBytes <= MemoryBudget;
+	};
+
+	while (!Fits())
+	{
+		Cell_s* Farthest = nullptr;
+		for (Cell_s& Cell : Cells)
+		{
+			if (Cell.Level && Cell.Distance > Distance && (!Farthest || Cell.Distance > Farthest->Distance))
+			{
+				Farthest = &Cell;
+			}
+		}
+
+		if (!Farthest)
+			return false;
+
+		UnloadCell(*Farthest);
+	}
+
+	return true;
+}
@@ -1,8 +1,8 @@
 #include "Object/CameraComponent.h"
 
 #include "Input/Input.h"
+#include "Object/SpatialObject.h"
 #include "Space/Space.h"
-#include "Utility/Transform.h"
 
 void CameraComponent_c::OnCreate()
 {
@@ -24,8 +24,12 @@ void CameraComponent_c::PreDestroy()
 
 matrix CameraComponent_c::CalculateViewMatrix() const
 {
-	float3 Position = GetTransform().GetPosition();
-	float3 LookDir = GetTransform().GetForwardVector();
+	const SpatialObject_c* Owner = GetSpatialOwner();
+	if (!Owner)
+		return MakeMatrixIdentity();
+
+	float3 Position = Owner->GetWorldPosition();
+	float3 LookDir = Owner->GetForwardVector();
 	float3 Target = Position + LookDir;
 	return MakeMatrixLookAtLH(Position, Target, float3{ 0, 1, 0 });
 }
@@ -40,3 +44,18 @@ matrix CameraComponent_c::CalculateProjectionMatrix(u32 ScreenWidth, u32 ScreenH
 	const float AspectRatio = static_cast<float>(ScreenWidth) / static_cast<float>(ScreenHeight);
 	return CalculateProjectionMatrix(AspectRatio);
 }
+
+Frustum CameraComponent_c::CalculateWorldFrustum(float AspectRatio) const
+{
+	const SpatialObject_c* Owner = GetSpatialOwner();
+	if (!Owner)
+		return MakeFrustum(ConvertToRadians(Fov), AspectRatio, NearZ, FarZ);
+
+	return MakeWorldFrustum(Owner->GetWorldPosition(), Owner->GetForwardVector(), float3{ 0, 1, 0 }, ConvertToRadians(Fov), AspectRatio, NearZ, FarZ);
+}
+
+Frustum CameraComponent_c::CalculateWorldFrustum(u32 ScreenWidth, u32 ScreenHeight) const
+{
+	const float AspectRatio = static_cast<float>(ScreenWidth) / static_cast<float>(ScreenHeight);
+	return CalculateWorldFrustum(AspectRatio);
+}
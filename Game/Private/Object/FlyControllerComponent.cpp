@@ -4,6 +4,13 @@
 #include "Object/SpatialObject.h"
 #include "Utility/Transform.h"
 
+void FlyControllerComponent_c::DescribeTick(ComponentTickDesc_s& Desc) const
+{
+	Desc.Phase = TickPhase_e::PrePhysics;
+	Desc.ThreadSafe = true;
+	Desc.Writes.push_back(Transform_s::StaticTypeId());
+}
+
 void FlyControllerComponent_c::Update(float Delta)
 {
 	if (Input::IsMouseButtonDown(1))
@@ -23,13 +23,27 @@ void MeshComponent_c::Render(SpatialRenderingCollector_s& Collector)
 {
 	if (Mesh)
 	{
-		Mesh->Render(Collector, rl::CreateDynamicConstantBuffer(&GetTransform().GetMatrix()));
+		Mesh->Render(Collector, rl::CreateDynamicConstantBuffer(&GetWorldMatrix()));
 	}
 }
 
+bool MeshComponent_c::GetLocalBounds(AABB& OutBounds) const
+{
+	if (!Mesh)
+		return false;
+
+	OutBounds = Mesh->Bounds;
+	return true;
+}
+
 void MeshComponent_c::SetMesh(const std::shared_ptr<struct Mesh_s>& InMesh)
 {
 	Mesh = InMesh;
+
+	if (SpatialObject_c* Owner = GetSpatialOwner())
+	{
+		Owner->MarkBoundsDirty();
+	}
 }
 
 void MeshObject_c::Deserialize(const JsonValue_s& Data)
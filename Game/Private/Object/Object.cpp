@@ -21,7 +21,7 @@ void Object_c::Deserialize(const JsonValue_s& Data)
 			std::wstring Class;
 			for (const Json_t& ComponentNode : *ComponentsIt)
 			{
-				if (ENSUREMSG(JsonHelpers::ParseWString(Node, "Class", Class), "[Object] Deserialized component entry does not have a 'Class'"))
+				if (ENSUREMSG(JsonHelpers::ParseWString(ComponentNode, "Class", Class), "[Object] Deserialized component entry does not have a 'Class'"))
 				{
 					JsonValue_s ComponentData(ComponentNode);
 					AddComponentByName(Class, &ComponentData);
@@ -35,11 +35,11 @@ void Object_c::Deserialize(const JsonValue_s& Data)
 	}
 }
 
-void Object_c::Update(float Delta)
+void Object_c::PreDestroy()
 {
-	ForEachComponent([Delta](ObjectComponent_c* Component)
+	ForEachComponent([](ObjectComponent_c* Component)
 	{
-		Component->Update(Delta);
+		Component->PreDestroy();
 		return true;
 	});
 }
@@ -51,3 +51,50 @@ void Object_c::AddComponentByName(const std::wstring& ClassName, const JsonValue
 		Space->CreateComponentByName(this, ClassName, Data);
 	}
 }
+
+void Object_c::AddComponentInternal(const std::shared_ptr<ObjectComponent_c>& NewComponent)
+{
+	CHECK(NewComponent != nullptr);
+
+	Components.push_back(NewComponent);
+
+	for (TypeId_t Type = NewComponent->GetTypeId(); Type != InvalidTypeId; Type = TypeRegistry::GetParentType(Type))
+	{
+		// Insert after any entries of the same type so components of a type stay in the order they were added
+		auto It = std::upper_bound(ComponentTypeMap.begin(), ComponentTypeMap.end(), Type, [](TypeId_t Value, const ComponentTypeEntry_s& Entry)
+		{
+			return Value < Entry.Type;
+		});
+		ComponentTypeMap.insert(It, ComponentTypeEntry_s{ Type, NewComponent.get() });
+	}
+
+	if (Space_c* Space = GetSpace())
+	{
+		Space->RegisterComponentInstance(NewComponent.get());
+	}
+}
+
+void Object_c::RemoveComponent(ObjectComponent_c* Component)
+{
+	auto It = std::find_if(Components.begin(), Components.end(), [Component](const std::shared_ptr<ObjectComponent_c>& CompPtr)
+	{
+		return CompPtr.get() == Component;
+	});
+
+	if (It == Components.end())
+		return;
+
+	Component->PreDestroy();
+
+	std::erase_if(ComponentTypeMap, [Component](const ComponentTypeEntry_s& Entry)
+	{
+		return Entry.Component == Component;
+	});
+
+	if (Space_c* Space = GetSpace())
+	{
+		Space->UnregisterComponentInstance(Component);
+	}
+
+	Components.erase(It);
+}
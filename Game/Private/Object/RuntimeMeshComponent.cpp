@@ -6,10 +6,19 @@
 
 void RuntimeMeshComponent_c::Render(SpatialRenderingCollector_s& Collector)
 {
-	rl::DynamicBuffer_t DynamicUniforms = rl::CreateDynamicConstantBuffer(&GetTransform().GetMatrix());
+	rl::DynamicBuffer_t DynamicUniforms = rl::CreateDynamicConstantBuffer(&GetWorldMatrix());
 	Mesh->Render(Collector, DynamicUniforms);
 }
 
+bool RuntimeMeshComponent_c::GetLocalBounds(AABB& OutBounds) const
+{
+	if (!Mesh)
+		return false;
+
+	OutBounds = Mesh->Bounds;
+	return true;
+}
+
 void RuntimeMeshComponent_c::UpdateMesh(const RuntimeMeshDesc_s& Desc)
 {
 	if (!Desc.Positions || Desc.Positions->empty())
@@ -24,6 +33,11 @@ void RuntimeMeshComponent_c::UpdateMesh(const RuntimeMeshDesc_s& Desc)
 
 	Mesh = std::make_shared<Mesh_s>();
 
+	for (const float3& Position : *Desc.Positions)
+	{
+		Mesh->Bounds.Grow(Position);
+	}
+
 	Mesh->PositionBuffer = rl::CreateStructuredBuffer(Desc.Positions->data(), Desc.Positions->size());
 	Mesh->PositionBufferSRV = rl::CreateStructuredBufferSRV(Mesh->PositionBuffer, 0, static_cast<uint32_t>(Desc.Positions->size()), static_cast<uint32_t>(sizeof(float3)));
 
@@ -38,6 +52,11 @@ void RuntimeMeshComponent_c::UpdateMesh(const RuntimeMeshDesc_s& Desc)
 	MeshUniformData_s MeshData = {};
 	MeshData.PositionBufferIndex = rl::GetDescriptorIndex(Mesh->PositionBufferSRV);
 	Mesh->MeshUniforms = rl::CreateConstantBuffer(&MeshData);
+
+	if (SpatialObject_c* Owner = GetSpatialOwner())
+	{
+		Owner->MarkBoundsDirty();
+	}
 }
 
 void RuntimeMeshComponent_c::SetMaterial(BasicMaterial_c* InMaterial)
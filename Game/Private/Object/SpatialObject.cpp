@@ -1,12 +1,17 @@
 #include "Object/SpatialObject.h"
 
+#include "Space/Space.h"
+
 #include <Shared/FileUtils/JsonHelpers.h>
 #include <Shared/FileUtils/JsonValue.h>
+#include <Shared/Logging/Logging.h>
 
 SpatialObject_c::SpatialObject_c(const ObjectArgs_s& Args)
 	: Object_c(Args)
+	, Transforms(&Args.OwningSpace->GetTransforms())
 {
-
+	TransformId = Transforms->Allocate();
+	Args.OwningSpace->RegisterSpatialObject(this);
 }
 
 void SpatialObject_c::Deserialize(const JsonValue_s& Data)
@@ -17,7 +22,58 @@ void SpatialObject_c::Deserialize(const JsonValue_s& Data)
 	float3 Rotation = {};
 	float Scale = 1.0f;
 	JsonHelpers::ParseFloat3(Data, "Position", Position);
-	JsonHelpers::ParseFloat3(Data, "Rotation", Position);
+	JsonHelpers::ParseFloat3(Data, "Rotation", Rotation);
 	JsonHelpers::ParseFloat(Data, "Scale", Scale);
-	Transform.Set(Position, Rotation, Scale);
+	SetTransform(Position, Rotation, Scale);
+}
+
+void SpatialObject_c::PreDestroy()
+{
+	Object_c::PreDestroy();
+
+	if (Space_c* Space = GetSpace())
+	{
+		Space->UnregisterSpatialObject(this);
+	}
+
+	if (TransformId != InvalidTransformId)
+	{
+		Transforms->Free(TransformId);
+		TransformId = InvalidTransformId;
+	}
+}
+
+AABB SpatialObject_c::CalculateLocalBounds()
+{
+	AABB Bounds;
+	bool HasBounds = false;
+
+	ForEachComponentType<SpatialObjectComponent_c>([&Bounds, &HasBounds](SpatialObjectComponent_c* Component)
+	{
+		AABB ComponentBounds;
+		if (Component->GetLocalBounds(ComponentBounds))
+		{
+			Bounds.Grow(ComponentBounds);
+			HasBounds = true;
+		}
+		return true;
+	});
+
+	return HasBounds ? Bounds : AABB(float3(0.0f), float3(0.0f));
+}
+
+AABB SpatialObject_c::CalculateWorldBounds()
+{
+	return CalculateLocalBounds().GetTransformed(GetWorldMatrix());
+}
+
+bool SpatialObject_c::SetParent(SpatialObject_c* NewParent)
+{
+	if (!EnsureTransform() || (NewParent && !NewParent->EnsureTransform()))
+		return false;
+
+	if (NewParent && !ENSUREMSG(NewParent->Transforms == Transforms, "[SpatialObject] Cannot parent to an object in another space"))
+		return false;
+
+	return Transforms->SetParent(TransformId, NewParent ? NewParent->TransformId : InvalidTransformId);
 }
@@ -26,9 +26,9 @@ void SpatialObjectComponent_c::Deserialize(const JsonValue_s& Data)
 	//Transform.Set(Position, Rotation, Scale);
 }
 
-const Transform_s& SpatialObjectComponent_c::GetTransform() const
+const matrix& SpatialObjectComponent_c::GetWorldMatrix() const
 {
-	static const Transform_s DefaultTransform = {};
+	static const matrix DefaultMatrix = MakeMatrixIdentity();
 	const SpatialObject_c* Owner = GetSpatialOwner();
-	return Owner ? Owner->GetTransform() : DefaultTransform;
+	return Owner ? Owner->GetWorldMatrix() : DefaultMatrix;
 }
\ No newline at end of file
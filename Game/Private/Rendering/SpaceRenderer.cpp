@@ -2,6 +2,7 @@
 
 #include "Object/CameraComponent.h"
 #include "Object/ObjectComponent.h"
+#include "Object/SpatialObject.h"
 #include "Rendering/IRenderable.h"
 #include "Space/Space.h"
 #include <Render/Render.h>
@@ -78,16 +79,20 @@ void SpaceRenderer_c::RenderSpace(const SpaceRendererScreenInfo_s& Screen, Space
 
 	SpatialRenderingCollector_s Collector = {};
 
-	for (std::shared_ptr<Object_c>& Object : Space->Objects)
+	// Renderables are all spatial components, so only objects whose bounds touch the view need visiting
+	const Frustum ViewFrustum = Cam->CalculateWorldFrustum(Screen.Width, Screen.Height);
+	Space->QueryFrustum(ViewFrustum, [&Collector](SpatialObject_c* Object)
 	{
-		for (std::shared_ptr<ObjectComponent_c>& Component : Object->Components)
+		Object->ForEachComponentType<SpatialObjectComponent_c>([&Collector](SpatialObjectComponent_c* Component)
 		{
-			if (IRenderable_c* Renderable = dynamic_cast<IRenderable_c*>(Component.get()))
+			if (IRenderable_c* Renderable = dynamic_cast<IRenderable_c*>(Component))
 			{
 				Renderable->Render(Collector);
 			}
-		}
-	}
+			return true;
+		});
+		return true;
+	});
 
 	SpaceViewUniforms_s ViewUniforms = {};
 	ViewUniforms.ViewProjection = ViewMatrix * ProjectionMatrix;
@@ -1,45 +1,490 @@
 #include "Space/Space.h"
+#include "Assets/MeshManager.h"
 #include "Object/CameraComponent.h"
 #include "Object/Object.h"
+#include "Object/SpatialObject.h"
 #include "Level/Level.h"
+#include "Level/LevelLoad.h"
 
 #include <Shared/FileUtils/PathUtils.h>
 #include <Shared/Logging/Logging.h>
+#include <Shared/Threading/TaskPool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+namespace
+{
+
+// Component instances per task when a wave is spread across the task pool
+constexpr uint32_t TickBatchSize = 64;
+
+// Threads reading levels and prefetching their meshes
+constexpr uint32_t LevelLoadThreadCount = 2;
+
+// Level loads block on IO for their whole run. They get their own threads rather than the shared pool, whose
+// waiters help with queued tasks and could otherwise end up running a whole load inside a frame.
+TaskPool_c& GetLevelLoadPool()
+{
+	static TaskPool_c Pool(LevelLoadThreadCount);
+	return Pool;
+}
+
+bool TickTypesOverlap(TypeId_t A, TypeId_t B)
+{
+	return TypeRegistry::IsA(A, B) || TypeRegistry::IsA(B, A);
+}
+
+// True if anything Writer writes (including itself) is read or written by Other
+bool TickWritesOverlap(TypeId_t WriterType, const ComponentTickDesc_s& Writer, TypeId_t OtherType, const ComponentTickDesc_s& Other)
+{
+	auto OverlapsOtherAccess = [&](TypeId_t Written)
+	{
+		if (TickTypesOverlap(Written, OtherType))
+			return true;
+
+		for (TypeId_t Read : Other.Reads)
+		{
+			if (TickTypesOverlap(Written, Read))
+				return true;
+		}
+
+		for (TypeId_t OtherWritten : Other.Writes)
+		{
+			if (TickTypesOverlap(Written, OtherWritten))
+				return true;
+		}
+
+		return false;
+	};
+
+	if (OverlapsOtherAccess(WriterType))
+		return true;
+
+	for (TypeId_t Written : Writer.Writes)
+	{
+		if (OverlapsOtherAccess(Written))
+			return true;
+	}
+
+	return false;
+}
+
+bool TicksConflict(TypeId_t TypeA, const ComponentTickDesc_s& A, TypeId_t TypeB, const ComponentTickDesc_s& B)
+{
+	if (!A.ThreadSafe || !B.ThreadSafe)
+		return true;
+
+	return TickWritesOverlap(TypeA, A, TypeB, B) || TickWritesOverlap(TypeB, B, TypeA, A);
+}
+
+}
 
 void Space_c::Update(float Delta)
 {
-	for (auto& Object : Objects)
+	if (LevelStreamer.HasWorld())
 	{
-		Object->Update(Delta);
+		std::shared_ptr<CameraComponent_c> Camera = PrimaryCamera.lock();
+		if (SpatialObject_c* CameraOwner = Camera ? Camera->GetSpatialOwner() : nullptr)
+		{
+			LevelStreamer.Update(CameraOwner->GetWorldPosition(), Delta);
+		}
 	}
+
+	UpdateLevelLoads();
+
+	// Pick up anything created between frames, e.g. by level loads
+	FlushPendingObjects();
+
+	if (TickScheduleDirty)
+	{
+		BuildTickSchedule();
+	}
+
+	for (uint32_t Phase = 0; Phase < static_cast<uint32_t>(TickPhase_e::Count); Phase++)
+	{
+		if (Phase == static_cast<uint32_t>(TickPhase_e::PreRender))
+		{
+			UpdateWorldTransforms();
+		}
+
+		for (const TickWave_s& Wave : TickSchedule[Phase])
+		{
+			RunTickWave(Wave, Delta);
+		}
+	}
+
+	FlushPendingObjects();
+
+	UpdateWorldTransforms();
+}
+
+void Space_c::UpdateWorldTransforms()
+{
+	UpdatedTransforms.clear();
+	Transforms.UpdateWorldMatrices(&UpdatedTransforms);
+
+	for (TransformId_t Id : UpdatedTransforms)
+	{
+		// Freed transforms can still be queued from before they were freed
+		SpatialObject_c* Object = Id < SpatialObjectsByTransform.size() ? SpatialObjectsByTransform[Id] : nullptr;
+		if (!Object)
+			continue;
+
+		const AABB WorldBounds = Object->CalculateWorldBounds();
+
+		SpatialProxyId_t& Proxy = SpatialProxiesByTransform[Id];
+		if (Proxy == InvalidSpatialProxyId)
+		{
+			Proxy = SpatialIndex.CreateProxy(WorldBounds, Id);
+		}
+		else
+		{
+			SpatialIndex.MoveProxy(Proxy, WorldBounds);
+		}
+	}
+}
+
+SpatialObject_c* Space_c::RayCastClosest(const float3& Origin, const float3& Direction, float MaxDistance, float* OutDistance) const
+{
+	SpatialObject_c* Closest = nullptr;
+	float ClosestDistance = MaxDistance;
+
+	// Bounds around the origin, such as a room the ray starts in, would otherwise hide everything in front of it
+	SpatialObject_c* Containing = nullptr;
+
+	RayCast(Origin, Direction, MaxDistance, [&Closest, &ClosestDistance, &Containing](SpatialObject_c* Object, float Distance)
+	{
+		if (Distance <= 0.0f)
+		{
+			Containing = Containing ? Containing : Object;
+			return ClosestDistance;
+		}
+
+		Closest = Object;
+		ClosestDistance = Distance;
+		return Distance;
+	});
+
+	if (!Closest && Containing)
+	{
+		Closest = Containing;
+		ClosestDistance = 0.0f;
+	}
+
+	if (OutDistance)
+	{
+		*OutDistance = ClosestDistance;
+	}
+
+	return Closest;
+}
+
+void Space_c::RegisterSpatialObject(SpatialObject_c* Object)
+{
+	const TransformId_t Id = Object->GetTransformId();
+	if (SpatialObjectsByTransform.size() <= Id)
+	{
+		SpatialObjectsByTransform.resize(Id + 1, nullptr);
+		SpatialProxiesByTransform.resize(Id + 1, InvalidSpatialProxyId);
+	}
+
+	SpatialObjectsByTransform[Id] = Object;
+}
+
+void Space_c::UnregisterSpatialObject(SpatialObject_c* Object)
+{
+	const TransformId_t Id = Object->GetTransformId();
+	if (Id >= SpatialObjectsByTransform.size() || SpatialObjectsByTransform[Id] != Object)
+		return;
+
+	if (SpatialProxiesByTransform[Id] != InvalidSpatialProxyId)
+	{
+		SpatialIndex.DestroyProxy(SpatialProxiesByTransform[Id]);
+		SpatialProxiesByTransform[Id] = InvalidSpatialProxyId;
+	}
+
+	SpatialObjectsByTransform[Id] = nullptr;
+}
+
+void Space_c::BuildTickSchedule()
+{
+	TickScheduleDirty = false;
+
+	for (uint32_t Phase = 0; Phase < static_cast<uint32_t>(TickPhase_e::Count); Phase++)
+	{
+		std::vector<TickWave_s>& Waves = TickSchedule[Phase];
+		Waves.clear();
+
+		// Types in id order, so that conflicting types always tick in registration order
+		std::vector<TypeId_t> PhaseTypes;
+		std::vector<uint32_t> TypeWaves;
+
+		for (TypeId_t Type = 1; Type < TickDescs.size(); Type++)
+		{
+			const std::optional<ComponentTickDesc_s>& Desc = TickDescs[Type];
+			if (!Desc || !Desc->Ticks || static_cast<uint32_t>(Desc->Phase) != Phase)
+				continue;
+
+			// Each type goes in the first wave after every earlier type it conflicts with
+			uint32_t Wave = 0;
+			for (size_t EarlierIt = 0; EarlierIt < PhaseTypes.size(); EarlierIt++)
+			{
+				const TypeId_t EarlierType = PhaseTypes[EarlierIt];
+				if (TicksConflict(Type, *Desc, EarlierType, *TickDescs[EarlierType]))
+				{
+					Wave = std::max(Wave, TypeWaves[EarlierIt] + 1);
+				}
+			}
+
+			PhaseTypes.push_back(Type);
+			TypeWaves.push_back(Wave);
+
+			if (Waves.size() <= Wave)
+			{
+				Waves.resize(Wave + 1);
+			}
+
+			Waves[Wave].Types.push_back(Type);
+			Waves[Wave].ThreadSafe &= Desc->ThreadSafe;
+		}
+	}
+}
+
+void Space_c::RunTickWave(const TickWave_s& Wave, float Delta)
+{
+	if (!Wave.ThreadSafe)
+	{
+		// Only ever one type in a wave that is not thread safe. Index rather than iterate as the tick may add components.
+		const TypeId_t Type = Wave.Types.front();
+		for (size_t ComponentIt = 0; ComponentIt < ComponentsByType[Type].size(); ComponentIt++)
+		{
+			ComponentsByType[Type][ComponentIt]->Update(Delta);
+		}
+		return;
+	}
+
+	TickWaveOffsets.clear();
+	uint32_t ComponentCount = 0;
+	for (TypeId_t Type : Wave.Types)
+	{
+		TickWaveOffsets.push_back(ComponentCount);
+		ComponentCount += static_cast<uint32_t>(ComponentsByType[Type].size());
+	}
+
+	if (ComponentCount == 0)
+		return;
+
+	ParallelTickActive = true;
+
+	TaskPool_c::Get().ParallelFor(ComponentCount, TickBatchSize, [this, &Wave, Delta](uint32_t Begin, uint32_t End)
+	{
+		// Find the type the batch starts in, batches may then run on into the following types
+		size_t TypeIt = std::upper_bound(TickWaveOffsets.begin(), TickWaveOffsets.end(), Begin) - TickWaveOffsets.begin() - 1;
+
+		for (uint32_t WorkIt = Begin; WorkIt < End; WorkIt++)
+		{
+			while (TypeIt + 1 < TickWaveOffsets.size() && WorkIt >= TickWaveOffsets[TypeIt + 1])
+			{
+				TypeIt++;
+			}
+
+			ComponentsByType[Wave.Types[TypeIt]][WorkIt - TickWaveOffsets[TypeIt]]->Update(Delta);
+		}
+	});
+
+	ParallelTickActive = false;
 }
 
 void Space_c::DestroyObject(Object_c* Object)
 {
 	if (Object)
 	{
-		std::erase(Objects, Object->shared_from_this());
+		DestroyObject(Object->GetHandle());
 	}
 }
 
-std::shared_ptr<Object_c> Space_c::CreateObjectByName(const std::wstring& ClassName, const JsonValue_s* const Data)
+void Space_c::DestroyObject(ObjectHandle_s Handle)
 {
-	auto It = ObjectFactoryCallbacks.find(ClassName);
-	if (!ENSUREMSG(It != ObjectFactoryCallbacks.end(), "No object class registered for name '%S'", ClassName.c_str()))
+	ASSERTMSG(!ParallelTickActive, "Objects cannot be destroyed from a thread safe tick");
+
+	Object_c* Object = ResolveObject(Handle);
+	if (Object && !Object->PendingDestroy)
 	{
+		Object->PendingDestroy = true;
+		PendingDestroys.push_back(Handle);
+	}
+}
+
+Object_c* Space_c::ResolveObject(ObjectHandle_s Handle) const noexcept
+{
+	if (Handle.Index >= ObjectSlots.size())
 		return nullptr;
+
+	const ObjectSlot_s& Slot = ObjectSlots[Handle.Index];
+	return Slot.Generation == Handle.Generation ? Slot.Object : nullptr;
+}
+
+void Space_c::ReserveObjects(uint32_t AdditionalCount)
+{
+	PendingCreates.reserve(PendingCreates.size() + AdditionalCount);
+
+	if (FreeObjectSlots.size() < AdditionalCount)
+	{
+		ObjectSlots.reserve(ObjectSlots.size() + AdditionalCount - FreeObjectSlots.size());
 	}
+}
 
-	std::shared_ptr<Object_c> NewObject = It->second(ObjectArgs_s{ this });
-	Objects.push_back(NewObject);
+void Space_c::AddObjectInternal(const std::shared_ptr<Object_c>& NewObject)
+{
+	CHECK(NewObject && !NewObject->Handle.IsValid());
+	ASSERTMSG(!ParallelTickActive, "Objects cannot be created from a thread safe tick");
 
-	if (Data)
+	uint32_t SlotIndex = 0;
+	if (FreeObjectSlots.empty())
 	{
-		NewObject->Deserialize(*Data);
+		SlotIndex = static_cast<uint32_t>(ObjectSlots.size());
+		ObjectSlots.emplace_back();
+	}
+	else
+	{
+		SlotIndex = FreeObjectSlots.back();
+		FreeObjectSlots.pop_back();
 	}
 
-	NewObject->OnCreate();
-	return NewObject;
+	ObjectSlot_s& Slot = ObjectSlots[SlotIndex];
+	Slot.Object = NewObject.get();
+	Slot.DenseIndex = InvalidDenseIndex;
+
+	NewObject->Handle = ObjectHandle_s{ SlotIndex, Slot.Generation };
+
+	PendingCreates.push_back(NewObject);
+}
+
+void Space_c::FlushPendingObjects()
+{
+	if (!PendingCreates.empty())
+	{
+		Objects.reserve(Objects.size() + PendingCreates.size());
+
+		for (std::shared_ptr<Object_c>& NewObject : PendingCreates)
+		{
+			ObjectSlots[NewObject->Handle.Index].DenseIndex = static_cast<uint32_t>(Objects.size());
+			Objects.push_back(std::move(NewObject));
+		}
+
+		PendingCreates.clear();
+	}
+
+	// PreDestroy may queue further destroys, so index rather than iterate
+	for (size_t PendingIt = 0; PendingIt < PendingDestroys.size(); PendingIt++)
+	{
+		const ObjectHandle_s Handle = PendingDestroys[PendingIt];
+		Object_c* const Object = ResolveObject(Handle);
+		if (!Object)
+			continue;
+
+		Object->PreDestroy();
+
+		for (const std::shared_ptr<ObjectComponent_c>& Component : Object->Components)
+		{
+			UnregisterComponentInstance(Component.get());
+		}
+
+		ObjectSlot_s& Slot = ObjectSlots[Handle.Index];
+		const uint32_t DenseIndex = Slot.DenseIndex;
+
+		Slot.Object = nullptr;
+		Slot.DenseIndex = InvalidDenseIndex;
+		Slot.Generation++;
+		FreeObjectSlots.push_back(Handle.Index);
+
+		// A creation queued after the last flush can only have been destroyed by a PreDestroy in this loop,
+		// and is still in PendingCreates rather than Objects
+		if (DenseIndex == InvalidDenseIndex)
+		{
+			std::erase_if(PendingCreates, [Object](const std::shared_ptr<Object_c>& Pending) { return Pending.get() == Object; });
+			continue;
+		}
+
+		// Swap remove, patching up the slot of the object that moved into the hole
+		const uint32_t LastIndex = static_cast<uint32_t>(Objects.size() - 1);
+		if (DenseIndex != LastIndex)
+		{
+			std::swap(Objects[DenseIndex], Objects[LastIndex]);
+			ObjectSlots[Objects[DenseIndex]->Handle.Index].DenseIndex = DenseIndex;
+		}
+		Objects.pop_back();
+	}
+
+	PendingDestroys.clear();
+
+	if (PruneMeshesAfterFlush)
+	{
+		MeshManager::PruneExpiredMeshes();
+		PruneMeshesAfterFlush = false;
+	}
+}
+
+const std::vector<ObjectComponent_c*>& Space_c::GetComponentsOfExactType(TypeId_t Type) const
+{
+	static const std::vector<ObjectComponent_c*> Empty;
+	return Type < ComponentsByType.size() ? ComponentsByType[Type] : Empty;
+}
+
+void Space_c::RegisterComponentInstance(ObjectComponent_c* Component)
+{
+	CHECK(Component && Component->SpaceComponentIndex == UINT32_MAX);
+	ASSERTMSG(!ParallelTickActive, "Components cannot be added from a thread safe tick");
+
+	const TypeId_t Type = Component->GetTypeId();
+	if (ComponentsByType.size() <= Type)
+	{
+		ComponentsByType.resize(Type + 1);
+		TickDescs.resize(Type + 1);
+	}
+
+	if (!TickDescs[Type])
+	{
+		ComponentTickDesc_s& Desc = TickDescs[Type].emplace();
+		Component->DescribeTick(Desc);
+		TickScheduleDirty = true;
+	}
+
+	std::vector<ObjectComponent_c*>& TypeComponents = ComponentsByType[Type];
+	Component->SpaceComponentIndex = static_cast<uint32_t>(TypeComponents.size());
+	TypeComponents.push_back(Component);
+}
+
+void Space_c::UnregisterComponentInstance(ObjectComponent_c* Component)
+{
+	if (!Component || Component->SpaceComponentIndex == UINT32_MAX)
+		return;
+
+	ASSERTMSG(!ParallelTickActive, "Components cannot be removed from a thread safe tick");
+
+	std::vector<ObjectComponent_c*>& TypeComponents = ComponentsByType[Component->GetTypeId()];
+	const uint32_t Index = Component->SpaceComponentIndex;
+	CHECK(Index < TypeComponents.size() && TypeComponents[Index] == Component);
+
+	// Swap remove to keep the array dense
+	TypeComponents[Index] = TypeComponents.back();
+	TypeComponents[Index]->SpaceComponentIndex = Index;
+	TypeComponents.pop_back();
+
+	Component->SpaceComponentIndex = UINT32_MAX;
+}
+
+std::shared_ptr<Object_c> Space_c::CreateObjectByName(const std::wstring& ClassName, const JsonValue_s* const Data)
+{
+	const ObjectFactory_t* Factory = FindObjectFactory(ClassName);
+	if (!ENSUREMSG(Factory, "No object class registered for name '%S'", ClassName.c_str()))
+	{
+		return nullptr;
+	}
+
+	return CreateObjectFromFactory(*Factory, Data);
 }
 
 std::shared_ptr<ObjectComponent_c> Space_c::CreateComponentByName(Object_c* Owner, const std::wstring& ClassName, const JsonValue_s* const Data)
@@ -47,14 +492,47 @@ std::shared_ptr<ObjectComponent_c> Space_c::CreateComponentByName(Object_c* Owne
 	if (!Owner)
 		return nullptr;
 
-	auto It = ComponentFactoryCallbacks.find(ClassName);
-	if (!ENSUREMSG(It != ComponentFactoryCallbacks.end(), "No component class registered for name '%S'", ClassName.c_str()))
+	const ComponentFactory_t* Factory = FindComponentFactory(ClassName);
+	if (!ENSUREMSG(Factory, "No component class registered for name '%S'", ClassName.c_str()))
 	{
 		return nullptr;
 	}
 
-	std::shared_ptr<ObjectComponent_c> NewComponent = It->second(ObjectComponentArgs_s{ Owner->shared_from_this() });
-	Owner->Components.push_back(NewComponent);
+	return CreateComponentFromFactory(Owner, *Factory, Data);
+}
+
+const Space_c::ObjectFactory_t* Space_c::FindObjectFactory(const std::wstring& ClassName) const
+{
+	auto It = ObjectFactoryCallbacks.find(ClassName);
+	return It != ObjectFactoryCallbacks.end() ? &It->second : nullptr;
+}
+
+const Space_c::ComponentFactory_t* Space_c::FindComponentFactory(const std::wstring& ClassName) const
+{
+	auto It = ComponentFactoryCallbacks.find(ClassName);
+	return It != ComponentFactoryCallbacks.end() ? &It->second : nullptr;
+}
+
+std::shared_ptr<Object_c> Space_c::CreateObjectFromFactory(const ObjectFactory_t& Factory, const JsonValue_s* const Data)
+{
+	std::shared_ptr<Object_c> NewObject = Factory(ObjectArgs_s{ this });
+	AddObjectInternal(NewObject);
+
+	if (Data)
+	{
+		NewObject->Deserialize(*Data);
+	}
+
+	NewObject->OnCreate();
+	return NewObject;
+}
+
+std::shared_ptr<ObjectComponent_c> Space_c::CreateComponentFromFactory(Object_c* Owner, const ComponentFactory_t& Factory, const JsonValue_s* const Data)
+{
+	CHECK(Owner);
+
+	std::shared_ptr<ObjectComponent_c> NewComponent = Factory(ObjectComponentArgs_s{ Owner->shared_from_this() });
+	Owner->AddComponentInternal(NewComponent);
 
 	if (Data)
 	{
@@ -85,12 +563,129 @@ Level_c* Space_c::LoadLevel(const Path_s& Path)
 	return NewLevel.get();
 }
 
+std::shared_ptr<LevelLoadHandle_c> Space_c::LoadLevelAsync(const Path_s& Path)
+{
+	std::shared_ptr<LevelLoadHandle_c> Load = std::make_shared<LevelLoadHandle_c>(std::make_shared<Level_c>(shared_from_this()), Path.ToWString());
+	LevelLoads.push_back(Load);
+
+	// The level is not visible to the main thread until the state leaves Loading, so the task has it to itself
+	GetLevelLoadPool().Push([Load]()
+	{
+		Level_c& Level = *Load->Level;
+		if (!Level.ParseSource(Load->Path))
+		{
+			Load->State.store(LevelLoadState_e::Failed, std::memory_order_release);
+			return;
+		}
+
+		std::vector<std::wstring> MeshAssetPaths;
+		Level.GatherSourceMeshAssets(MeshAssetPaths);
+		std::sort(MeshAssetPaths.begin(), MeshAssetPaths.end());
+		MeshAssetPaths.erase(std::unique(MeshAssetPaths.begin(), MeshAssetPaths.end()), MeshAssetPaths.end());
+
+		std::error_code SizeError;
+		const uintmax_t LevelSize = std::filesystem::file_size(Load->Path, SizeError);
+		Load->BytesRead.fetch_add(SizeError ? 0 : LevelSize, std::memory_order_relaxed);
+
+		Load->ObjectCount.store(Level.GetSourceObjectCount(), std::memory_order_relaxed);
+		Load->AssetCount.store(static_cast<uint32_t>(MeshAssetPaths.size()), std::memory_order_relaxed);
+		Load->Parsed.store(true, std::memory_order_release);
+
+		// Leaves only the GPU resource creation for the main thread once the objects asking for them spawn
+		std::vector<uint8_t> Held(MeshAssetPaths.size(), 0);
+		GetLevelLoadPool().ParallelFor(static_cast<uint32_t>(MeshAssetPaths.size()), 1, [&Load, &MeshAssetPaths, &Held](uint32_t Begin, uint32_t End)
+		{
+			for (uint32_t AssetIt = Begin; AssetIt < End; AssetIt++)
+			{
+				if (!Load->Cancelled.load(std::memory_order_relaxed))
+				{
+					uint64_t MeshSize = 0;
+					Held[AssetIt] = MeshManager::PrefetchMesh(MeshAssetPaths[AssetIt], &MeshSize) ? 1 : 0;
+					Load->BytesRead.fetch_add(MeshSize, std::memory_order_relaxed);
+				}
+
+				Load->AssetsRead.fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+
+		for (size_t AssetIt = 0; AssetIt < MeshAssetPaths.size(); AssetIt++)
+		{
+			if (Held[AssetIt])
+			{
+				Load->PrefetchedMeshAssets.push_back(std::move(MeshAssetPaths[AssetIt]));
+			}
+		}
+
+		Load->State.store(LevelLoadState_e::Finalizing, std::memory_order_release);
+	});
+
+	return Load;
+}
+
+void Space_c::UpdateLevelLoads()
+{
+	if (LevelLoads.empty())
+		return;
+
+	const std::chrono::steady_clock::time_point Deadline = std::chrono::steady_clock::now()
+		+ std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float, std::milli>(LevelLoadBudgetMs));
+
+	// Index rather than iterate, Load() may start further loads
+	for (size_t LoadIt = 0; LoadIt < LevelLoads.size();)
+	{
+		const std::shared_ptr<LevelLoadHandle_c> Load = LevelLoads[LoadIt];
+
+		const LevelLoadState_e State = Load->GetState();
+		if (State == LevelLoadState_e::Loading)
+		{
+			LoadIt++;
+			continue;
+		}
+
+		if (State == LevelLoadState_e::Finalizing)
+		{
+			if (std::chrono::steady_clock::now() >= Deadline)
+				break;
+
+			Level_c& Level = *Load->Level;
+			if (Load->Cancelled.load(std::memory_order_relaxed) && Level.GetSpawnedSourceObjectCount() == 0)
+			{
+				MeshManager::ReleasePrefetchedMeshes(Load->PrefetchedMeshAssets);
+				Load->State.store(LevelLoadState_e::Cancelled, std::memory_order_release);
+				LOGINFO("[Space] Cancelled loading level %S", Load->Path.c_str());
+
+				LevelLoads.erase(LevelLoads.begin() + LoadIt);
+				continue;
+			}
+
+			const bool Spawned = Level.SpawnSourceObjects(Deadline);
+			Load->ObjectsSpawned.store(Level.GetSpawnedSourceObjectCount(), std::memory_order_relaxed);
+
+			if (!Spawned)
+				break;
+
+			Levels.push_back(Load->Level);
+			Level.Load();
+
+			// Every object that wanted a prefetched mesh has requested it by now, drop the rest
+			MeshManager::ReleasePrefetchedMeshes(Load->PrefetchedMeshAssets);
+			Load->PrefetchedMeshAssets.clear();
+
+			Load->State.store(LevelLoadState_e::Loaded, std::memory_order_release);
+			LOGINFO("[Space] Finished loading level %S", Load->Path.c_str());
+		}
+
+		LevelLoads.erase(LevelLoads.begin() + LoadIt);
+	}
+}
+
 void Space_c::UnloadLevel(Level_c* InLevel)
 {
 	if (InLevel)
 	{
 		InLevel->Unload();
 		std::erase(Levels, InLevel->shared_from_this());
+		PruneMeshesAfterFlush = true;
 	}	
 }
 
@@ -0,0 +1,336 @@
+#include "Space/SpatialIndex.h"
+
+#include <Shared/Logging/Logging.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+// Fat bounds grow by a fixed margin plus a fraction of the proxy's size on each axis
+constexpr float FatMargin = 0.1f;
+constexpr float FatMarginScale = 0.25f;
+
+AABB Union(const AABB& A, const AABB& B) noexcept
+{
+	AABB Result = A;
+	Result.Grow(B);
+	return Result;
+}
+
+float SurfaceArea(const AABB& Box) noexcept
+{
+	const float3 Size = Box.maxs - Box.mins;
+	return 2.0f * (Size.x * Size.y + Size.y * Size.z + Size.z * Size.x);
+}
+
+bool Contains(const AABB& Outer, const AABB& Inner) noexcept
+{
+	return Outer.mins.x <= Inner.mins.x && Outer.mins.y <= Inner.mins.y && Outer.mins.z <= Inner.mins.z
+		&& Outer.maxs.x >= Inner.maxs.x && Outer.maxs.y >= Inner.maxs.y && Outer.maxs.z >= Inner.maxs.z;
+}
+
+AABB Fatten(const AABB& Bounds) noexcept
+{
+	const float3 Margin = (Bounds.maxs - Bounds.mins) * FatMarginScale + float3(FatMargin);
+	return AABB(Bounds.mins - Margin, Bounds.maxs + Margin);
+}
+
+}
+
+SpatialProxyId_t SpatialIndex_c::CreateProxy(const AABB& Bounds, uint32_t UserData)
+{
+	const uint32_t Leaf = AllocateNode();
+	Node_s& Node = Nodes[Leaf];
+	Node.Bounds = Bounds;
+	Node.FatBounds = Fatten(Bounds);
+	Node.UserData = UserData;
+	Node.Height = 0;
+
+	InsertLeaf(Leaf);
+	ProxyCount++;
+
+	return Leaf;
+}
+
+void SpatialIndex_c::DestroyProxy(SpatialProxyId_t Proxy)
+{
+	if (!ENSUREMSG(Proxy < Nodes.size() && Nodes[Proxy].IsLeaf() && Nodes[Proxy].Height == 0, "[SpatialIndex] Destroying an invalid proxy %u", Proxy))
+		return;
+
+	RemoveLeaf(Proxy);
+	FreeNode(Proxy);
+	ProxyCount--;
+}
+
+bool SpatialIndex_c::MoveProxy(SpatialProxyId_t Proxy, const AABB& Bounds)
+{
+	Node_s& Node = Nodes[Proxy];
+	Node.Bounds = Bounds;
+
+	if (Contains(Node.FatBounds, Bounds))
+		return false;
+
+	RemoveLeaf(Proxy);
+	Nodes[Proxy].FatBounds = Fatten(Bounds);
+	InsertLeaf(Proxy);
+
+	return true;
+}
+
+bool SpatialIndex_c::BoxOverlapsSphere(const AABB& Box, const float3& Center, float Radius) noexcept
+{
+	const float3 Closest = MinVector(MaxVector(Center, Box.mins), Box.maxs);
+	const float3 Delta = Closest - Center;
+	return Dot(Delta, Delta) <= Radius * Radius;
+}
+
+bool SpatialIndex_c::BoxOverlapsFrustum(const AABB& Box, const Frustum& View) noexcept
+{
+	for (const Plane& ViewPlane : View.Planes)
+	{
+		// The corner furthest along the plane normal, if that is behind the plane the whole box is
+		const float3 Corner = {
+			ViewPlane.Normal.x >= 0.0f ? Box.maxs.x : Box.mins.x,
+			ViewPlane.Normal.y >= 0.0f ? Box.maxs.y : Box.mins.y,
+			ViewPlane.Normal.z >= 0.0f ? Box.maxs.z : Box.mins.z,
+		};
+
+		if (ViewPlane.GetSignedDistance(Corner) < 0.0f)
+			return false;
+	}
+
+	return true;
+}
+
+bool SpatialIndex_c::RayHitsBox(const AABB& Box, const float3& Origin, const float3& InvDirection, float MaxDistance, float& OutDistance) noexcept
+{
+	float Enter = 0.0f;
+	float Exit = MaxDistance;
+
+	for (uint32_t Axis = 0; Axis < 3; Axis++)
+	{
+		// Parallel to the slab, 0 * inf would give NaN for an origin on one of its planes
+		if (std::isinf(InvDirection.v[Axis]))
+		{
+			if (Origin.v[Axis] < Box.mins.v[Axis] || Origin.v[Axis] > Box.maxs.v[Axis])
+				return false;
+
+			continue;
+		}
+
+		const float T0 = (Box.mins.v[Axis] - Origin.v[Axis]) * InvDirection.v[Axis];
+		const float T1 = (Box.maxs.v[Axis] - Origin.v[Axis]) * InvDirection.v[Axis];
+
+		Enter = std::max(Enter, std::min(T0, T1));
+		Exit = std::min(Exit, std::max(T0, T1));
+
+		if (Enter > Exit)
+			return false;
+	}
+
+	OutDistance = Enter;
+	return true;
+}
+
+uint32_t SpatialIndex_c::AllocateNode()
+{
+	uint32_t NodeId;
+	if (FreeList != InvalidNode)
+	{
+		NodeId = FreeList;
+		FreeList = Nodes[NodeId].Parent;
+	}
+	else
+	{
+		NodeId = static_cast<uint32_t>(Nodes.size());
+		Nodes.emplace_back();
+	}
+
+	Nodes[NodeId] = Node_s{};
+	return NodeId;
+}
+
+void SpatialIndex_c::FreeNode(uint32_t NodeId)
+{
+	Nodes[NodeId].Parent = FreeList;
+	Nodes[NodeId].Height = -1;
+	FreeList = NodeId;
+}
+
+void SpatialIndex_c::InsertLeaf(uint32_t Leaf)
+{
+	if (Root == InvalidNode)
+	{
+		Root = Leaf;
+		Nodes[Leaf].Parent = InvalidNode;
+		return;
+	}
+
+	// Walk down to the cheapest sibling by surface area, counting the growth of every ancestor on the way
+	const AABB LeafBounds = Nodes[Leaf].FatBounds;
+	uint32_t Sibling = Root;
+	while (!Nodes[Sibling].IsLeaf())
+	{
+		const Node_s& Node = Nodes[Sibling];
+
+		const float Area = SurfaceArea(Node.FatBounds);
+		const float CombinedArea = SurfaceArea(Union(Node.FatBounds, LeafBounds));
+
+		// Cost of pairing with this node, and of pushing the leaf further down
+		const float PairCost = 2.0f * CombinedArea;
+		const float InheritedCost = 2.0f * (CombinedArea - Area);
+
+		float ChildCosts[2];
+		for (uint32_t ChildIt = 0; ChildIt < 2; ChildIt++)
+		{
+			const Node_s& Child = Nodes[Node.Children[ChildIt]];
+			const float ChildCombinedArea = SurfaceArea(Union(Child.FatBounds, LeafBounds));
+			ChildCosts[ChildIt] = (Child.IsLeaf() ? ChildCombinedArea : ChildCombinedArea - SurfaceArea(Child.FatBounds)) + InheritedCost;
+		}
+
+		if (PairCost < ChildCosts[0] && PairCost < ChildCosts[1])
+			break;
+
+		Sibling = ChildCosts[0] < ChildCosts[1] ? Node.Children[0] : Node.Children[1];
+	}
+
+	const uint32_t OldParent = Nodes[Sibling].Parent;
+	const uint32_t NewParent = AllocateNode();
+
+	Node_s& ParentNode = Nodes[NewParent];
+	ParentNode.Parent = OldParent;
+	ParentNode.FatBounds = Union(LeafBounds, Nodes[Sibling].FatBounds);
+	ParentNode.Height = Nodes[Sibling].Height + 1;
+	ParentNode.Children[0] = Sibling;
+	ParentNode.Children[1] = Leaf;
+
+	if (OldParent != InvalidNode)
+	{
+		Node_s& OldParentNode = Nodes[OldParent];
+		OldParentNode.Children[OldParentNode.Children[0] == Sibling ? 0 : 1] = NewParent;
+	}
+	else
+	{
+		Root = NewParent;
+	}
+
+	Nodes[Sibling].Parent = NewParent;
+	Nodes[Leaf].Parent = NewParent;
+
+	RefitAncestors(NewParent);
+}
+
+void SpatialIndex_c::RemoveLeaf(uint32_t Leaf)
+{
+	if (Leaf == Root)
+	{
+		Root = InvalidNode;
+		return;
+	}
+
+	const uint32_t Parent = Nodes[Leaf].Parent;
+	const uint32_t GrandParent = Nodes[Parent].Parent;
+	const uint32_t Sibling = Nodes[Parent].Children[0] == Leaf ? Nodes[Parent].Children[1] : Nodes[Parent].Children[0];
+
+	FreeNode(Parent);
+
+	if (GrandParent != InvalidNode)
+	{
+		Node_s& GrandParentNode = Nodes[GrandParent];
+		GrandParentNode.Children[GrandParentNode.Children[0] == Parent ? 0 : 1] = Sibling;
+		Nodes[Sibling].Parent = GrandParent;
+
+		RefitAncestors(GrandParent);
+	}
+	else
+	{
+		Root = Sibling;
+		Nodes[Sibling].Parent = InvalidNode;
+	}
+}
+
+void SpatialIndex_c::RefitAncestors(uint32_t NodeId)
+{
+	while (NodeId != InvalidNode)
+	{
+		NodeId = Balance(NodeId);
+
+		Node_s& Node = Nodes[NodeId];
+		const Node_s& Child0 = Nodes[Node.Children[0]];
+		const Node_s& Child1 = Nodes[Node.Children[1]];
+
+		Node.Height = 1 + std::max(Child0.Height, Child1.Height);
+		Node.FatBounds = Union(Child0.FatBounds, Child1.FatBounds);
+
+		NodeId = Node.Parent;
+	}
+}
+
+uint32_t SpatialIndex_c::Balance(uint32_t IdA)
+{
+	Node_s& A = Nodes[IdA];
+	if (A.IsLeaf() || A.Height < 2)
+		return IdA;
+
+	const uint32_t IdB = A.Children[0];
+	const uint32_t IdC = A.Children[1];
+	Node_s& B = Nodes[IdB];
+	Node_s& C = Nodes[IdC];
+
+	const int32_t Imbalance = C.Height - B.Height;
+
+	// Promotes Up (one of A's children) to take A's place, A keeps Other and the lower of Up's children
+	auto Rotate = [this, IdA, &A](uint32_t IdUp, Node_s& Up, uint32_t UpSlot, Node_s& Other)
+	{
+		const uint32_t IdF = Up.Children[0];
+		const uint32_t IdG = Up.Children[1];
+		Node_s& F = Nodes[IdF];
+		Node_s& G = Nodes[IdG];
+
+		Up.Children[0] = IdA;
+		Up.Parent = A.Parent;
+		A.Parent = IdUp;
+
+		if (Up.Parent != InvalidNode)
+		{
+			Node_s& UpParent = Nodes[Up.Parent];
+			UpParent.Children[UpParent.Children[0] == IdA ? 0 : 1] = IdUp;
+		}
+		else
+		{
+			Root = IdUp;
+		}
+
+		const bool KeepF = F.Height > G.Height;
+		const uint32_t IdKept = KeepF ? IdF : IdG;
+		const uint32_t IdMoved = KeepF ? IdG : IdF;
+		Node_s& Kept = Nodes[IdKept];
+		Node_s& Moved = Nodes[IdMoved];
+
+		Up.Children[1] = IdKept;
+		A.Children[UpSlot] = IdMoved;
+		Moved.Parent = IdA;
+
+		A.FatBounds = Union(Other.FatBounds, Moved.FatBounds);
+		A.Height = 1 + std::max(Other.Height, Moved.Height);
+
+		Up.FatBounds = Union(A.FatBounds, Kept.FatBounds);
+		Up.Height = 1 + std::max(A.Height, Kept.Height);
+	};
+
+	if (Imbalance > 1)
+	{
+		Rotate(IdC, C, 1, B);
+		return IdC;
+	}
+
+	if (Imbalance < -1)
+	{
+		Rotate(IdB, B, 0, C);
+		return IdB;
+	}
+
+	return IdA;
+}
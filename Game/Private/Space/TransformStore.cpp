@@ -0,0 +1,212 @@
+#include "Space/TransformStore.h"
+
+#include "Utility/Transform.h"
+
+#include <Shared/Threading/TaskPool.h>
+
+#include <algorithm>
+
+namespace
+{
+
+// Dirty transforms per task when rebuilding local matrices
+constexpr uint32_t LocalMatrixBatchSize = 1024;
+
+}
+
+TransformId_t TransformStore_c::Allocate(const float3& Position, const float3& Rotation, float Scale)
+{
+	TransformId_t Id;
+	if (!FreeIds.empty())
+	{
+		Id = FreeIds.back();
+		FreeIds.pop_back();
+	}
+	else
+	{
+		Id = static_cast<TransformId_t>(Positions.size());
+
+		Positions.emplace_back();
+		Rotations.emplace_back();
+		Scales.emplace_back();
+		LocalMatrices.push_back(MakeMatrixIdentity());
+		WorldMatrices.push_back(MakeMatrixIdentity());
+		Parents.push_back(InvalidTransformId);
+		FirstChildren.push_back(InvalidTransformId);
+		NextSiblings.push_back(InvalidTransformId);
+		Depths.push_back(0);
+		Dirty.push_back(0);
+		DirtyList.push_back(InvalidTransformId);
+	}
+
+	Positions[Id] = Position;
+	Rotations[Id] = Rotation;
+	Scales[Id] = Scale;
+
+	// A reused id may still be queued from before it was freed, in which case MarkDirty leaves it be
+	MarkDirty(Id, LocalDirty);
+
+	return Id;
+}
+
+void TransformStore_c::Free(TransformId_t Id)
+{
+	while (FirstChildren[Id] != InvalidTransformId)
+	{
+		SetParent(FirstChildren[Id], InvalidTransformId);
+	}
+
+	SetParent(Id, InvalidTransformId);
+
+	FreeIds.push_back(Id);
+}
+
+bool TransformStore_c::SetParent(TransformId_t Id, TransformId_t Parent)
+{
+	const TransformId_t OldParent = Parents[Id];
+	if (OldParent == Parent)
+		return true;
+
+	for (TransformId_t Ancestor = Parent; Ancestor != InvalidTransformId; Ancestor = Parents[Ancestor])
+	{
+		if (Ancestor == Id)
+			return false;
+	}
+
+	if (OldParent != InvalidTransformId)
+	{
+		TransformId_t* Link = &FirstChildren[OldParent];
+		while (*Link != Id)
+		{
+			Link = &NextSiblings[*Link];
+		}
+		*Link = NextSiblings[Id];
+		ParentedCount--;
+	}
+
+	Parents[Id] = Parent;
+	NextSiblings[Id] = InvalidTransformId;
+
+	if (Parent != InvalidTransformId)
+	{
+		NextSiblings[Id] = FirstChildren[Parent];
+		FirstChildren[Parent] = Id;
+		ParentedCount++;
+	}
+
+	SetDepth(Id, Parent == InvalidTransformId ? 0 : Depths[Parent] + 1);
+	MarkDirty(Id, WorldDirty);
+
+	return true;
+}
+
+void TransformStore_c::SetDepth(TransformId_t Id, uint16_t NewDepth)
+{
+	Depths[Id] = NewDepth;
+	for (TransformId_t Child = FirstChildren[Id]; Child != InvalidTransformId; Child = NextSiblings[Child])
+	{
+		SetDepth(Child, NewDepth + 1);
+	}
+}
+
+void TransformStore_c::UpdateLocalMatrices(uint32_t Begin, uint32_t End)
+{
+	// Flat loops over the angles so the trig vectorizes, then one pass to write the matrices out
+	for (uint32_t LocalIt = Begin; LocalIt < End; LocalIt++)
+	{
+		const float3& Rotation = Rotations[LocalIds[LocalIt]];
+		Angles[LocalIt * 3 + 0] = Rotation.x;
+		Angles[LocalIt * 3 + 1] = Rotation.y;
+		Angles[LocalIt * 3 + 2] = Rotation.z;
+	}
+
+	for (uint32_t AngleIt = Begin * 3; AngleIt < End * 3; AngleIt++)
+	{
+		Sines[AngleIt] = sinf(Angles[AngleIt]);
+		Cosines[AngleIt] = cosf(Angles[AngleIt]);
+	}
+
+	for (uint32_t LocalIt = Begin; LocalIt < End; LocalIt++)
+	{
+		const TransformId_t Id = LocalIds[LocalIt];
+		const float3 Sin = { Sines[LocalIt * 3 + 0], Sines[LocalIt * 3 + 1], Sines[LocalIt * 3 + 2] };
+		const float3 Cos = { Cosines[LocalIt * 3 + 0], Cosines[LocalIt * 3 + 1], Cosines[LocalIt * 3 + 2] };
+		ComposeTransformMatrix(LocalMatrices[Id], Positions[Id], Sin, Cos, Scales[Id]);
+	}
+}
+
+void TransformStore_c::UpdateWorldMatrices(std::vector<TransformId_t>* OutUpdated)
+{
+	uint32_t Count = DirtyCount.load(std::memory_order_acquire);
+	if (Count == 0)
+		return;
+
+	LocalIds.clear();
+	for (uint32_t DirtyIt = 0; DirtyIt < Count; DirtyIt++)
+	{
+		const TransformId_t Id = DirtyList[DirtyIt];
+		if (Dirty[Id] & LocalDirty)
+		{
+			LocalIds.push_back(Id);
+		}
+	}
+
+	const uint32_t LocalCount = static_cast<uint32_t>(LocalIds.size());
+	Angles.resize(LocalCount * 3);
+	Sines.resize(LocalCount * 3);
+	Cosines.resize(LocalCount * 3);
+
+	TaskPool_c::Get().ParallelFor(LocalCount, LocalMatrixBatchSize, [this](uint32_t Begin, uint32_t End)
+	{
+		UpdateLocalMatrices(Begin, End);
+	});
+
+	if (ParentedCount == 0)
+	{
+		for (uint32_t DirtyIt = 0; DirtyIt < Count; DirtyIt++)
+		{
+			const TransformId_t Id = DirtyList[DirtyIt];
+			WorldMatrices[Id] = LocalMatrices[Id];
+		}
+	}
+	else
+	{
+		// Queue every descendant of a dirty entry. The list grows as it is walked, so this reaches all depths.
+		for (uint32_t DirtyIt = 0; DirtyIt < Count; DirtyIt++)
+		{
+			for (TransformId_t Child = FirstChildren[DirtyList[DirtyIt]]; Child != InvalidTransformId; Child = NextSiblings[Child])
+			{
+				if (Dirty[Child] == 0)
+				{
+					Dirty[Child] = WorldDirty;
+					DirtyList[Count++] = Child;
+				}
+			}
+		}
+
+		// Parents before children
+		std::sort(DirtyList.begin(), DirtyList.begin() + Count, [this](TransformId_t A, TransformId_t B)
+		{
+			return Depths[A] != Depths[B] ? Depths[A] < Depths[B] : A < B;
+		});
+
+		for (uint32_t DirtyIt = 0; DirtyIt < Count; DirtyIt++)
+		{
+			const TransformId_t Id = DirtyList[DirtyIt];
+			const TransformId_t Parent = Parents[Id];
+			WorldMatrices[Id] = Parent == InvalidTransformId ? LocalMatrices[Id] : LocalMatrices[Id] * WorldMatrices[Parent];
+		}
+	}
+
+	for (uint32_t DirtyIt = 0; DirtyIt < Count; DirtyIt++)
+	{
+		Dirty[DirtyList[DirtyIt]] = 0;
+	}
+
+	if (OutUpdated)
+	{
+		OutUpdated->insert(OutUpdated->end(), DirtyList.begin(), DirtyList.begin() + Count);
+	}
+
+	DirtyCount.store(0, std::memory_order_relaxed);
+}
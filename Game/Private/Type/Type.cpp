@@ -0,0 +1,86 @@
+#include "Type/Type.h"
+
+#include <Shared/Logging/Logging.h>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+
+namespace TypeRegistry
+{
+
+struct TypeInfo_s
+{
+	const char* Name = nullptr;
+	TypeId_t Parent = InvalidTypeId;
+};
+
+struct TypeRegistryGlobals_s
+{
+	// Fixed size so readers never see a reallocation while a type registers on another thread
+	std::array<TypeInfo_s, MaxTypes + 1> Types = {};
+	std::atomic<uint32_t> TypeCount = 0;
+	std::mutex RegisterMutex;
+};
+
+static TypeRegistryGlobals_s& GetGlobals()
+{
+	static TypeRegistryGlobals_s Globals;
+	return Globals;
+}
+
+TypeId_t RegisterType(const char* Name, TypeId_t ParentType)
+{
+	TypeRegistryGlobals_s& G = GetGlobals();
+
+	std::lock_guard Lock(G.RegisterMutex);
+
+	const uint32_t Count = G.TypeCount.load(std::memory_order_relaxed);
+	if (!ENSUREMSG(Count < MaxTypes, "[TypeRegistry] Too many types registered, failed to register %s", Name))
+	{
+		return InvalidTypeId;
+	}
+
+	const TypeId_t NewType = Count + 1;
+	G.Types[NewType].Name = Name;
+	G.Types[NewType].Parent = ParentType;
+	G.TypeCount.store(NewType, std::memory_order_release);
+
+	return NewType;
+}
+
+uint32_t GetTypeCount() noexcept
+{
+	return GetGlobals().TypeCount.load(std::memory_order_acquire);
+}
+
+TypeId_t GetParentType(TypeId_t Type) noexcept
+{
+	return Type <= GetTypeCount() ? GetGlobals().Types[Type].Parent : InvalidTypeId;
+}
+
+const char* GetTypeName(TypeId_t Type) noexcept
+{
+	return Type != InvalidTypeId && Type <= GetTypeCount() ? GetGlobals().Types[Type].Name : "Invalid";
+}
+
+bool IsA(TypeId_t Type, TypeId_t BaseType) noexcept
+{
+	if (BaseType == InvalidTypeId)
+		return false;
+
+	const TypeRegistryGlobals_s& G = GetGlobals();
+	const uint32_t Count = GetTypeCount();
+
+	while (Type != InvalidTypeId && Type <= Count)
+	{
+		if (Type == BaseType)
+			return true;
+
+		Type = G.Types[Type].Parent;
+	}
+
+	return false;
+}
+
+}
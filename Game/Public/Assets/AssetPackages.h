@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+struct HPAssetBytes_s;
+struct Path_s;
+
+// Cooked packages the game reads from. Assets under the cooked directory are served out of its packages, or out of
+// the loose cooked files for those no package holds. Anything outside it is read from the loose file it names.
+namespace AssetPackages
+{
+
+// Mounts every .hp_pak directly in CookedDir, in place of any mounted before, so only once nothing loaded out of
+// them is in use. Main thread only. Returns how many were mounted.
+uint32_t Mount(const Path_s& CookedDir);
+
+// Path as the game names it, e.g. from Path_s. Safe from any thread.
+bool Load(const std::wstring& Path, HPAssetBytes_s& OutAsset);
+
+}
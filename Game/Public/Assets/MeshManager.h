@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 struct JsonValue_s;
 struct Mesh_s;
@@ -12,4 +15,19 @@ namespace MeshManager
 std::shared_ptr<Mesh_s> RequestMesh(const Path_s& Path);
 std::shared_ptr<Mesh_s> RequestMesh(const JsonValue_s& Data);
 
+// Reads the asset and its source file on the calling thread without creating GPU resources, so the first
+// RequestMesh for the path only has the GPU work left. Safe to call from any thread, RequestMesh is main thread only.
+// OutSize gets the bytes of mesh data read, zero if the path was already loaded or prefetched.
+// True if the caller now holds a prefetch of the path, to be passed to ReleasePrefetchedMeshes. False if it failed
+// or the mesh is already loaded.
+bool PrefetchMesh(const Path_s& Path, uint64_t* OutSize = nullptr);
+
+// Drops the cache entries of meshes that have been freed. Lookups drop the entries they find expired, this catches
+// those never looked up again, e.g. after a streamed cell unloads. Main thread only.
+void PruneExpiredMeshes();
+
+// Releases holds taken by PrefetchMesh, once whatever was going to request the meshes has or no longer will.
+// Prefetched data that was never requested is freed with its last hold.
+void ReleasePrefetchedMeshes(const std::vector<std::wstring>& Paths);
+
 }
\ No newline at end of file
@@ -1,8 +1,37 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
+#include <functional>
 
+// Low bits index the registry's per-entity arrays, high bits count how often the index was reused.
+// A handle kept past DestroyEntity stops being valid once its index is recycled with the next generation.
 enum class Entity_t : uint32_t { INVALID };
 
+namespace EntityIds
+{
+	static constexpr uint32_t IndexBits = 24;
+	static constexpr uint32_t IndexMask = (1u << IndexBits) - 1;
+	static constexpr uint32_t MaxGeneration = UINT32_MAX >> IndexBits;
+
+	// Index 0 is never handed out, so Entity_t::INVALID is never valid
+	static constexpr uint32_t MaxEntities = IndexMask;
+}
+
+constexpr uint32_t GetEntityIndex(Entity_t Entity) noexcept { return (uint32_t)Entity & EntityIds::IndexMask; }
+constexpr uint32_t GetEntityGeneration(Entity_t Entity) noexcept { return (uint32_t)Entity >> EntityIds::IndexBits; }
+constexpr Entity_t MakeEntity(uint32_t Index, uint32_t Generation) noexcept { return (Entity_t)((Generation << EntityIds::IndexBits) | Index); }
+
 Entity_t CreateEntity();
-void DestroyEntity(Entity_t Entity);
\ No newline at end of file
+
+// Removes all of the entity's fragments, after telling the destroy callbacks
+void DestroyEntity(Entity_t Entity);
+
+// False for destroyed entities, even once their index is in use again
+bool IsEntityValid(Entity_t Entity);
+
+// Called with each entity about to be destroyed, while its fragments are still readable
+using EntityDestroyedCallback_t = std::function<void(Entity_t)>;
+
+uint32_t AddEntityDestroyedCallback(EntityDestroyedCallback_t Callback);
+void RemoveEntityDestroyedCallback(uint32_t CallbackId);
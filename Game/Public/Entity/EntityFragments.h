@@ -2,7 +2,22 @@
 
 #include "Entity/Entity.h"
 
+#include <Shared/Threading/TaskPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
 #include <vector>
 
 struct EntityBitField_s
@@ -37,18 +52,83 @@ struct EntityBitField_s
 	{
 		const uint32_t PageIndex = Index / 64;
 		if (Pages.size() > PageIndex)
-		{			
+		{
 			const uint32_t BitIndex = Index % 64;
 			return (Pages[PageIndex] & (1ull << BitIndex)) != 0;
 		}
 		return false;
 	}
 
-	inline EntityBitField_s& operator&(const EntityBitField_s& Other)
+	// True if every bit set in Required is set here
+	bool ContainsAll(const EntityBitField_s& Required) const noexcept
+	{
+		for (size_t i = 0; i < Required.Pages.size(); i++)
+		{
+			const uint64_t Page = i < Pages.size() ? Pages[i] : 0;
+			if ((Page & Required.Pages[i]) != Required.Pages[i])
+				return false;
+		}
+		return true;
+	}
+
+	uint32_t CountSetBits() const noexcept
 	{
-		if (Other.Pages.size() > Pages.size())
+		uint32_t Count = 0;
+		for (uint64_t Page : Pages)
 		{
-			Pages.resize(Other.Pages.size(), 0);
+			Count += static_cast<uint32_t>(std::popcount(Page));
+		}
+		return Count;
+	}
+
+	// Calls Function(uint32_t Index) for each set bit in order, skipping from one to the next with count trailing zeros.
+	// Function returns false to stop.
+	template<typename Func>
+	void ForEachSetBit(Func&& Function) const
+	{
+		for (size_t PageIt = 0; PageIt < Pages.size(); PageIt++)
+		{
+			uint64_t Page = Pages[PageIt];
+			while (Page != 0)
+			{
+				const uint32_t Index = static_cast<uint32_t>(PageIt * 64 + std::countr_zero(Page));
+				if (!Function(Index))
+					return;
+
+				Page &= Page - 1;
+			}
+		}
+	}
+
+	// Sets this to the AND of all Fields, a page at a time. The inner loop is plain enough for the compiler to vectorize.
+	void AssignIntersection(const EntityBitField_s* const* Fields, size_t FieldCount)
+	{
+		Pages.clear();
+		if (FieldCount == 0)
+			return;
+
+		size_t PageCount = Fields[0]->Pages.size();
+		for (size_t FieldIt = 1; FieldIt < FieldCount; FieldIt++)
+		{
+			PageCount = std::min(PageCount, Fields[FieldIt]->Pages.size());
+		}
+
+		Pages.assign(Fields[0]->Pages.begin(), Fields[0]->Pages.begin() + PageCount);
+		for (size_t FieldIt = 1; FieldIt < FieldCount; FieldIt++)
+		{
+			const uint64_t* Other = Fields[FieldIt]->Pages.data();
+			for (size_t i = 0; i < PageCount; i++)
+			{
+				Pages[i] &= Other[i];
+			}
+		}
+	}
+
+	inline EntityBitField_s& operator&=(const EntityBitField_s& Other)
+	{
+		if (Other.Pages.size() < Pages.size())
+		{
+			Pages.resize(Other.Pages.size());
 		}
 
 		for (size_t i = 0; i < Pages.size(); i++)
@@ -60,149 +140,821 @@ struct EntityBitField_s
 	}
 };
 
-struct EntityFragmentEntry_s
+// Fragment types ////////////////////////////////////////////////////////////
+
+using FragmentTypeId_t = uint32_t;
+
+enum class FragmentStorage_e : uint8_t
 {
-	uint32_t FragmentIndex;
-	uint32_t FragmentID;
+	Table, // In the entity's archetype chunks, fastest to iterate
+	SparseSet, // In a dense array of its own, for fragments added and removed often. Set with a static Storage member.
 };
 
-using EntityFragmentEntries_t = std::vector<EntityFragmentEntry_s>;
+template<class FragmentType>
+constexpr FragmentStorage_e GetFragmentStorage() noexcept
+{
+	if constexpr (requires { FragmentType::Storage; })
+		return FragmentType::Storage;
+	else
+		return FragmentStorage_e::Table;
+}
 
-template<typename FragmentType>
-struct EntityFragmentRegister_s
+// Appends to a snapshot, see EntityRegistry_s::SaveSnapshot
+struct EntitySnapshotWriter_s
 {
-	std::vector<EntityFragmentEntries_t> EntityIDs; // Indexed by Entity_t
-	std::vector<FragmentType> Fragments;
-	std::vector<uint32_t> FreeList;
-	EntityBitField_s ActiveFragments;
+	std::vector<uint8_t>& Bytes;
 
-	enum class Fragment_t : uint32_t { INVALID };
+	void WriteBytes(const void* Source, size_t Size)
+	{
+		const uint8_t* SourceBytes = static_cast<const uint8_t*>(Source);
+		Bytes.insert(Bytes.end(), SourceBytes, SourceBytes + Size);
+	}
+
+	template<class T>
+	void Write(const T& Value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		WriteBytes(&Value, sizeof(T));
+	}
+};
+
+// Reads a snapshot. Reading past the end fails this and every later read, so a loader can finish its loop
+// and check Failed once.
+struct EntitySnapshotReader_s
+{
+	const uint8_t* Cursor = nullptr;
+	const uint8_t* End = nullptr;
+	bool Failed = false;
+
+	size_t GetRemaining() const noexcept { return static_cast<size_t>(End - Cursor); }
+
+	bool ReadBytes(void* Dest, size_t Size) noexcept
+	{
+		if (Failed || GetRemaining() < Size)
+		{
+			Failed = true;
+			return false;
+		}
+
+		std::memcpy(Dest, Cursor, Size);
+		Cursor += Size;
+		return true;
+	}
+
+	template<class T>
+	bool Read(T& Value) noexcept
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		return ReadBytes(&Value, sizeof(T));
+	}
+};
 
-	Fragment_t LastFragmentID = Fragment_t::INVALID;
+struct FragmentTypeInfo_s
+{
+	const char* Name = nullptr;
+	uint32_t Size = 0;
+	uint32_t Alignment = 0;
+	FragmentStorage_e Storage = FragmentStorage_e::Table;
+
+	// Move constructs Dest from Source, then destroys Source
+	void (*Relocate)(void* Dest, void* Source) = nullptr;
+	void (*Destroy)(void* Target) = nullptr;
+
+	// Snapshots copy trivially copyable fragments as raw bytes, a column or dense array at a time.
+	// Other fragments need SaveSnapshot and LoadSnapshot members, without them these are null and the type
+	// can not be snapshot.
+	bool TriviallyCopyable = false;
+	void (*SaveSnapshot)(const void* Source, EntitySnapshotWriter_s& Writer) = nullptr;
+
+	// Constructs Dest even when reading fails, so it can always be destroyed
+	bool (*LoadSnapshot)(void* Dest, EntitySnapshotReader_s& Reader) = nullptr;
+};
+
+namespace EntityFragments
+{
+	static constexpr uint32_t MaxFragmentTypes = 256;
 
-	static EntityFragmentRegister_s Get()
+	FragmentTypeId_t RegisterFragmentType(const FragmentTypeInfo_s& Info);
+
+	// Valid ids are [0, GetFragmentTypeCount())
+	uint32_t GetFragmentTypeCount() noexcept;
+	const FragmentTypeInfo_s& GetFragmentTypeInfo(FragmentTypeId_t Type) noexcept;
+
+	// Change versions are written by whichever task touches a fragment, possibly several at once for one chunk
+	inline void MarkVersion(uint32_t& Version, uint32_t Current) noexcept
 	{
-		static EntityFragmentRegister_s Instance;
-		return Instance;
+		std::atomic_ref<uint32_t>(Version).store(Current, std::memory_order_relaxed);
 	}
 
-	const EntityBitField_s& GetFragmentBitField() const noexcept
+	inline uint32_t LoadVersion(const uint32_t& Version) noexcept
 	{
-		return ActiveFragments;
+		return std::atomic_ref<uint32_t>(const_cast<uint32_t&>(Version)).load(std::memory_order_relaxed);
 	}
+}
 
-	Fragment_t CreateFragment(Entity_t Entity, const FragmentType& Fragment)
+namespace EntityFragments
+{
+	// Fragments that are not trivially copyable opt in to snapshots with
+	// void SaveSnapshot(EntitySnapshotWriter_s&) const and bool LoadSnapshot(EntitySnapshotReader_s&),
+	// which is called on a default constructed fragment
+	template<class FragmentType>
+	concept SnapshotHooks = requires(const FragmentType& Source, FragmentType& Dest, EntitySnapshotWriter_s& Writer, EntitySnapshotReader_s& Reader)
 	{
-		Fragment_t FragmentID = ++LastFragmentID;
+		Source.SaveSnapshot(Writer);
+		{ Dest.LoadSnapshot(Reader) } -> std::same_as<bool>;
+	};
 
-		if (EntityIDs.size() <= (uint32_t)Entity)
+	template<class FragmentType>
+	constexpr auto GetSaveSnapshotFunction() noexcept
+	{
+		void (*Function)(const void*, EntitySnapshotWriter_s&) = nullptr;
+		if constexpr (!std::is_trivially_copyable_v<FragmentType> && SnapshotHooks<FragmentType>)
 		{
-			EntityIDs.resize((uint32_t)Entity + 1);
+			Function = [](const void* Source, EntitySnapshotWriter_s& Writer)
+			{
+				static_cast<const FragmentType*>(Source)->SaveSnapshot(Writer);
+			};
 		}
+		return Function;
+	}
 
-		uint32_t FragmentIndex = 0;
-		if (FreeList.empty())
+	template<class FragmentType>
+	constexpr auto GetLoadSnapshotFunction() noexcept
+	{
+		bool (*Function)(void*, EntitySnapshotReader_s&) = nullptr;
+		if constexpr (!std::is_trivially_copyable_v<FragmentType> && SnapshotHooks<FragmentType>)
 		{
-			FragmentIndex = Fragment.size();
-			Fragments.resize(Fragments.size() + 1);
+			Function = [](void* Dest, EntitySnapshotReader_s& Reader)
+			{
+				return (new (Dest) FragmentType())->LoadSnapshot(Reader);
+			};
 		}
-		else
+		return Function;
+	}
+}
+
+// Ids are handed out on first use, so they are stable for the life of the process but not across runs.
+// A const fragment type shares the id of the type, const only marks read access in queries.
+template<class FragmentType>
+FragmentTypeId_t GetFragmentTypeId()
+{
+	if constexpr (std::is_const_v<FragmentType>)
+	{
+		return GetFragmentTypeId<std::remove_const_t<FragmentType>>();
+	}
+	else
+	{
+		static const FragmentTypeId_t Id = EntityFragments::RegisterFragmentType(FragmentTypeInfo_s{
+			typeid(FragmentType).name(),
+			sizeof(FragmentType),
+			alignof(FragmentType),
+			GetFragmentStorage<FragmentType>(),
+			[](void* Dest, void* Source)
+			{
+				FragmentType* SourceFragment = static_cast<FragmentType*>(Source);
+				new (Dest) FragmentType(std::move(*SourceFragment));
+				SourceFragment->~FragmentType();
+			},
+			[](void* Target)
+			{
+				static_cast<FragmentType*>(Target)->~FragmentType();
+			},
+			std::is_trivially_copyable_v<FragmentType>,
+			EntityFragments::GetSaveSnapshotFunction<FragmentType>(),
+			EntityFragments::GetLoadSnapshotFunction<FragmentType>() });
+
+		return Id;
+	}
+}
+
+template<class... FragmentTypes>
+EntityBitField_s MakeFragmentSignature()
+{
+	EntityBitField_s Signature;
+	(Signature.SetBit(GetFragmentTypeId<FragmentTypes>(), true), ...);
+	return Signature;
+}
+
+// Change versions ///////////////////////////////////////////////////////////
+
+// Passes the chunks, or blocks of sparse set fragments, where any of Types was written after SinceVersion.
+// Writes are stamped with the registry's ChangeVersion, so a pass that remembers the version it last ran at
+// can skip everything untouched since. The default filter passes everything.
+struct FragmentChangeFilter_s
+{
+	uint32_t SinceVersion = 0;
+	std::vector<FragmentTypeId_t> Types; // Empty for any of the query's fragments
+
+	bool IsActive() const noexcept { return SinceVersion != 0; }
+	bool Includes(FragmentTypeId_t Type) const noexcept { return Types.empty() || std::find(Types.begin(), Types.end(), Type) != Types.end(); }
+};
+
+template<class... ChangedTypes>
+FragmentChangeFilter_s ChangedSince(uint32_t Version)
+{
+	return FragmentChangeFilter_s{ Version, { GetFragmentTypeId<ChangedTypes>()... } };
+}
+
+// Archetypes ////////////////////////////////////////////////////////////////
+
+// Fixed size block holding up to the archetype's ChunkCapacity entities, one array per fragment type
+// followed by the next, so a query walks each fragment type linearly.
+struct EntityChunk_s
+{
+	uint8_t* Data = nullptr;
+	uint32_t Count = 0;
+
+	// Per column, the registry's ChangeVersion when any fragment in it was last written, moved in or added
+	std::vector<uint32_t> ColumnVersions;
+};
+
+// Every entity with exactly the same set of fragment types lives in the same archetype.
+// Rows are packed: removing an entity moves the last row into its place.
+struct EntityArchetype_s
+{
+	static constexpr uint32_t ChunkSize = 16 * 1024;
+	static constexpr uint32_t ChunkAlignment = 64;
+
+	EntityArchetype_s(std::vector<FragmentTypeId_t> InTypes);
+	~EntityArchetype_s();
+
+	EntityArchetype_s(const EntityArchetype_s&) = delete;
+	EntityArchetype_s& operator=(const EntityArchetype_s&) = delete;
+
+	// Destroys every fragment and frees the chunks. Locations pointing here are left to the registry.
+	void Clear();
+
+	// The entities, then each column's fragments for every row
+	void SaveSnapshot(EntitySnapshotWriter_s& Writer) const;
+
+	// Fills the empty archetype with Count rows. Columns gives, for each column in the snapshot, the column here,
+	// each must appear once. Every fragment is constructed even if reading fails.
+	void LoadSnapshot(EntitySnapshotReader_s& Reader, uint32_t Count, const std::vector<int32_t>& Columns, uint32_t Version);
+
+	// Sorted by id. Columns are in the same order.
+	std::vector<FragmentTypeId_t> Types;
+	EntityBitField_s Signature;
+
+	// From the start of a chunk, the entity column comes first at offset 0
+	std::vector<uint32_t> ColumnOffsets;
+
+	// Indexed by FragmentTypeId_t, -1 where the archetype lacks the type
+	std::vector<int32_t> ColumnsByType;
+
+	uint32_t ChunkCapacity = 0;
+	uint32_t ChunkBytes = ChunkSize; // Larger than ChunkSize only when a single row does not fit
+
+	// Every chunk but the last is full, so row R is at Chunks[R / ChunkCapacity]
+	std::vector<EntityChunk_s> Chunks;
+	uint32_t EntityCount = 0;
+
+	// Archetypes one fragment type away, found as entities move between them
+	std::vector<std::pair<FragmentTypeId_t, uint32_t>> AddEdges;
+	std::vector<std::pair<FragmentTypeId_t, uint32_t>> RemoveEdges;
+
+	int32_t GetColumn(FragmentTypeId_t Type) const noexcept { return Type < ColumnsByType.size() ? ColumnsByType[Type] : -1; }
+
+	Entity_t* GetEntities(const EntityChunk_s& Chunk) const noexcept { return reinterpret_cast<Entity_t*>(Chunk.Data); }
+	void* GetColumnData(const EntityChunk_s& Chunk, int32_t Column) const noexcept { return Chunk.Data + ColumnOffsets[Column]; }
+
+	void* GetFragment(uint32_t Row, int32_t Column) const noexcept
+	{
+		const EntityChunk_s& Chunk = Chunks[Row / ChunkCapacity];
+		return static_cast<uint8_t*>(GetColumnData(Chunk, Column)) + static_cast<size_t>(Row % ChunkCapacity) * EntityFragments::GetFragmentTypeInfo(Types[Column]).Size;
+	}
+
+	void MarkChunkChanged(EntityChunk_s& Chunk, uint32_t Version) noexcept
+	{
+		for (uint32_t& ColumnVersion : Chunk.ColumnVersions)
+		{
+			EntityFragments::MarkVersion(ColumnVersion, Version);
+		}
+	}
+
+	// QueryColumns are the columns of the query's fragment types, which an unspecific filter checks
+	bool PassesChangeFilter(const EntityChunk_s& Chunk, const FragmentChangeFilter_s& Filter, const int32_t* QueryColumns, size_t QueryColumnCount) const noexcept
+	{
+		if (!Filter.IsActive())
+			return true;
+
+		for (size_t ColumnIt = 0; ColumnIt < QueryColumnCount; ColumnIt++)
 		{
-			FragmentIndex = (Fragment_t)FreeList.back();
-			FreeList.pop_back();
+			const int32_t Column = QueryColumns[ColumnIt];
+			if (Filter.Includes(Types[Column]) && EntityFragments::LoadVersion(Chunk.ColumnVersions[Column]) > Filter.SinceVersion)
+				return true;
 		}
+		return false;
+	}
+};
+
+// Fragments of one SparseSet type, packed in a dense array with a parallel array of their entities.
+// A paged sparse array maps entities to dense indices, so add, remove and lookup are O(1) and never move the entity
+// between archetypes. Removal moves the last fragment into the hole, keeping iteration dense.
+struct EntitySparseSet_s
+{
+	static constexpr uint32_t SparsePageSize = 4096;
+	static constexpr uint32_t VersionBlockSize = 64;
+	static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+	explicit EntitySparseSet_s(FragmentTypeId_t InType);
+	~EntitySparseSet_s();
+
+	EntitySparseSet_s(const EntitySparseSet_s&) = delete;
+	EntitySparseSet_s& operator=(const EntitySparseSet_s&) = delete;
 
-		Fragments[FragmentIndex] = Fragment;
-		ActiveFragments.SetBit(FragmentIndex, true);
+	// Destroys every fragment, the dense storage is kept for reuse
+	void Clear();
 
-		EntityFragmentEntry_s NewEntry = { FragmentIndex, FragmentID };
+	// The dense entities, then the dense fragments
+	void SaveSnapshot(EntitySnapshotWriter_s& Writer) const;
 
-		EntityFragmentEntries_t& Entries = EntityIDs[(uint32_t)Entity];
-		Entries.push_back(NewEntry);
+	// Fills the empty set with Count fragments. Every fragment is constructed even if reading fails.
+	void LoadSnapshot(EntitySnapshotReader_s& Reader, uint32_t Count, uint32_t Version);
 
-		return FragmentID;
+	uint32_t GetCount() const noexcept { return static_cast<uint32_t>(Entities.size()); }
+
+	// Dense index of the entity's fragment, or InvalidIndex. Stale handles find nothing.
+	uint32_t Find(Entity_t Entity) const noexcept
+	{
+		const uint32_t Index = GetEntityIndex(Entity);
+		const uint32_t Page = Index / SparsePageSize;
+		if (Page >= SparsePages.size() || !SparsePages[Page])
+			return InvalidIndex;
+
+		const uint32_t DenseIndex = SparsePages[Page][Index % SparsePageSize];
+		return DenseIndex != InvalidIndex && Entities[DenseIndex] == Entity ? DenseIndex : InvalidIndex;
 	}
 
-	void DestroyFragment(Entity_t Entity, Fragment_t FragmentID)
+	void* GetFragment(uint32_t DenseIndex) const noexcept { return Fragments + static_cast<size_t>(DenseIndex) * Info.Size; }
+
+	// Unconstructed storage at the end of the dense array, the entity must not have the fragment yet
+	void* Insert(Entity_t Entity, uint32_t Version);
+
+	// Destroys the fragment, if the entity has one
+	void Remove(Entity_t Entity, uint32_t Version);
+
+	void MarkChanged(uint32_t DenseIndex, uint32_t Version) noexcept { EntityFragments::MarkVersion(BlockVersions[DenseIndex / VersionBlockSize], Version); }
+	uint32_t GetVersion(uint32_t DenseIndex) const noexcept { return EntityFragments::LoadVersion(BlockVersions[DenseIndex / VersionBlockSize]); }
+
+	FragmentTypeId_t Type;
+	FragmentTypeInfo_s Info;
+
+	std::vector<Entity_t> Entities; // Dense
+	uint8_t* Fragments = nullptr; // Dense, parallel to Entities
+	uint32_t Capacity = 0;
+
+	// Per VersionBlockSize dense fragments, the registry's ChangeVersion when any of them was last written
+	std::vector<uint32_t> BlockVersions;
+
+	// Indexed by entity index / SparsePageSize, pages are allocated on first use
+	std::vector<std::unique_ptr<uint32_t[]>> SparsePages;
+
+private:
+
+	uint32_t& GetSparseEntry(Entity_t Entity);
+};
+
+// Entities that have every fragment in Types, as a bit per entity index. Built by ANDing the registry's presence
+// bitfields a page at a time, then kept up to date entity by entity as fragments are added and removed.
+struct EntityQueryCache_s
+{
+	std::vector<FragmentTypeId_t> Types; // Sorted
+	EntityBitField_s Matches;
+};
+
+struct EntityLocation_s
+{
+	static constexpr uint32_t FreeArchetype = UINT32_MAX;
+
+	uint32_t Archetype = FreeArchetype;
+	uint32_t Row = 0;
+};
+
+struct EntityRegistry_s
+{
+	EntityRegistry_s();
+	~EntityRegistry_s();
+
+	EntityRegistry_s(const EntityRegistry_s&) = delete;
+	EntityRegistry_s& operator=(const EntityRegistry_s&) = delete;
+
+	Entity_t CreateEntity();
+	void DestroyEntity(Entity_t Entity);
+
+	bool IsValid(Entity_t Entity) const noexcept;
+
+	// Storage for the fragment, which is left unconstructed when OutConstruct is set, or null for an invalid entity.
+	// Moves the entity to another archetype when it did not have the fragment yet.
+	void* AddFragment(Entity_t Entity, FragmentTypeId_t Type, bool& OutConstruct);
+	void RemoveFragment(Entity_t Entity, FragmentTypeId_t Type);
+	void* GetFragment(Entity_t Entity, FragmentTypeId_t Type) const noexcept;
+
+	// GetFragment that stamps the fragment as changed
+	void* GetFragmentForWrite(Entity_t Entity, FragmentTypeId_t Type) noexcept;
+
+	// When the fragment was last written, as precisely as its chunk or block tracks it. 0 if the entity lacks it.
+	uint32_t GetFragmentVersion(Entity_t Entity, FragmentTypeId_t Type) const noexcept;
+
+	// Stamped on fragments as they are added, moved or accessed for writing. Advance it before each pass that
+	// should be told apart from the ones before, such as each system in a frame. Atomic since systems running
+	// at the same time advance it as they start.
+	std::atomic<uint32_t> ChangeVersion = 1;
+
+	uint32_t AdvanceChangeVersion() noexcept { return ++ChangeVersion; }
+
+	// [0] is the archetype of entities without fragments. Archetypes are never removed.
+	std::vector<std::unique_ptr<EntityArchetype_s>> Archetypes;
+	std::map<std::vector<FragmentTypeId_t>, uint32_t> ArchetypesByTypes;
+
+	// Indexed by FragmentTypeId_t, null for table fragments and sparse set fragments never added
+	std::vector<std::unique_ptr<EntitySparseSet_s>> SparseSets;
+
+	const EntitySparseSet_s* FindSparseSet(FragmentTypeId_t Type) const noexcept { return Type < SparseSets.size() ? SparseSets[Type].get() : nullptr; }
+	EntitySparseSet_s* FindSparseSet(FragmentTypeId_t Type) noexcept { return Type < SparseSets.size() ? SparseSets[Type].get() : nullptr; }
+
+	// Indexed by entity index. Destroyed indices are reused oldest first, which spreads generation wrap around.
+	std::vector<EntityLocation_s> Locations;
+	std::vector<uint8_t> Generations;
+	std::deque<uint32_t> FreeIndices;
+
+	uint32_t GetAliveCount() const noexcept { return static_cast<uint32_t>(Locations.size() - 1 - FreeIndices.size()); }
+
+	uint32_t AddDestroyedCallback(EntityDestroyedCallback_t Callback);
+	void RemoveDestroyedCallback(uint32_t CallbackId);
+
+	// Indexed by FragmentTypeId_t, a bit per entity index that has the fragment
+	std::vector<EntityBitField_s> FragmentPresence;
+
+	// Created on first use and kept for the life of the registry
+	EntityQueryCache_s& GetQueryCache(std::vector<FragmentTypeId_t> Types);
+
+	// Appends every entity with its fragments and the id allocator state to Out, fragment stores as raw blocks.
+	// Fails, leaving Out as it was, when a fragment type is neither trivially copyable nor has snapshot hooks.
+	// Fragment types are matched by name on restore, so a snapshot can be restored by a later run of the same build.
+	bool SaveSnapshot(std::vector<uint8_t>& Out) const;
+
+	// Replaces every entity and fragment with the snapshot's, without calling destroy callbacks. Handles saved with
+	// the snapshot are valid again, query caches stay valid. Every restored fragment is stamped with a new
+	// ChangeVersion so change filters see it. On failure the registry is left empty, or untouched if the snapshot's
+	// fragment types do not match this build.
+	bool RestoreSnapshot(const uint8_t* Data, size_t Size);
+
+private:
+
+	// Destroys every entity without calling destroy callbacks, keeping archetypes, sparse sets and query caches
+	void Clear();
+
+	// Recomputes presence and the query caches from the archetypes and sparse sets
+	void RebuildPresence();
+
+	// Updates the presence bit and the cached queries that involve the type
+	void SetPresence(uint32_t Index, FragmentTypeId_t Type, bool Present);
+
+	EntitySparseSet_s& GetOrCreateSparseSet(FragmentTypeId_t Type);
+
+	const EntityLocation_s& GetLocation(Entity_t Entity) const noexcept { return Locations[GetEntityIndex(Entity)]; }
+	EntityLocation_s& GetLocation(Entity_t Entity) noexcept { return Locations[GetEntityIndex(Entity)]; }
+
+	uint32_t FindOrCreateArchetype(const std::vector<FragmentTypeId_t>& Types);
+	uint32_t GetArchetypeWith(uint32_t From, FragmentTypeId_t Type);
+	uint32_t GetArchetypeWithout(uint32_t From, FragmentTypeId_t Type);
+
+	uint32_t AllocateRow(EntityArchetype_s& Archetype, Entity_t Entity);
+
+	// Fills the row's hole with the last row. The row's fragments must already be moved out or destroyed.
+	void ReleaseRow(EntityArchetype_s& Archetype, uint32_t Row);
+
+	// Relocates the fragments the two archetypes share and destroys the rest, new fragments are left unconstructed
+	void MoveEntity(Entity_t Entity, uint32_t ToArchetype);
+
+	std::vector<std::pair<uint32_t, EntityDestroyedCallback_t>> DestroyedCallbacks;
+	uint32_t NextCallbackId = 1;
+
+	std::map<std::vector<FragmentTypeId_t>, std::unique_ptr<EntityQueryCache_s>> QueryCaches;
+	std::vector<std::vector<EntityQueryCache_s*>> QueriesByType; // Indexed by FragmentTypeId_t
+};
+
+EntityRegistry_s& GetEntityRegistry();
+
+// Fragments /////////////////////////////////////////////////////////////////
+
+// Adds the fragment, or overwrites it if the entity already has one
+template<class FragmentType>
+FragmentType* AddFragment(Entity_t Entity, FragmentType Fragment = FragmentType())
+{
+	bool Construct = false;
+	void* Storage = GetEntityRegistry().AddFragment(Entity, GetFragmentTypeId<FragmentType>(), Construct);
+	if (!Storage)
+		return nullptr;
+
+	if (Construct)
+		return new (Storage) FragmentType(std::move(Fragment));
+
+	FragmentType* Existing = static_cast<FragmentType*>(Storage);
+	*Existing = std::move(Fragment);
+	return Existing;
+}
+
+template<class FragmentType>
+void RemoveFragment(Entity_t Entity)
+{
+	GetEntityRegistry().RemoveFragment(Entity, GetFragmentTypeId<FragmentType>());
+}
+
+// Null if the entity lacks the fragment. Only valid until fragments are next added to or removed from any entity.
+// Unless FragmentType is const the fragment is stamped as changed, see EntityRegistry_s::ChangeVersion.
+template<class FragmentType>
+FragmentType* GetFragment(Entity_t Entity)
+{
+	constexpr bool Write = !std::is_const_v<FragmentType>;
+	EntityRegistry_s& Registry = GetEntityRegistry();
+
+	if constexpr (GetFragmentStorage<FragmentType>() == FragmentStorage_e::SparseSet)
 	{
-		if (EntityIDs.size() <= (uint32_t)Entity)
-			return;
+		// Skips the registry's dispatch, this is the lookup churning fragments do most
+		EntitySparseSet_s* Set = Registry.FindSparseSet(GetFragmentTypeId<FragmentType>());
+		const uint32_t DenseIndex = Set ? Set->Find(Entity) : EntitySparseSet_s::InvalidIndex;
+		if (DenseIndex == EntitySparseSet_s::InvalidIndex)
+			return nullptr;
 
-		EntityFragmentEntries_t& Entries = EntityIDs[(uint32_t)Entity];
-		for (size_t i = 0; i < Entries.size(); i++)
+		if constexpr (Write)
 		{
-			if (Entries[i].FragmentID == (uint32_t)FragmentID)
-			{
-				uint32_t FragmentIndex = Entries[i].FragmentIndex;
-				FreeList.push_back(FragmentIndex);
-				ActiveFragments.SetBit(FragmentIndex, false);
+			Set->MarkChanged(DenseIndex, Registry.ChangeVersion);
+		}
+		return static_cast<FragmentType*>(Set->GetFragment(DenseIndex));
+	}
+	else if constexpr (Write)
+	{
+		return static_cast<FragmentType*>(Registry.GetFragmentForWrite(Entity, GetFragmentTypeId<FragmentType>()));
+	}
+	else
+	{
+		return static_cast<FragmentType*>(Registry.GetFragment(Entity, GetFragmentTypeId<FragmentType>()));
+	}
+}
+
+template<class FragmentType>
+bool HasFragment(Entity_t Entity)
+{
+	return GetFragment<const FragmentType>(Entity) != nullptr;
+}
+
+// Queries ///////////////////////////////////////////////////////////////////
+//
+// Fragment types a query only reads should be given const, the rest are stamped as changed for each chunk or
+// block visited. An optional FragmentChangeFilter_s skips the chunks or blocks nothing has written to since.
 
-				std::swap(Entries[i], Entries.back());
-				Entries.pop_back();
+// The registry's cached query for FragmentTypes
+template<class... FragmentTypes>
+EntityQueryCache_s& GetFragmentQuery()
+{
+	static EntityQueryCache_s& Query = GetEntityRegistry().GetQueryCache({ GetFragmentTypeId<FragmentTypes>()... });
+	return Query;
+}
 
+namespace EntityFragments
+{
+	template<class... FragmentTypes>
+	void MarkChunkWritten(EntityChunk_s& Chunk, const int32_t* Columns, uint32_t Version) noexcept
+	{
+		uint32_t ColumnIt = 0;
+		((std::is_const_v<FragmentTypes> ? void() : MarkVersion(Chunk.ColumnVersions[Columns[ColumnIt]], Version), ColumnIt++), ...);
+	}
+
+	// Per entity check for queries that walk cached matches
+	template<class... FragmentTypes>
+	bool PassesChangeFilter(const EntityRegistry_s& Registry, Entity_t Entity, const FragmentChangeFilter_s& Filter) noexcept
+	{
+		if (!Filter.IsActive())
+			return true;
+
+		auto Changed = [&](FragmentTypeId_t Type)
+		{
+			return Filter.Includes(Type) && Registry.GetFragmentVersion(Entity, Type) > Filter.SinceVersion;
+		};
+		return (Changed(GetFragmentTypeId<FragmentTypes>()) || ...);
+	}
+}
+
+// Visits every chunk whose entities have all of FragmentTypes, with the chunk's arrays of them.
+// Function(uint32_t Count, const Entity_t* Entities, FragmentTypes*... Fragments) returns false to stop.
+// Fragments must not be added or removed until it returns.
+template<class... FragmentTypes, typename Func>
+void ForEachFragmentChunk(Func&& Function, const FragmentChangeFilter_s& Filter = {})
+{
+	static_assert(sizeof...(FragmentTypes) > 0, "Queries need at least one fragment type");
+	static_assert(((GetFragmentStorage<FragmentTypes>() == FragmentStorage_e::Table) && ...), "Sparse set fragments are not stored in chunks");
+
+	EntityRegistry_s& Registry = GetEntityRegistry();
+	const EntityBitField_s Required = MakeFragmentSignature<FragmentTypes...>();
+
+	for (const std::unique_ptr<EntityArchetype_s>& Archetype : Registry.Archetypes)
+	{
+		if (Archetype->EntityCount == 0 || !Archetype->Signature.ContainsAll(Required))
+			continue;
+
+		const int32_t Columns[] = { Archetype->GetColumn(GetFragmentTypeId<FragmentTypes>())... };
+
+		for (EntityChunk_s& Chunk : Archetype->Chunks)
+		{
+			if (!Archetype->PassesChangeFilter(Chunk, Filter, Columns, sizeof...(FragmentTypes)))
+				continue;
+
+			EntityFragments::MarkChunkWritten<FragmentTypes...>(Chunk, Columns, Registry.ChangeVersion);
+
+			const bool Continue = [&]<size_t... Indices>(std::index_sequence<Indices...>)
+			{
+				return Function(Chunk.Count, static_cast<const Entity_t*>(Archetype->GetEntities(Chunk)),
+					static_cast<FragmentTypes*>(Archetype->GetColumnData(Chunk, Columns[Indices]))...);
+			}(std::index_sequence_for<FragmentTypes...>());
+
+			if (!Continue)
 				return;
-			}
 		}
 	}
+}
+
+// Visits every entity that has all of FragmentTypes, chunk by chunk.
+// With sparse set fragments in the query it walks the query's cached matches instead, looking fragments up per entity.
+// Function(Entity_t Entity, FragmentTypes&... Fragments) returns false to stop.
+template<class... FragmentTypes, typename Func>
+void ForEachEntityWithFragments(Func&& Function, const FragmentChangeFilter_s& Filter = {})
+{
+	if constexpr (((GetFragmentStorage<FragmentTypes>() == FragmentStorage_e::Table) && ...))
+	{
+		ForEachFragmentChunk<FragmentTypes...>([&Function](uint32_t Count, const Entity_t* Entities, FragmentTypes*... Fragments)
+		{
+			for (uint32_t Row = 0; Row < Count; Row++)
+			{
+				if (!Function(Entities[Row], Fragments[Row]...))
+					return false;
+			}
+			return true;
+		}, Filter);
+	}
+	else if constexpr (sizeof...(FragmentTypes) == 1)
+	{
+		EntityRegistry_s& Registry = GetEntityRegistry();
+		const FragmentTypeId_t Type = GetFragmentTypeId<FragmentTypes...>();
+
+		EntitySparseSet_s* Set = Registry.FindSparseSet(Type);
+		if (!Set || (Filter.IsActive() && !Filter.Includes(Type)))
+			return;
+
+		for (uint32_t BlockBegin = 0; BlockBegin < Set->GetCount(); BlockBegin += EntitySparseSet_s::VersionBlockSize)
+		{
+			if (Filter.IsActive() && Set->GetVersion(BlockBegin) <= Filter.SinceVersion)
+				continue;
 
-	void NumFragments() const noexcept
+			if constexpr (!(std::is_const_v<FragmentTypes> && ...))
+			{
+				Set->MarkChanged(BlockBegin, Registry.ChangeVersion);
+			}
+
+			const uint32_t BlockEnd = std::min(BlockBegin + EntitySparseSet_s::VersionBlockSize, Set->GetCount());
+			for (uint32_t DenseIt = BlockBegin; DenseIt < BlockEnd; DenseIt++)
+			{
+				if (!Function(Set->Entities[DenseIt], *static_cast<FragmentTypes*>(Set->GetFragment(DenseIt))...))
+					return;
+			}
+		}
+	}
+	else
 	{
-		return Fragments.size();
+		const EntityRegistry_s& Registry = GetEntityRegistry();
+
+		GetFragmentQuery<FragmentTypes...>().Matches.ForEachSetBit([&](uint32_t Index)
+		{
+			const Entity_t Entity = MakeEntity(Index, Registry.Generations[Index]);
+			if (!EntityFragments::PassesChangeFilter<FragmentTypes...>(Registry, Entity, Filter))
+				return true;
+
+			return Function(Entity, *GetFragment<FragmentTypes>(Entity)...);
+		});
 	}
+}
+
+// Parallel queries ////////////////////////////////////////////////////////////
+
+// Matching chunks per task, enough to cover the cost of a task for small fragments
+static constexpr uint32_t ParallelQueryChunksPerTask = 4;
+
+// Matching entities per task when a query walks its cached matches, as 64 entity pages
+static constexpr uint32_t ParallelQueryPagesPerTask = 16;
+
+// ForEachFragmentChunk with the chunks spread across Pool. Each chunk goes to exactly one task, so writes to the
+// visited fragments never race, but nothing else in the registry may change until it returns.
+// Function(uint32_t ScratchIndex, uint32_t Count, const Entity_t* Entities, FragmentTypes*... Fragments), where
+// ScratchIndex is below Pool.GetMaxParallelism() and never shared by two chunks running at once.
+template<class... FragmentTypes, typename Func>
+void ParallelForEachFragmentChunk(Func&& Function, const FragmentChangeFilter_s& Filter = {}, TaskPool_c& Pool = TaskPool_c::Get())
+{
+	static_assert(sizeof...(FragmentTypes) > 0, "Queries need at least one fragment type");
+	static_assert(((GetFragmentStorage<FragmentTypes>() == FragmentStorage_e::Table) && ...), "Sparse set fragments are not stored in chunks");
+
+	struct ChunkRef_s
+	{
+		const EntityArchetype_s* Archetype;
+		const EntityChunk_s* Chunk;
+	};
+
+	EntityRegistry_s& Registry = GetEntityRegistry();
+	const EntityBitField_s Required = MakeFragmentSignature<FragmentTypes...>();
 
-	void FragmentValid(uint32_t Index) const noexcept
+	// Filtered and stamped here rather than in the tasks, which then only touch fragments
+	std::vector<ChunkRef_s> Chunks;
+	for (const std::unique_ptr<EntityArchetype_s>& Archetype : Registry.Archetypes)
 	{
-		return ActiveFragments.GetBit(Index);
+		if (Archetype->EntityCount == 0 || !Archetype->Signature.ContainsAll(Required))
+			continue;
+
+		const int32_t Columns[] = { Archetype->GetColumn(GetFragmentTypeId<FragmentTypes>())... };
+
+		for (EntityChunk_s& Chunk : Archetype->Chunks)
+		{
+			if (!Archetype->PassesChangeFilter(Chunk, Filter, Columns, sizeof...(FragmentTypes)))
+				continue;
+
+			EntityFragments::MarkChunkWritten<FragmentTypes...>(Chunk, Columns, Registry.ChangeVersion);
+			Chunks.push_back({ Archetype.get(), &Chunk });
+		}
 	}
 
-	template<typename F>
-	void ForEachFragment(F&& Func)
+	Pool.ParallelForWithScratch(static_cast<uint32_t>(Chunks.size()), ParallelQueryChunksPerTask, [&](uint32_t ScratchIndex, uint32_t Begin, uint32_t End)
+	{
+		for (uint32_t ChunkIt = Begin; ChunkIt < End; ChunkIt++)
+		{
+			const EntityArchetype_s* Archetype = Chunks[ChunkIt].Archetype;
+			const EntityChunk_s& Chunk = *Chunks[ChunkIt].Chunk;
+
+			Function(ScratchIndex, Chunk.Count, static_cast<const Entity_t*>(Archetype->GetEntities(Chunk)),
+				static_cast<FragmentTypes*>(Archetype->GetColumnData(Chunk, Archetype->GetColumn(GetFragmentTypeId<FragmentTypes>())))...);
+		}
+	});
+}
+
+// ForEachEntityWithFragments with the work spread across Pool, by chunk or by range of cached match pages.
+// Every entity is visited by exactly one task. Function(uint32_t ScratchIndex, Entity_t Entity, FragmentTypes&... Fragments).
+template<class... FragmentTypes, typename Func>
+void ParallelForEachEntityWithFragments(Func&& Function, const FragmentChangeFilter_s& Filter = {}, TaskPool_c& Pool = TaskPool_c::Get())
+{
+	if constexpr (((GetFragmentStorage<FragmentTypes>() == FragmentStorage_e::Table) && ...))
 	{
-		const size_t FragmentCount = Fragments.size();
-		size_t FragIt = 0;
-		uint64_t Page = 0;
-		size_t PageIt = 0;
-		size_t CurrentPageIt = 0;
-		for (; FragIt < FragmentCount; ++FragIt, ++CurrentPageIt)
+		ParallelForEachFragmentChunk<FragmentTypes...>([&Function](uint32_t ScratchIndex, uint32_t Count, const Entity_t* Entities, FragmentTypes*... Fragments)
 		{
-			if (CurrentPageIt >= 64)
+			for (uint32_t Row = 0; Row < Count; Row++)
 			{
-				PageIt++;
-				if (ActiveFragments.Pages.size() <= PageIt)
-				{
-					break; // Ensure?
-				}
-				Page = ActiveFragments.Pages[PageIt];
-				CurrentPageIt = 0;
+				Function(ScratchIndex, Entities[Row], Fragments[Row]...);
 			}
+		}, Filter, Pool);
+	}
+	else
+	{
+		const EntityRegistry_s& Registry = GetEntityRegistry();
+		const EntityBitField_s& Matches = GetFragmentQuery<FragmentTypes...>().Matches;
 
-			if ((Page & (1ull << CurrentPageIt)) != 0)
+		Pool.ParallelForWithScratch(static_cast<uint32_t>(Matches.Pages.size()), ParallelQueryPagesPerTask, [&](uint32_t ScratchIndex, uint32_t Begin, uint32_t End)
+		{
+			for (uint32_t PageIt = Begin; PageIt < End; PageIt++)
 			{
-				if(!Func(Fragments[FragIt]))
+				for (uint64_t Page = Matches.Pages[PageIt]; Page != 0; Page &= Page - 1)
 				{
-					break;
+					const uint32_t Index = PageIt * 64 + static_cast<uint32_t>(std::countr_zero(Page));
+					const Entity_t Entity = MakeEntity(Index, Registry.Generations[Index]);
+					if (EntityFragments::PassesChangeFilter<FragmentTypes...>(Registry, Entity, Filter))
+					{
+						Function(ScratchIndex, Entity, *GetFragment<FragmentTypes>(Entity)...);
+					}
 				}
 			}
-		}
+		});
 	}
-};
+}
 
 template<typename FragmentType>
 FragmentType* GetFirstFragment(Entity_t* OptEntity = nullptr)
 {
-	EntityFragmentRegister_s::Get().ForEachFragment([&](FragmentType& Fragment)
+	FragmentType* Found = nullptr;
+	ForEachEntityWithFragments<FragmentType>([&](Entity_t Entity, FragmentType& Fragment)
 	{
 		if (OptEntity)
 		{
-			// Find entity for fragment
+			*OptEntity = Entity;
 		}
+		Found = &Fragment;
 		return false; // Stop after first
 	});
+	return Found;
 }
 
 template<typename... FragmentTypes>
 Entity_t GetEntityWithFragments()
 {
-	EntityBitField_s RequiredFragmentsBitField;
-	((RequiredFragmentsBitField &= EntityFragmentRegister_s<FragmentTypes>::Get().GetBitField()), ...);
-}
\ No newline at end of file
+	Entity_t Found = Entity_t::INVALID;
+	ForEachEntityWithFragments<const FragmentTypes...>([&](Entity_t Entity, const FragmentTypes&...)
+	{
+		Found = Entity;
+		return false;
+	});
+	return Found;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Entity/EntityFragments.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class TaskPool_c;
+
+// Which fragments a system touches. Two systems conflict when either writes a type the other reads or writes,
+// conflicting systems never run at the same time.
+struct EntitySystemAccess_s
+{
+	std::vector<FragmentTypeId_t> Reads;
+	std::vector<FragmentTypeId_t> Writes;
+
+	// Creates or destroys entities, or adds or removes fragments. Runs alone on the thread calling Run.
+	bool Structural = false;
+
+	template<class... FragmentTypes>
+	EntitySystemAccess_s& Read()
+	{
+		(Reads.push_back(GetFragmentTypeId<FragmentTypes>()), ...);
+		return *this;
+	}
+
+	template<class... FragmentTypes>
+	EntitySystemAccess_s& Write()
+	{
+		(Writes.push_back(GetFragmentTypeId<FragmentTypes>()), ...);
+		return *this;
+	}
+
+	bool ConflictsWith(const EntitySystemAccess_s& Other) const noexcept;
+};
+
+struct EntitySystemContext_s
+{
+	float Delta = 0.0f;
+
+	// The registry's ChangeVersion when the system last started, 0 before its first run. Pass it to
+	// ChangedSince to only visit what was written since.
+	uint32_t LastRunVersion = 0;
+};
+
+using EntitySystemFunction_t = std::function<void(const EntitySystemContext_s&)>;
+using EntitySystemId_t = uint32_t;
+
+// Runs systems once per frame, as many at once as their declared access allows. Each Run builds a dependency
+// graph from the enabled systems: every system depends on the earlier added systems it conflicts with, so
+// conflicting systems always run in the order they were added and the results do not depend on timing.
+class EntitySystemScheduler_c
+{
+public:
+
+	explicit EntitySystemScheduler_c(TaskPool_c& InPool);
+
+	EntitySystemScheduler_c(const EntitySystemScheduler_c&) = delete;
+	EntitySystemScheduler_c& operator=(const EntitySystemScheduler_c&) = delete;
+
+	// 0 if Function is empty
+	EntitySystemId_t AddSystem(std::string Name, EntitySystemAccess_s Access, EntitySystemFunction_t Function);
+	void RemoveSystem(EntitySystemId_t Id);
+	void SetSystemEnabled(EntitySystemId_t Id, bool Enabled);
+
+	// Runs every enabled system, returning once all have finished. Not reentrant.
+	void Run(float Delta);
+
+	// A line per system of the last built graph: what it reads and writes, what it waits for, its depth in
+	// the graph and how long it took the last time it ran. Systems at the same depth may run at the same time.
+	std::string DumpSchedule() const;
+
+private:
+
+	struct System_s
+	{
+		EntitySystemId_t Id = 0;
+		std::string Name;
+		EntitySystemAccess_s Access;
+		EntitySystemFunction_t Function;
+		bool Enabled = true;
+
+		uint32_t LastRunVersion = 0;
+		float LastRunMs = 0.0f;
+	};
+
+	struct Node_s
+	{
+		uint32_t System = 0; // Index into Systems
+		std::vector<uint32_t> Dependencies; // Node indices, for the dump
+		std::vector<uint32_t> Dependents; // Node indices
+		uint32_t Depth = 0;
+		std::atomic<uint32_t> PendingDependencies = 0;
+	};
+
+	void BuildGraph();
+
+	// Queues the node for the thread in Run if it is structural, otherwise for the pool
+	void Launch(uint32_t NodeIndex);
+	void RunNode(uint32_t NodeIndex);
+
+	TaskPool_c& Pool;
+
+	std::vector<System_s> Systems; // In the order added
+	EntitySystemId_t NextSystemId = 1;
+
+	std::vector<Node_s> Nodes; // In the order added, so dependencies always come before their dependents
+	float FrameDelta = 0.0f;
+	std::atomic<uint32_t> CompletedNodes = 0;
+
+	// Structural nodes whose dependencies are done, run by the thread in Run
+	std::mutex StructuralMutex;
+	std::vector<uint32_t> ReadyStructural;
+
+	// Other nodes whose dependencies are done, taken by pool tasks and by the thread in Run, which helps with
+	// these rather than with whatever else is queued on the pool. Shared with the pool tasks, which can start
+	// after Run has returned and must then find it empty rather than a destroyed scheduler.
+	struct ReadyNodes_s
+	{
+		std::mutex Mutex;
+		std::vector<uint32_t> Nodes;
+	};
+
+	std::shared_ptr<ReadyNodes_s> ReadyParallel = std::make_shared<ReadyNodes_s>();
+
+	// Takes a node from ReadyParallel, UINT32_MAX if there is none
+	static uint32_t TakeReadyNode(ReadyNodes_s& Ready);
+};
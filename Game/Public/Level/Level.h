@@ -3,30 +3,42 @@
 #include "Object/SpatialObject.h"
 #include "Space/Space.h"
 
+#include <chrono>
 #include <memory>
 #include <vector>
 
+struct LevelSource_s;
+
 class Level_c : public std::enable_shared_from_this<Level_c>
 {
 public:
 
-	Level_c(const std::shared_ptr<Space_c>& InOwningSpace)
-		: OwningSpace(InOwningSpace)
-	{}
-
-	virtual ~Level_c() = default;
+	Level_c(const std::shared_ptr<Space_c>& InOwningSpace);
+	virtual ~Level_c();
 
+	// Loads a .hp_lvl json level, or a .hp_clv cooked by HalfPipe's Level pipe
 	virtual void Deserialize(const std::wstring& LevelPath);
 	virtual void Load() {}
 	virtual void Unload();
 
+	// Deserialize split in steps for Space_c::LoadLevelAsync. ParseSource and GatherSourceMeshAssets touch nothing
+	// outside the level, so may run on a worker, SpawnSourceObjects runs on the main thread.
+	bool ParseSource(const std::wstring& LevelPath);
+	void GatherSourceMeshAssets(std::vector<std::wstring>& OutMeshAssetPaths);
+	uint32_t GetSourceObjectCount() const;
+	uint32_t GetSpawnedSourceObjectCount() const { return NextSourceObject; }
+
+	// Spawns parsed objects until all are spawned or Deadline passes, spawning at least one.
+	// Returns true once every object is spawned, when the parsed source is released.
+	bool SpawnSourceObjects(std::chrono::steady_clock::time_point Deadline);
+
 	template<class ObjectType>
 	std::shared_ptr<ObjectType> AddObjectToLevel()
 	{
 		if (Space_c* Space = GetSpace())
 		{
 			std::shared_ptr<ObjectType> Object = Space->CreateObject<ObjectType>();
-			Objects.push_back(Object);
+			Objects.push_back(Object->GetHandle());
 			return Object;
 		}
 
@@ -39,7 +51,7 @@ public:
 		if (Space_c* Space = GetSpace())
 		{
 			std::shared_ptr<SpatialObject_c> Object = Space->CreateObject<SpatialObject_c>();
-			Objects.push_back(Object);
+			Objects.push_back(Object->GetHandle());
 			Object->AddComponent<ComponentType>();
 			return Object;
 		}
@@ -47,7 +59,8 @@ public:
 		return nullptr;
 	}
 
-	std::vector<std::shared_ptr<Object_c>> Objects;
+	// Objects spawned by this level, destroyed with it on unload. Owned by the space.
+	std::vector<ObjectHandle_s> Objects;
 
 	std::weak_ptr<Space_c> OwningSpace;
 
@@ -55,4 +68,9 @@ public:
 	{
 		return OwningSpace.lock().get();
 	}
+
+private:
+
+	std::unique_ptr<LevelSource_s> Source;
+	uint32_t NextSourceObject = 0;
 };
\ No newline at end of file
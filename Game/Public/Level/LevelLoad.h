@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Level_c;
+
+enum class LevelLoadState_e : uint8_t
+{
+	Loading, // Parsing and reading assets on the level load threads
+	Finalizing, // Spawning objects on the main thread, a slice per frame
+	Loaded,
+	Failed,
+	Cancelled, // Before any object spawned, the level never joined its space
+};
+
+// Tracks a Space_c::LoadLevelAsync. Any thread may poll it.
+class LevelLoadHandle_c
+{
+public:
+
+	LevelLoadHandle_c(const std::shared_ptr<Level_c>& InLevel, const std::wstring& InPath)
+		: Level(InLevel)
+		, Path(InPath)
+	{}
+
+	LevelLoadState_e GetState() const noexcept { return State.load(std::memory_order_acquire); }
+
+	bool IsDone() const noexcept
+	{
+		const LevelLoadState_e CurrentState = GetState();
+		return CurrentState == LevelLoadState_e::Loaded || CurrentState == LevelLoadState_e::Failed || CurrentState == LevelLoadState_e::Cancelled;
+	}
+
+	// Stops the load if no object has spawned yet, dropping whatever it prefetched. A load already spawning
+	// finishes as usual and its level has to be unloaded. Main thread only.
+	void Cancel() noexcept { Cancelled.store(true, std::memory_order_relaxed); }
+
+	// 0 to 1, reaches 1 once loaded
+	float GetProgress() const noexcept
+	{
+		if (IsDone())
+			return 1.0f;
+
+		if (!Parsed.load(std::memory_order_acquire))
+			return 0.0f;
+
+		auto Fraction = [](uint32_t Done, uint32_t Total) { return Total == 0 ? 1.0f : std::min(static_cast<float>(Done) / Total, 1.0f); };
+
+		return ParseWeight
+			+ AssetWeight * Fraction(AssetsRead.load(std::memory_order_relaxed), AssetCount.load(std::memory_order_relaxed))
+			+ SpawnWeight * Fraction(ObjectsSpawned.load(std::memory_order_relaxed), ObjectCount.load(std::memory_order_relaxed));
+	}
+
+	// Null until loaded, the level only joins its space once every object is spawned
+	Level_c* GetLevel() const noexcept { return GetState() == LevelLoadState_e::Loaded ? Level.get() : nullptr; }
+
+	const std::wstring& GetPath() const noexcept { return Path; }
+
+	// The level file plus the mesh data read for it so far
+	uint64_t GetBytesRead() const noexcept { return BytesRead.load(std::memory_order_relaxed); }
+
+private:
+
+	friend class Space_c;
+
+	// Rough share of the load time each step takes
+	static constexpr float ParseWeight = 0.2f;
+	static constexpr float AssetWeight = 0.4f;
+	static constexpr float SpawnWeight = 0.4f;
+
+	std::shared_ptr<Level_c> Level;
+	std::wstring Path;
+
+	std::atomic<LevelLoadState_e> State = LevelLoadState_e::Loading;
+
+	std::atomic<bool> Parsed = false;
+	std::atomic<uint32_t> AssetCount = 0;
+	std::atomic<uint32_t> AssetsRead = 0;
+	std::atomic<uint32_t> ObjectCount = 0;
+	std::atomic<uint32_t> ObjectsSpawned = 0;
+	std::atomic<uint64_t> BytesRead = 0;
+
+	std::atomic<bool> Cancelled = false;
+
+	// Meshes this load holds prefetched until its objects have spawned, written by the load before it leaves Loading
+	std::vector<std::wstring> PrefetchedMeshAssets;
+};
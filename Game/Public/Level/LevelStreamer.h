@@ -0,0 +1,119 @@
+#pragma once
+
+#include <SurfMath.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Level_c;
+class LevelLoadHandle_c;
+class Space_c;
+struct Path_s;
+
+struct LevelStreamingStats_s
+{
+	uint32_t CellCount = 0;
+	uint32_t ResidentCells = 0;
+	uint32_t PendingLoads = 0;
+
+	// In range but held back because loading them would go over the memory budget
+	uint32_t DeferredCells = 0;
+
+	// Estimated from what each resident cell read when it loaded
+	uint64_t ResidentBytes = 0;
+
+	uint64_t TotalBytesStreamed = 0;
+	float BytesPerSecond = 0.0f; // Over roughly the last second
+};
+
+// Streams the cells of a world in and out around a view position. Each cell is a level of its own, loaded with
+// Space_c::LoadLevelAsync once the view comes within the load distance of its bounds and unloaded once it is
+// further than the unload distance. Nearest cells load first, and farther resident cells are evicted to keep
+// the estimated memory use under budget.
+//
+// Worlds are .hp_world json files, as written by HalfPipe's Level pipe with -cell:
+// { "Version": 1, "LoadDistance": 200, "UnloadDistance": 250,
+//   "Cells": [ { "Level": "Cell_0_0.hp_clv", "Min": "0, 0, 0", "Max": "100, 20, 100", "Size": 123456 } ] }
+// Cell levels are relative to the world file. Size is an optional first guess at the cell's memory use.
+class LevelStreamer_c
+{
+public:
+
+	explicit LevelStreamer_c(Space_c& InSpace)
+		: Space(InSpace)
+	{}
+
+	~LevelStreamer_c();
+
+	LevelStreamer_c(const LevelStreamer_c&) = delete;
+	LevelStreamer_c& operator=(const LevelStreamer_c&) = delete;
+
+	// Replaces the current world, unloading its resident cells
+	bool LoadWorld(const Path_s& WorldPath);
+	void UnloadWorld();
+
+	bool HasWorld() const noexcept { return !Cells.empty() || !AbandonedLoads.empty(); }
+
+	// Called by Space_c::Update with the primary camera's position
+	void Update(const float3& ViewPosition, float Delta);
+
+	// UnloadDistance is clamped to at least LoadDistance, the gap keeps cells near the edge from thrashing
+	void SetDistances(float InLoadDistance, float InUnloadDistance) noexcept;
+	void SetMemoryBudget(uint64_t Bytes) noexcept { MemoryBudget = Bytes; }
+	void SetMaxConcurrentLoads(uint32_t Count) noexcept { MaxConcurrentLoads = Count > 0 ? Count : 1; }
+
+	const LevelStreamingStats_s& GetStats() const noexcept { return Stats; }
+
+private:
+
+	struct Cell_s
+	{
+		std::wstring LevelPath;
+		AABB Bounds;
+
+		// What the cell read the last time it loaded, or the world file's guess before that
+		uint64_t SizeEstimate = 0;
+
+		float Distance = 0.0f;
+
+		std::shared_ptr<LevelLoadHandle_c> Load;
+		Level_c* Level = nullptr;
+
+		// Not retried once a load has failed
+		bool Failed = false;
+	};
+
+	void PollLoads();
+	void UnloadCell(Cell_s& Cell);
+
+	// Cancels the cell's pending load, if any, leaving it to be loaded again once back in range
+	void CancelLoad(Cell_s& Cell);
+
+	// Unloads resident cells farther than Distance, farthest first, until NeededBytes fit the budget
+	bool MakeRoom(uint64_t NeededBytes, float Distance);
+
+	Space_c& Space;
+
+	std::vector<Cell_s> Cells;
+
+	float LoadDistance = 200.0f;
+	float UnloadDistance = 250.0f;
+	uint64_t MemoryBudget = UINT64_MAX;
+	uint32_t MaxConcurrentLoads = 2;
+
+	uint64_t PendingBytes = 0; // Estimates of the cells being loaded
+
+	// Cancelled loads, of a previous world or of cells that left the unload distance, unloaded if they finish anyway
+	std::vector<std::shared_ptr<LevelLoadHandle_c>> AbandonedLoads;
+
+	LevelStreamingStats_s Stats;
+
+	// Bytes streamed since BandwidthWindowTime started counting
+	uint64_t BandwidthWindowBytes = 0;
+	float BandwidthWindowTime = 0.0f;
+
+	// Scratch for Update, cell indices nearest first
+	std::vector<uint32_t> CellOrder;
+};
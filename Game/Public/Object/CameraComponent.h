@@ -4,6 +4,8 @@
 
 class CameraComponent_c : public SpatialObjectComponent_c
 {
+	DECLARE_COMPONENT_TYPE(CameraComponent_c, SpatialObjectComponent_c)
+
 public:
 	using SpatialObjectComponent_c::SpatialObjectComponent_c;
 	virtual ~CameraComponent_c() = default;
@@ -17,6 +19,9 @@ public:
 	matrix CalculateProjectionMatrix(float AspectRatio) const;
 	matrix CalculateProjectionMatrix(u32 ScreenWidth, u32 ScreenHeight) const;
 
+	Frustum CalculateWorldFrustum(float AspectRatio) const;
+	Frustum CalculateWorldFrustum(u32 ScreenWidth, u32 ScreenHeight) const;
+
 	float NearZ = 0.1f;
 	float FarZ = 10'000.0f;
 	float Fov = 45.0f;
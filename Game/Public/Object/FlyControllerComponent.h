@@ -6,11 +6,14 @@
 
 class FlyControllerComponent_c : public ObjectComponent_c
 {
+	DECLARE_COMPONENT_TYPE(FlyControllerComponent_c, ObjectComponent_c)
+
 public:
 	using ObjectComponent_c::ObjectComponent_c;
 	virtual ~FlyControllerComponent_c() = default;
 
 	virtual void Update(float Delta) override;
+	virtual void DescribeTick(ComponentTickDesc_s& Desc) const override;
 
 protected:
 	float ViewPitch = 0.0f;
@@ -8,6 +8,8 @@
 
 class MeshComponent_c : public SpatialObjectComponent_c, public IRenderable_c
 {
+	DECLARE_COMPONENT_TYPE(MeshComponent_c, SpatialObjectComponent_c)
+
 public:
 
 	using SpatialObjectComponent_c::SpatialObjectComponent_c;
@@ -17,6 +19,10 @@ public:
 	virtual void Deserialize(const struct JsonValue_s& Data) override;
 	// End ObjectComponent_c interface
 
+	// Begin SpatialObjectComponent_c interface
+	virtual bool GetLocalBounds(AABB& OutBounds) const override;
+	// End SpatialObjectComponent_c interface
+
 	// Begin IRenderable_c interface
 	virtual void Render(struct SpatialRenderingCollector_s& Collector) override;
 	// End IRenderable_c interface
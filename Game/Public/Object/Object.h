@@ -1,7 +1,11 @@
 #pragma once
 
 #include "Object/ObjectComponent.h"
+#include "Object/ObjectHandle.h"
 
+#include <Shared/Memory/SlabPool.h>
+
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -25,22 +29,27 @@ public:
 	virtual void Deserialize(const JsonValue_s& Data);
 	virtual void OnCreate() {}
 
-	std::vector<std::shared_ptr<class ObjectComponent_c>> Components;
+	// Called by the owning space when the deferred destruction is applied, before the object leaves the space
+	virtual void PreDestroy();
 
-	void Update(float Delta);
+	std::vector<std::shared_ptr<class ObjectComponent_c>> Components;
 
 	template<class ComponentType>
 	ComponentType* AddComponent()
 	{
+		static_assert(HasOwnComponentType_v<ComponentType>, "ComponentType needs DECLARE_COMPONENT_TYPE");
 		const ObjectComponentArgs_s Args(shared_from_this());
-		std::shared_ptr<ComponentType> NewComponent = std::make_shared<ComponentType>(Args);
-		Components.push_back(NewComponent);
+		std::shared_ptr<ComponentType> NewComponent = std::allocate_shared<ComponentType>(SlabAllocator_t<ComponentType>(), Args);
+		AddComponentInternal(NewComponent);
 		NewComponent->OnCreate();
 		return NewComponent.get();
 	}
 
 	void AddComponentByName(const std::wstring& ClassName, const JsonValue_s* const Data = nullptr);
 
+	// Registers an already constructed component with this object and the owning space
+	void AddComponentInternal(const std::shared_ptr<ObjectComponent_c>& NewComponent);
+
 	template<typename Func>
 	void ForEachComponent(Func&& Function)
 	{
@@ -51,76 +60,57 @@ public:
 		}
 	}
 
-	template<typename Func, class ComponentType>
+	// Visits every component that is, or derives from, ComponentType
+	template<class ComponentType, typename Func>
 	void ForEachComponentType(Func&& Function)
 	{
-		for (const auto& CompPtr : Components)
+		static_assert(HasOwnComponentType_v<ComponentType>, "ComponentType needs DECLARE_COMPONENT_TYPE");
+		const TypeId_t Type = ComponentType::StaticTypeId();
+		for (auto It = FindComponentType(Type); It != ComponentTypeMap.end() && It->Type == Type; ++It)
 		{
-			if (auto CastedPtr = std::dynamic_pointer_cast<ComponentType>(CompPtr))
-			{
-				if (Function(CompPtr.get()) == false)
-					return;
-			}
+			if (Function(static_cast<ComponentType*>(It->Component)) == false)
+				return;
 		}
 	}
 
 	template<class ComponentType>
 	ComponentType* GetComponent()
 	{
-		ComponentType* Found = nullptr;
-		ForEachComponentType([&Found](ComponentType* Component)
-		{
-			Found = Component;
-			return false;
-		});
-
-		return Found;
+		static_assert(HasOwnComponentType_v<ComponentType>, "ComponentType needs DECLARE_COMPONENT_TYPE");
+		const TypeId_t Type = ComponentType::StaticTypeId();
+		auto It = FindComponentType(Type);
+		return It != ComponentTypeMap.end() && It->Type == Type ? static_cast<ComponentType*>(It->Component) : nullptr;
 	}
 
 	template<class ComponentType>
 	std::vector<ComponentType*> GetComponents()
 	{
 		std::vector<ComponentType*> Result;
-		for (const auto& CompPtr : Components)
-		{
-			if (auto CastedPtr = std::dynamic_pointer_cast<ComponentType>(CompPtr))
-			{
-				Result.push_back(CastedPtr.get());
-			}
-		}
+		GetComponents(Result);
 		return Result;
 	}
 
 	template<class ComponentType>
 	void GetComponents(std::vector<ComponentType*>& OutComponents)
 	{
-		for (const auto& CompPtr : Components)
+		ForEachComponentType<ComponentType>([&OutComponents](ComponentType* Component)
 		{
-			if (auto CastedPtr = std::dynamic_pointer_cast<ComponentType>(CompPtr))
-			{
-				OutComponents.push_back(CastedPtr.get());
-			}
-		}
-	}
-
-	void RemoveComponent(ObjectComponent_c* Component)
-	{
-		auto It = std::find_if(Components.begin(), Components.end(), [Component](const std::shared_ptr<ObjectComponent_c>& CompPtr)
-		{
-			return CompPtr.get() == Component;
+			OutComponents.push_back(Component);
+			return true;
 		});
-		if (It != Components.end())
-		{
-			(*It)->PreDestroy();
-			Components.erase(It);
-		}
 	}
 
+	void RemoveComponent(ObjectComponent_c* Component);
+
 	Space_c* GetSpace() const
 	{
 		return OwningSpace.lock().get();
 	}
 
+	ObjectHandle_s GetHandle() const noexcept { return Handle; }
+
+	bool IsPendingDestroy() const noexcept { return PendingDestroy; }
+
 	template<class T> 
 	std::shared_ptr<T> MakeShared()
 	{
@@ -129,5 +119,29 @@ public:
 
 private:
 
+	friend class Space_c;
+
 	std::weak_ptr<Space_c> OwningSpace;
+
+	// One entry per component per type in its hierarchy, sorted by type, so typed lookups are a search of
+	// a small contiguous array rather than a cast of every component
+	struct ComponentTypeEntry_s
+	{
+		TypeId_t Type;
+		ObjectComponent_c* Component;
+	};
+
+	std::vector<ComponentTypeEntry_s> ComponentTypeMap;
+
+	std::vector<ComponentTypeEntry_s>::iterator FindComponentType(TypeId_t Type)
+	{
+		return std::lower_bound(ComponentTypeMap.begin(), ComponentTypeMap.end(), Type, [](const ComponentTypeEntry_s& Entry, TypeId_t Value)
+		{
+			return Entry.Type < Value;
+		});
+	}
+
+	// Assigned by the owning space
+	ObjectHandle_s Handle = {};
+	bool PendingDestroy = false;
 };
\ No newline at end of file
@@ -1,9 +1,41 @@
 #pragma once
 
+#include "Type/Type.h"
+
+#include <cstdint>
 #include <memory>
+#include <type_traits>
+#include <vector>
 
 class Object_c;
 
+// Space_c ticks every phase to completion before starting the next
+enum class TickPhase_e : uint8_t
+{
+	PrePhysics,
+	Physics,
+	PostPhysics,
+	PreRender,
+	Count,
+};
+
+struct ComponentTickDesc_s
+{
+	bool Ticks = true;
+	TickPhase_e Phase = TickPhase_e::PrePhysics;
+
+	// Instances may tick on worker threads, concurrently with each other and with any other thread safe type whose
+	// declared access does not conflict. A thread safe tick may only touch its own state and the state it declares
+	// below, and must not create or destroy objects or components.
+	// Types that are not thread safe tick alone, in order, on the thread updating the space.
+	bool ThreadSafe = false;
+
+	// Type ids of the component types, or other shared state such as Transform_s, read or written by the tick.
+	// A type always implicitly writes itself.
+	std::vector<TypeId_t> Reads;
+	std::vector<TypeId_t> Writes;
+};
+
 struct ObjectComponentArgs_s
 {
 	ObjectComponentArgs_s(const std::shared_ptr<Object_c>& InOwner)
@@ -12,27 +44,63 @@ struct ObjectComponentArgs_s
 	std::weak_ptr<Object_c> Owner;
 };
 
+// Gives a component class its own type id, parented to ParentType so that queries for the parent also find it.
+// Every component class needs one, typed queries and AddComponent refuse to compile for a class without.
+#define DECLARE_COMPONENT_TYPE(ComponentType, ParentType) \
+public: \
+	using Super = ParentType; \
+	using DeclaredComponentType_t = ComponentType; \
+	static TypeId_t StaticTypeId() noexcept \
+	{ \
+		static const TypeId_t Id = TypeRegistry::RegisterType(#ComponentType, ParentType::StaticTypeId()); \
+		return Id; \
+	} \
+	virtual TypeId_t GetTypeId() const noexcept override { return StaticTypeId(); }
+
 class ObjectComponent_c : public std::enable_shared_from_this<ObjectComponent_c>
 {
 public:
 
+	using DeclaredComponentType_t = ObjectComponent_c;
+
 	ObjectComponent_c(const ObjectComponentArgs_s& Args);
 	virtual ~ObjectComponent_c() = default;
 
+	static TypeId_t StaticTypeId() noexcept
+	{
+		static const TypeId_t Id = TypeRegistry::RegisterType("ObjectComponent_c", InvalidTypeId);
+		return Id;
+	}
+
+	virtual TypeId_t GetTypeId() const noexcept { return StaticTypeId(); }
+
 	virtual void Deserialize(const struct JsonValue_s& Data) {}
 	virtual void Load() {}
 	virtual void OnCreate() {}
 	virtual void Update(float Delta) {}
 	virtual void PreDestroy() {}
 
+	// Describes how Update is scheduled. Queried once per component type, so must not depend on instance state.
+	virtual void DescribeTick(ComponentTickDesc_s& Desc) const {}
+
 	Object_c* GetOwner() const
 	{
 		return Owner.lock().get();
 	}
-	
+
 	class Space_c* GetSpace() const;
 
 private:
 
+	friend class Space_c;
+
 	std::weak_ptr<Object_c> Owner;
-};
\ No newline at end of file
+
+	// Index into the owning space's array for this component's type, assigned by the space
+	uint32_t SpaceComponentIndex = UINT32_MAX;
+};
+
+// A subclass without DECLARE_COMPONENT_TYPE would inherit its parent's type id, and typed lookups would cast
+// instances of the parent to it
+template<class ComponentType>
+inline constexpr bool HasOwnComponentType_v = std::is_same_v<typename ComponentType::DeclaredComponentType_t, ComponentType>;
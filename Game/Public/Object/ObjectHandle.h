@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+// Weak reference to an object owned by a Space_c. Index addresses a slot in the space's object table
+// and Generation is bumped every time that slot is freed, so a handle to a destroyed object resolves
+// to null rather than to whatever reused the slot.
+struct ObjectHandle_s
+{
+	static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+	uint32_t Index = InvalidIndex;
+	uint32_t Generation = 0;
+
+	constexpr bool IsValid() const noexcept { return Index != InvalidIndex; }
+
+	constexpr bool operator==(const ObjectHandle_s& Other) const noexcept = default;
+};
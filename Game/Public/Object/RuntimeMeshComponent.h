@@ -21,10 +21,16 @@ struct RuntimeMeshDesc_s
 
 class RuntimeMeshComponent_c : public SpatialObjectComponent_c, public IRenderable_c
 {
+	DECLARE_COMPONENT_TYPE(RuntimeMeshComponent_c, SpatialObjectComponent_c)
+
 public:
 	using SpatialObjectComponent_c::SpatialObjectComponent_c;
 	virtual ~RuntimeMeshComponent_c() = default;
 
+	// SpatialObjectComponent_c
+	virtual bool GetLocalBounds(AABB& OutBounds) const override;
+	// ~SpatialObjectComponent_c
+
 	// IRenderable_c
 	virtual void Render(struct SpatialRenderingCollector_s& Collector) override;
 	// ~IRenderable_c
@@ -3,8 +3,9 @@
 #include "Object/Object.h"
 #include "Object/SpatialObjectComponent.h"
 
-#include "Utility/Transform.h"
+#include "Space/TransformStore.h"
 
+#include <Shared/Logging/Logging.h>
 #include <SurfMath.h>
 
 class SpatialObject_c : public Object_c
@@ -15,16 +16,69 @@ public:
 
 	// Begin Object_c interface
 	virtual void Deserialize(const JsonValue_s& Data) override;
+	virtual void PreDestroy() override;
 	// End Object_c interface
 
-	const Transform_s& GetTransform() const { return Transform; }
+	TransformId_t GetTransformId() const noexcept { return TransformId; }
 
-	void SetPosition(const float3& NewPosition) { Transform.SetPosition(NewPosition); }
-	void SetRotation(const float3& NewRotation) { Transform.SetRotation(NewRotation); }
-	void SetScale(float NewScale) { Transform.SetScale(NewScale); }
+	// Local transform, relative to the parent. Setting it is cheap, the world matrix is rebuilt by the space once per frame.
+	// Once PreDestroy has released the transform, setters do nothing and getters return the identity transform.
+	void SetTransform(const float3& NewPosition, const float3& NewRotation, float NewScale) { if (EnsureTransform()) Transforms->Set(TransformId, NewPosition, NewRotation, NewScale); }
+	void SetPosition(const float3& NewPosition) { if (EnsureTransform()) Transforms->SetPosition(TransformId, NewPosition); }
+	void SetRotation(const float3& NewRotation) { if (EnsureTransform()) Transforms->SetRotation(TransformId, NewRotation); }
+	void SetScale(float NewScale) { if (EnsureTransform()) Transforms->SetScale(TransformId, NewScale); }
 
-	void Translate(const float3& Translation) { Transform.SetPosition(Transform.GetPosition() + Translation); }
+	void Translate(const float3& Translation) { SetPosition(GetPosition() + Translation); }
+
+	float3 GetPosition() const { return EnsureTransform() ? Transforms->GetPosition(TransformId) : float3(0.0f); }
+	float3 GetRotation() const { return EnsureTransform() ? Transforms->GetRotation(TransformId) : float3(0.0f); }
+	float GetScale() const { return EnsureTransform() ? Transforms->GetScale(TransformId) : 1.0f; }
+
+	// World space, as of the space's last transform update
+	const matrix& GetWorldMatrix() const { return EnsureTransform() ? Transforms->GetWorldMatrix(TransformId) : DestroyedWorldMatrix; }
+
+	float3 GetWorldPosition() const
+	{
+		const matrix& World = GetWorldMatrix();
+		return float3{ World.m[3][0], World.m[3][1], World.m[3][2] };
+	}
+
+	float3 GetForwardVector() const
+	{
+		const matrix& World = GetWorldMatrix();
+		return Normalize(float3{ World.m[2][0], World.m[2][1], World.m[2][2] });
+	}
+
+	float3 GetRightVector() const
+	{
+		const matrix& World = GetWorldMatrix();
+		return Normalize(float3{ World.m[0][0], World.m[0][1], World.m[0][2] });
+	}
+
+	float3 GetUpVector() const
+	{
+		return Cross(GetForwardVector(), GetRightVector());
+	}
+
+	// Union of the spatial components' local bounds, or a point at the origin if none of them have any
+	AABB CalculateLocalBounds();
+	AABB CalculateWorldBounds();
+
+	// Call when a component's local bounds change, so the space refits this object at its next transform update
+	void MarkBoundsDirty() { if (EnsureTransform()) Transforms->MarkWorldDirty(TransformId); }
+
+	// Passing null detaches. Fails if the new parent is this object or one of its children.
+	bool SetParent(SpatialObject_c* NewParent);
 
 protected:
-	Transform_s Transform;
-};
\ No newline at end of file
+
+	// False, and asserts, once the transform has been released
+	bool EnsureTransform() const { return ENSUREMSG(TransformId != InvalidTransformId, "[SpatialObject] Transform used after the object was destroyed"); }
+
+	TransformStore_c* Transforms = nullptr;
+	TransformId_t TransformId = InvalidTransformId;
+
+private:
+
+	static constexpr matrix DestroyedWorldMatrix = MakeMatrixIdentity();
+};
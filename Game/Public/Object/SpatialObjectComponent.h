@@ -9,6 +9,8 @@ class SpatialObject_c;
 // TODO - add child offsets
 class SpatialObjectComponent_c : public ObjectComponent_c
 {
+	DECLARE_COMPONENT_TYPE(SpatialObjectComponent_c, ObjectComponent_c)
+
 public:
 	SpatialObjectComponent_c(const ObjectComponentArgs_s& Args);
 	virtual ~SpatialObjectComponent_c() = default;
@@ -17,7 +19,11 @@ public:
 	virtual void Deserialize(const struct JsonValue_s& Data) override;
 	// End ObjectComponent_c interface
 
-	const struct Transform_s& GetTransform() const;
+	// Bounds of whatever the component places in the world, in the owner's local space. False if it has none.
+	virtual bool GetLocalBounds(AABB& OutBounds) const { return false; }
+
+	// The owner's world matrix, or identity if there is no spatial owner
+	const matrix& GetWorldMatrix() const;
 
 	SpatialObject_c* GetSpatialOwner() const
 	{
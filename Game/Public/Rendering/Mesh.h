@@ -2,6 +2,8 @@
 
 #include <Render/RenderTypes.h>
 
+#include <SurfMath.h>
+
 #include <cstdint>
 #include <vector>
 
@@ -24,6 +26,9 @@ struct Mesh_s
 
 	std::vector<Surface_s> Surfaces;
 
+	// Of the vertex positions, in mesh space
+	AABB Bounds = {};
+
 	rl::StructuredBufferPtr PositionBuffer = {};
 	rl::ShaderResourceViewPtr PositionBufferSRV = {};
 
@@ -1,23 +1,34 @@
 #pragma once
 
 #include "Object/Object.h"
+#include "Object/ObjectHandle.h"
+#include "Level/LevelStreamer.h"
+#include "Space/SpatialIndex.h"
+#include "Space/TransformStore.h"
 
+#include <Shared/Memory/SlabPool.h>
 #include <SurfMath.h>
 
+#include <array>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 class CameraComponent_c;
 class Level_c;
+class LevelLoadHandle_c;
 class MaterialShader_c;
+class SpatialObject_c;
 
 class Space_c : public std::enable_shared_from_this<Space_c>
 {
 public:
 
+	// Dense table of live objects, in no particular order. Creation and destruction are deferred to
+	// FlushPendingObjects so this only changes at frame boundaries.
 	std::vector<std::shared_ptr<Object_c>> Objects;
 	std::vector<std::shared_ptr<Level_c>> Levels;
 
@@ -26,33 +37,152 @@ public:
 	template<class ObjectType>
 	std::shared_ptr<ObjectType> CreateObject()
 	{
-		std::shared_ptr<ObjectType> NewObject = std::make_shared<ObjectType>(ObjectArgs_s{this});
-		Objects.push_back(NewObject);
+		std::shared_ptr<ObjectType> NewObject = std::allocate_shared<ObjectType>(SlabAllocator_t<ObjectType>(), ObjectArgs_s{this});
+		AddObjectInternal(NewObject);
 		NewObject->OnCreate();
 		return NewObject;
 	}
 
-	// TODO: Defer destruction until end of frame.
+	// Creates Count objects in one go, reserving the object tables once up front
+	template<class ObjectType>
+	std::vector<std::shared_ptr<ObjectType>> CreateObjects(uint32_t Count)
+	{
+		ReserveObjects(Count);
+
+		std::vector<std::shared_ptr<ObjectType>> NewObjects;
+		NewObjects.reserve(Count);
+		for (uint32_t ObjectIt = 0; ObjectIt < Count; ObjectIt++)
+		{
+			NewObjects.push_back(CreateObject<ObjectType>());
+		}
+		return NewObjects;
+	}
+
+	// Queues the object for destruction at the end of the frame. Destroying an object more than once is harmless.
 	void DestroyObject(Object_c* Object);
+	void DestroyObject(ObjectHandle_s Handle);
+
+	// Returns null for stale or invalid handles
+	Object_c* ResolveObject(ObjectHandle_s Handle) const noexcept;
+
+	template<class ObjectType>
+	ObjectType* ResolveObject(ObjectHandle_s Handle) const noexcept
+	{
+		return dynamic_cast<ObjectType*>(ResolveObject(Handle));
+	}
+
+	// Moves queued creations into Objects and applies queued destructions.
+	// Cost is linear in the number of queued changes, not in the number of objects.
+	void FlushPendingObjects();
+
+	void ReserveObjects(uint32_t AdditionalCount);
+
+	// Transforms of every SpatialObject_c in the space. World matrices are brought up to date before the
+	// PreRender tick phase and again at the end of Update.
+	TransformStore_c& GetTransforms() noexcept { return Transforms; }
+	const TransformStore_c& GetTransforms() const noexcept { return Transforms; }
+
+	// Spatial queries ////////////////////////////////////////////////////////////////
+
+	// Queries run against world bounds as of the last transform update, see GetTransforms.
+	// Func(SpatialObject_c*) returns false to stop early.
+
+	template<typename Func>
+	void QueryBox(const AABB& Box, Func&& Function) const
+	{
+		SpatialIndex.QueryBox(Box, [this, &Function](uint32_t Id) { return Function(SpatialObjectsByTransform[Id]); });
+	}
+
+	template<typename Func>
+	void QuerySphere(const float3& Center, float Radius, Func&& Function) const
+	{
+		SpatialIndex.QuerySphere(Center, Radius, [this, &Function](uint32_t Id) { return Function(SpatialObjectsByTransform[Id]); });
+	}
+
+	template<typename Func>
+	void QueryFrustum(const Frustum& View, Func&& Function) const
+	{
+		SpatialIndex.QueryFrustum(View, [this, &Function](uint32_t Id) { return Function(SpatialObjectsByTransform[Id]); });
+	}
+
+	// Func(SpatialObject_c*, float Distance) returns the new max distance, see SpatialIndex_c::RayCast
+	template<typename Func>
+	void RayCast(const float3& Origin, const float3& Direction, float MaxDistance, Func&& Function) const
+	{
+		SpatialIndex.RayCast(Origin, Direction, MaxDistance, [this, &Function](uint32_t Id, float Distance) { return Function(SpatialObjectsByTransform[Id], Distance); });
+	}
+
+	// Nearest object whose bounds the ray enters, or null. Objects whose bounds contain Origin are only returned,
+	// at distance 0, when the ray enters nothing else.
+	SpatialObject_c* RayCastClosest(const float3& Origin, const float3& Direction, float MaxDistance, float* OutDistance = nullptr) const;
+
+	const SpatialIndex_c& GetSpatialIndex() const noexcept { return SpatialIndex; }
+
+	// Called by SpatialObject_c. The object enters the index at the next transform update.
+	void RegisterSpatialObject(SpatialObject_c* Object);
+	void UnregisterSpatialObject(SpatialObject_c* Object);
+
+	// Components ////////////////////////////////////////////////////////////////
+
+	// Visits every component in the space that is, or derives from, ComponentType.
+	// Each concrete component type is kept in its own dense array so this never touches unrelated components.
+	template<class ComponentType, typename Func>
+	void ForEachComponentOfType(Func&& Function)
+	{
+		static_assert(HasOwnComponentType_v<ComponentType>, "ComponentType needs DECLARE_COMPONENT_TYPE");
+		const TypeId_t BaseType = ComponentType::StaticTypeId();
+		for (TypeId_t Type = 1; Type < ComponentsByType.size(); Type++)
+		{
+			if (ComponentsByType[Type].empty() || !TypeRegistry::IsA(Type, BaseType))
+				continue;
+
+			for (ObjectComponent_c* Component : ComponentsByType[Type])
+			{
+				if (Function(static_cast<ComponentType*>(Component)) == false)
+					return;
+			}
+		}
+	}
+
+	// Components of exactly Type, excluding derived types
+	const std::vector<ObjectComponent_c*>& GetComponentsOfExactType(TypeId_t Type) const;
+
+	// Called by Object_c as components are added and removed
+	void RegisterComponentInstance(ObjectComponent_c* Component);
+	void UnregisterComponentInstance(ObjectComponent_c* Component);
 
 	// Factory functions ////////////////////////////////////////////////////////////////
+
+	// Instances are allocated from a slab pool per class, see SlabAllocator_t
+	using ObjectFactory_t = std::function<std::shared_ptr<Object_c>(const ObjectArgs_s&)>;
+	using ComponentFactory_t = std::function<std::shared_ptr<ObjectComponent_c>(const ObjectComponentArgs_s&)>;
+
 	template<class ObjectType>
 	void RegisterObjectClass(const std::wstring& ClassName)
 	{
 		ObjectFactoryCallbacks[ClassName] = [](const ObjectArgs_s& Args) -> std::shared_ptr<Object_c>
 		{
-			return std::make_shared<ObjectType>(Args);
+			return std::allocate_shared<ObjectType>(SlabAllocator_t<ObjectType>(), Args);
 		};
 	}
 
 	template<class ComponentType>
 	void RegisterComponentClass(const std::wstring& ClassName)
 	{
+		static_assert(HasOwnComponentType_v<ComponentType>, "ComponentType needs DECLARE_COMPONENT_TYPE");
 		ComponentFactoryCallbacks[ClassName] = [](const ObjectComponentArgs_s& Args) -> std::shared_ptr<ObjectComponent_c>
 		{
-			return std::make_shared<ComponentType>(Args);
+			return std::allocate_shared<ComponentType>(SlabAllocator_t<ComponentType>(), Args);
 		};
 	}
+
+	// Null if no class is registered under the name. The result stays valid until the class is registered again,
+	// so bulk creation can look a class up once and reuse it.
+	const ObjectFactory_t* FindObjectFactory(const std::wstring& ClassName) const;
+	const ComponentFactory_t* FindComponentFactory(const std::wstring& ClassName) const;
+
+	std::shared_ptr<Object_c> CreateObjectFromFactory(const ObjectFactory_t& Factory, const JsonValue_s* const Data = nullptr);
+	std::shared_ptr<ObjectComponent_c> CreateComponentFromFactory(Object_c* Owner, const ComponentFactory_t& Factory, const JsonValue_s* const Data = nullptr);
 	
 	template<class MaterialShaderType>
 	void RegisterMaterialShaderClass(const std::wstring& ClassName)
@@ -81,6 +211,16 @@ public:
 
 	void UnloadLevel(Level_c* InLevel);
 
+	// Parses the level and reads its mesh assets on dedicated load threads, then spawns its objects during Update within
+	// the level load budget each frame. The level joins Levels and gets Load() once every object is spawned.
+	std::shared_ptr<LevelLoadHandle_c> LoadLevelAsync(const struct Path_s& Path);
+
+	// Main thread time per frame spent spawning async loaded levels, shared by all loads in flight
+	void SetLevelLoadBudget(float Milliseconds) noexcept { LevelLoadBudgetMs = Milliseconds; }
+
+	// Streams the cells of a world around the primary camera, see LevelStreamer_c
+	LevelStreamer_c& GetLevelStreamer() noexcept { return LevelStreamer; }
+
 	// Camera
 	
 	std::weak_ptr<CameraComponent_c> PrimaryCamera;
@@ -92,9 +232,80 @@ protected:
 
 	void LoadLevelInternal(Level_c* InLevel, const std::wstring& LevelPath);
 
+	void AddObjectInternal(const std::shared_ptr<Object_c>& NewObject);
+
 private:
 
-	std::unordered_map<std::wstring, std::function<std::shared_ptr<Object_c>(const ObjectArgs_s&)>> ObjectFactoryCallbacks;
-	std::unordered_map<std::wstring, std::function<std::shared_ptr<ObjectComponent_c>(const ObjectComponentArgs_s&)>> ComponentFactoryCallbacks;
+	static constexpr uint32_t InvalidDenseIndex = UINT32_MAX;
+
+	struct ObjectSlot_s
+	{
+		Object_c* Object = nullptr;
+		uint32_t DenseIndex = InvalidDenseIndex; // Index into Objects, invalid while the creation is pending
+		uint32_t Generation = 0;
+	};
+
+	std::vector<ObjectSlot_s> ObjectSlots;
+	std::vector<uint32_t> FreeObjectSlots;
+
+	std::vector<std::shared_ptr<Object_c>> PendingCreates;
+	std::vector<ObjectHandle_s> PendingDestroys;
+
+	// Indexed by TypeId_t, holding only components whose most derived declared type is that id
+	std::vector<std::vector<ObjectComponent_c*>> ComponentsByType;
+
+	TransformStore_c Transforms;
+
+	// Rebuilds dirty world matrices and refits the bounds of the objects they belong to
+	void UpdateWorldTransforms();
+
+	SpatialIndex_c SpatialIndex;
+
+	// Both indexed by TransformId_t
+	std::vector<SpatialObject_c*> SpatialObjectsByTransform;
+	std::vector<SpatialProxyId_t> SpatialProxiesByTransform;
+
+	// Scratch for UpdateWorldTransforms
+	std::vector<TransformId_t> UpdatedTransforms;
+
+	// Ticking ////////////////////////////////////////////////////////////////
+
+	// Component types whose ticks can all run at once
+	struct TickWave_s
+	{
+		std::vector<TypeId_t> Types;
+		bool ThreadSafe = true;
+	};
+
+	void BuildTickSchedule();
+	void RunTickWave(const TickWave_s& Wave, float Delta);
+
+	// Indexed by TypeId_t, described when the first instance of a type is registered
+	std::vector<std::optional<ComponentTickDesc_s>> TickDescs;
+
+	std::array<std::vector<TickWave_s>, static_cast<size_t>(TickPhase_e::Count)> TickSchedule;
+	bool TickScheduleDirty = false;
+
+	// Set while a thread safe wave is running on the workers, when the object and component tables must not change
+	bool ParallelTickActive = false;
+
+	// Scratch for RunTickWave, prefix sums of component counts for the types in the wave
+	std::vector<uint32_t> TickWaveOffsets;
+
+	// Level loading ////////////////////////////////////////////////////////////////
+
+	void UpdateLevelLoads();
+
+	// Oldest first
+	std::vector<std::shared_ptr<LevelLoadHandle_c>> LevelLoads;
+	float LevelLoadBudgetMs = 4.0f;
+
+	// A level was unloaded, its objects' meshes are freed once their destruction is flushed
+	bool PruneMeshesAfterFlush = false;
+
+	LevelStreamer_c LevelStreamer{ *this };
+
+	std::unordered_map<std::wstring, ObjectFactory_t> ObjectFactoryCallbacks;
+	std::unordered_map<std::wstring, ComponentFactory_t> ComponentFactoryCallbacks;
 	std::unordered_map<std::wstring, std::function<std::shared_ptr<MaterialShader_c>()>> MaterialShaderFactoryCallbacks;
 };
\ No newline at end of file
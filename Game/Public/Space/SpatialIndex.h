@@ -0,0 +1,168 @@
+#pragma once
+
+#include <SurfMath.h>
+
+#include <cstdint>
+#include <vector>
+
+using SpatialProxyId_t = uint32_t;
+constexpr SpatialProxyId_t InvalidSpatialProxyId = UINT32_MAX;
+
+// Dynamic AABB tree. Leaves hold a fattened copy of their bounds so small movements only update the leaf,
+// the tree is only restructured when the bounds leave the fat box. Kept balanced with AVL style rotations.
+// Query callbacks receive the UserData given to CreateProxy and return false to stop the query early.
+class SpatialIndex_c
+{
+public:
+
+	SpatialProxyId_t CreateProxy(const AABB& Bounds, uint32_t UserData);
+	void DestroyProxy(SpatialProxyId_t Proxy);
+
+	// Returns true if the proxy had to be reinserted
+	bool MoveProxy(SpatialProxyId_t Proxy, const AABB& Bounds);
+
+	uint32_t GetUserData(SpatialProxyId_t Proxy) const noexcept { return Nodes[Proxy].UserData; }
+	const AABB& GetBounds(SpatialProxyId_t Proxy) const noexcept { return Nodes[Proxy].Bounds; }
+
+	uint32_t GetProxyCount() const noexcept { return ProxyCount; }
+	uint32_t GetHeight() const noexcept { return Root == InvalidNode ? 0 : static_cast<uint32_t>(Nodes[Root].Height); }
+
+	template<typename Func>
+	void QueryBox(const AABB& Box, Func&& Function) const
+	{
+		Traverse([&Box](const AABB& Bounds) { return BoxOverlapsBox(Bounds, Box); }, Function);
+	}
+
+	template<typename Func>
+	void QuerySphere(const float3& Center, float Radius, Func&& Function) const
+	{
+		Traverse([&Center, Radius](const AABB& Bounds) { return BoxOverlapsSphere(Bounds, Center, Radius); }, Function);
+	}
+
+	template<typename Func>
+	void QueryFrustum(const Frustum& View, Func&& Function) const
+	{
+		Traverse([&View](const AABB& Bounds) { return BoxOverlapsFrustum(Bounds, View); }, Function);
+	}
+
+	// Visits proxies whose bounds the ray hits within MaxDistance, nearest subtrees first is not guaranteed.
+	// Distance is where the ray enters the bounds, 0 for bounds containing Origin.
+	// Function(UserData, Distance) returns the new MaxDistance, so returning Distance finds the closest hit
+	// and returning a negative value stops the cast. Returning 0 still visits the other bounds containing Origin.
+	template<typename Func>
+	void RayCast(const float3& Origin, const float3& Direction, float MaxDistance, Func&& Function) const
+	{
+		if (Root == InvalidNode)
+			return;
+
+		const float3 InvDirection = { 1.0f / Direction.x, 1.0f / Direction.y, 1.0f / Direction.z };
+
+		uint32_t Stack[MaxStackDepth];
+		uint32_t StackSize = 0;
+		Stack[StackSize++] = Root;
+
+		while (StackSize > 0)
+		{
+			const Node_s& Node = Nodes[Stack[--StackSize]];
+
+			float Distance;
+			if (!RayHitsBox(Node.IsLeaf() ? Node.Bounds : Node.FatBounds, Origin, InvDirection, MaxDistance, Distance))
+				continue;
+
+			if (Node.IsLeaf())
+			{
+				MaxDistance = Function(Node.UserData, Distance);
+				if (MaxDistance < 0.0f)
+					return;
+			}
+			else
+			{
+				Stack[StackSize++] = Node.Children[0];
+				Stack[StackSize++] = Node.Children[1];
+			}
+		}
+	}
+
+	static bool BoxOverlapsBox(const AABB& A, const AABB& B) noexcept
+	{
+		return A.mins.x <= B.maxs.x && A.maxs.x >= B.mins.x
+			&& A.mins.y <= B.maxs.y && A.maxs.y >= B.mins.y
+			&& A.mins.z <= B.maxs.z && A.maxs.z >= B.mins.z;
+	}
+
+	static bool BoxOverlapsSphere(const AABB& Box, const float3& Center, float Radius) noexcept;
+
+	// Conservative, boxes straddling the corner of two planes may pass
+	static bool BoxOverlapsFrustum(const AABB& Box, const Frustum& View) noexcept;
+
+	// InvDirection components are +-inf for axes the ray is parallel to
+	static bool RayHitsBox(const AABB& Box, const float3& Origin, const float3& InvDirection, float MaxDistance, float& OutDistance) noexcept;
+
+private:
+
+	static constexpr uint32_t InvalidNode = UINT32_MAX;
+
+	// Balancing keeps the height near 1.44 * log2(leaf count), far below this for any count that fits in memory
+	static constexpr uint32_t MaxStackDepth = 128;
+
+	struct Node_s
+	{
+		AABB FatBounds;
+		AABB Bounds; // Leaves only, the bounds actually given for the proxy
+
+		// Next free node while on the free list
+		uint32_t Parent = InvalidNode;
+		uint32_t Children[2] = { InvalidNode, InvalidNode };
+
+		// Leaves are 0, free nodes -1
+		int32_t Height = -1;
+
+		uint32_t UserData = 0;
+
+		bool IsLeaf() const noexcept { return Children[0] == InvalidNode; }
+	};
+
+	template<typename OverlapFunc, typename Func>
+	void Traverse(OverlapFunc&& Overlaps, Func& Function) const
+	{
+		if (Root == InvalidNode)
+			return;
+
+		uint32_t Stack[MaxStackDepth];
+		uint32_t StackSize = 0;
+		Stack[StackSize++] = Root;
+
+		while (StackSize > 0)
+		{
+			const Node_s& Node = Nodes[Stack[--StackSize]];
+
+			if (Node.IsLeaf())
+			{
+				if (Overlaps(Node.Bounds) && Function(Node.UserData) == false)
+					return;
+			}
+			else if (Overlaps(Node.FatBounds))
+			{
+				Stack[StackSize++] = Node.Children[0];
+				Stack[StackSize++] = Node.Children[1];
+			}
+		}
+	}
+
+	uint32_t AllocateNode();
+	void FreeNode(uint32_t NodeId);
+
+	void InsertLeaf(uint32_t Leaf);
+	void RemoveLeaf(uint32_t Leaf);
+
+	// Rotates the subtree at NodeId if its children's heights differ by more than one, returns the new subtree root
+	uint32_t Balance(uint32_t NodeId);
+
+	// Recomputes heights and bounds from NodeId up to the root, balancing on the way
+	void RefitAncestors(uint32_t NodeId);
+
+	std::vector<Node_s> Nodes;
+	uint32_t Root = InvalidNode;
+	uint32_t FreeList = InvalidNode;
+	uint32_t ProxyCount = 0;
+};
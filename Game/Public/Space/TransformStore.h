@@ -0,0 +1,117 @@
+#pragma once
+
+#include <SurfMath.h>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+using TransformId_t = uint32_t;
+constexpr TransformId_t InvalidTransformId = UINT32_MAX;
+
+// Transforms of every spatial object in a space, stored as parallel arrays.
+// Setters only record the new value and flag the entry dirty, local and world matrices are rebuilt together
+// for just the dirty entries (and their descendants) in UpdateWorldMatrices, once per frame.
+class TransformStore_c
+{
+public:
+
+	TransformId_t Allocate(const float3& Position = float3(0.0f), const float3& Rotation = float3(0.0f), float Scale = 1.0f);
+
+	// Children of a freed transform are detached and keep their local values as their world values
+	void Free(TransformId_t Id);
+
+	// Setters may be called from thread safe component ticks, as long as no two threads write the same transform
+	void Set(TransformId_t Id, const float3& Position, const float3& Rotation, float Scale) noexcept
+	{
+		Positions[Id] = Position;
+		Rotations[Id] = Rotation;
+		Scales[Id] = Scale;
+		MarkDirty(Id, LocalDirty);
+	}
+
+	void SetPosition(TransformId_t Id, const float3& Position) noexcept
+	{
+		Positions[Id] = Position;
+		MarkDirty(Id, LocalDirty);
+	}
+
+	void SetRotation(TransformId_t Id, const float3& Rotation) noexcept
+	{
+		Rotations[Id] = Rotation;
+		MarkDirty(Id, LocalDirty);
+	}
+
+	void SetScale(TransformId_t Id, float Scale) noexcept
+	{
+		Scales[Id] = Scale;
+		MarkDirty(Id, LocalDirty);
+	}
+
+	// Local values, relative to the parent
+	const float3& GetPosition(TransformId_t Id) const noexcept { return Positions[Id]; }
+	const float3& GetRotation(TransformId_t Id) const noexcept { return Rotations[Id]; }
+	float GetScale(TransformId_t Id) const noexcept { return Scales[Id]; }
+
+	// As of the last UpdateWorldMatrices
+	const matrix& GetWorldMatrix(TransformId_t Id) const noexcept { return WorldMatrices[Id]; }
+
+	// Passing InvalidTransformId detaches. Returns false if Parent is Id or one of its descendants.
+	bool SetParent(TransformId_t Id, TransformId_t Parent);
+	TransformId_t GetParent(TransformId_t Id) const noexcept { return Parents[Id]; }
+
+	// Flags the world matrix as changed without touching the local values, e.g. when what it places has changed size
+	void MarkWorldDirty(TransformId_t Id) noexcept { MarkDirty(Id, WorldDirty); }
+
+	// Appends the id of every transform whose world matrix was rebuilt to OutUpdated, if given
+	void UpdateWorldMatrices(std::vector<TransformId_t>* OutUpdated = nullptr);
+
+	uint32_t GetDirtyCount() const noexcept { return DirtyCount.load(std::memory_order_relaxed); }
+
+private:
+
+	enum DirtyFlags_e : uint8_t
+	{
+		LocalDirty = 1 << 0, // Local matrix is stale, and so is the world matrix
+		WorldDirty = 1 << 1, // Only the world matrix is stale, e.g. the parent moved
+	};
+
+	// Lock free so that concurrent ticks can mark different transforms. Each entry is queued at most once per update.
+	void MarkDirty(TransformId_t Id, uint8_t Flags) noexcept
+	{
+		if (std::atomic_ref<uint8_t>(Dirty[Id]).fetch_or(Flags, std::memory_order_relaxed) == 0)
+		{
+			DirtyList[DirtyCount.fetch_add(1, std::memory_order_relaxed)] = Id;
+		}
+	}
+
+	void UpdateLocalMatrices(uint32_t Begin, uint32_t End);
+	void SetDepth(TransformId_t Id, uint16_t NewDepth);
+
+	std::vector<float3> Positions;
+	std::vector<float3> Rotations;
+	std::vector<float> Scales;
+	std::vector<matrix> LocalMatrices;
+	std::vector<matrix> WorldMatrices;
+
+	// Hierarchy, children are an intrusive singly linked list
+	std::vector<TransformId_t> Parents;
+	std::vector<TransformId_t> FirstChildren;
+	std::vector<TransformId_t> NextSiblings;
+	std::vector<uint16_t> Depths;
+	uint32_t ParentedCount = 0;
+
+	std::vector<uint8_t> Dirty;
+
+	// Sized to hold every entry, since an entry is only ever queued once
+	std::vector<TransformId_t> DirtyList;
+	std::atomic<uint32_t> DirtyCount = 0;
+
+	std::vector<TransformId_t> FreeIds;
+
+	// Scratch for UpdateWorldMatrices, the dirty entries' angles gathered into flat arrays
+	std::vector<TransformId_t> LocalIds;
+	std::vector<float> Angles;
+	std::vector<float> Sines;
+	std::vector<float> Cosines;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+// Runtime type ids for class hierarchies that want cheap "is a" queries without RTTI.
+// Ids are handed out on first use so they are stable for the life of the process, but not across runs.
+using TypeId_t = uint32_t;
+
+static constexpr TypeId_t InvalidTypeId = 0;
+
+namespace TypeRegistry
+{
+	static constexpr uint32_t MaxTypes = 1024;
+
+	TypeId_t RegisterType(const char* Name, TypeId_t ParentType);
+
+	// Valid ids are [1, GetTypeCount()]
+	uint32_t GetTypeCount() noexcept;
+
+	TypeId_t GetParentType(TypeId_t Type) noexcept;
+	const char* GetTypeName(TypeId_t Type) noexcept;
+
+	// True if Type is BaseType or derives from it
+	bool IsA(TypeId_t Type, TypeId_t BaseType) noexcept;
+}
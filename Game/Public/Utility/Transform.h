@@ -1,9 +1,58 @@
 #pragma once
 
+#include "Type/Type.h"
+
 #include <SurfMath.h>
 
+// Scale * Rotation * Translation, written out directly from the sines and cosines of the euler angles
+// (pitch, yaw, roll) rather than built from separate matrices and multiplied together.
+// The rotation part matches MakeMatrixRotationFromVector.
+inline void ComposeTransformMatrix(matrix& Out, const float3& Position, const float3& Sin, const float3& Cos, float Scale) noexcept
+{
+	const float sp = Sin.x, cp = Cos.x;
+	const float sy = Sin.y, cy = Cos.y;
+	const float sr = Sin.z, cr = Cos.z;
+
+	Out.m[0][0] = (cr * cy + sr * sp * sy) * Scale;
+	Out.m[0][1] = (sr * cp) * Scale;
+	Out.m[0][2] = (sr * sp * cy - cr * sy) * Scale;
+	Out.m[0][3] = 0.0f;
+
+	Out.m[1][0] = (cr * sp * sy - sr * cy) * Scale;
+	Out.m[1][1] = (cr * cp) * Scale;
+	Out.m[1][2] = (sr * sy + cr * sp * cy) * Scale;
+	Out.m[1][3] = 0.0f;
+
+	Out.m[2][0] = (cp * sy) * Scale;
+	Out.m[2][1] = (-sp) * Scale;
+	Out.m[2][2] = (cp * cy) * Scale;
+	Out.m[2][3] = 0.0f;
+
+	Out.m[3][0] = Position.x;
+	Out.m[3][1] = Position.y;
+	Out.m[3][2] = Position.z;
+	Out.m[3][3] = 1.0f;
+}
+
+inline void ComposeTransformMatrix(matrix& Out, const float3& Position, const float3& Rotation, float Scale) noexcept
+{
+	const float3 Sin = { sinf(Rotation.x), sinf(Rotation.y), sinf(Rotation.z) };
+	const float3 Cos = { cosf(Rotation.x), cosf(Rotation.y), cosf(Rotation.z) };
+	ComposeTransformMatrix(Out, Position, Sin, Cos, Scale);
+}
+
+// Standalone position, euler rotation and uniform scale. The matrix is composed each time it is read, with no cache
+// to write, so a const Transform_s is safe to read from parallel ticks.
+// Objects in a space keep their transforms in the space's TransformStore_c instead.
 struct Transform_s
 {
+	// Lets component ticks declare access to their owner's transform
+	static TypeId_t StaticTypeId() noexcept
+	{
+		static const TypeId_t Id = TypeRegistry::RegisterType("Transform_s", InvalidTypeId);
+		return Id;
+	}
+
 	Transform_s()
 	{
 		Set();
@@ -29,41 +78,36 @@ struct Transform_s
 		Position = InPosition;
 		Rotation = InRotation;
 		Scale = InScale;
-		UpdateMatrix();
 	}
 
 	void SetPosition(float3 InPosition) noexcept
 	{
 		Position = InPosition;
-		UpdateMatrix();
 	}
 
 	void SetRotation(float3 InRotation) noexcept
 	{
 		Rotation = InRotation;
-		UpdateMatrix();
 	}
 
 	void SetScale(float InScale) noexcept
 	{
 		Scale = InScale;
-		UpdateMatrix();
-	}
-
-	void UpdateMatrix() noexcept
-	{
-		Matrix = MakeMatrixScaling(Scale, Scale, Scale);
-		Matrix = Matrix * MakeMatrixRotationFromVector(Rotation);
-		Matrix = Matrix * MakeMatrixTranslation(Position);
 	}
 
 	float3 GetPosition() const noexcept { return Position; }
 	float3 GetRotation() const noexcept { return Rotation; }
 	float GetScale() const noexcept { return Scale; }
-	const matrix& GetMatrix() const noexcept { return Matrix; }
 
-	// Basis vectors are derived from Rotation rather than read out of Matrix,
-	// since Matrix has Scale and Position baked into it.
+	matrix GetMatrix() const noexcept
+	{
+		matrix Matrix;
+		ComposeTransformMatrix(Matrix, Position, Rotation, Scale);
+		return Matrix;
+	}
+
+	// Basis vectors are derived from Rotation rather than read out of the matrix,
+	// since it has Scale and Position baked into it.
 	float3 GetForwardVector() const noexcept
 	{
 		return GetDirectionFromEuler(Rotation);
@@ -90,5 +134,4 @@ private:
 	float3 Position;
 	float3 Rotation;
 	float Scale;
-	matrix Matrix;
 };
\ No newline at end of file
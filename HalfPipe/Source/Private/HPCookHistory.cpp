@@ -0,0 +1,299 @@
+#include "HPCookHistory.h"
+
+#include <FileUtils/JsonHelpers.h>
+#include <FileUtils/JsonValue.h>
+#include <Logging/Logging.h>
+#include <StringUtils/StringUtils.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+#define COOK_HISTORY_VERSION 1
+
+namespace
+{
+
+// Enough for a rolling baseline without the file growing forever. Counted per asset rather than per run, so the
+// small runs of watch mode recooks do not push out the records of the assets they did not cook.
+constexpr size_t MaxRecordsPerAsset = 30;
+
+thread_local HPCookHistory_c::Record_s* ThreadRecord = nullptr;
+
+double Median(std::vector<double> Values)
+{
+	std::sort(Values.begin(), Values.end());
+	const size_t Middle = Values.size() / 2;
+	return Values.size() % 2 ? Values[Middle] : 0.5 * (Values[Middle - 1] + Values[Middle]);
+}
+
+double PercentOver(double Value, double Baseline)
+{
+	return Baseline > 0.0 ? 100.0 * (Value - Baseline) / Baseline : 0.0;
+}
+
+}
+
+void HPCookHistory_c::Load(const std::wstring& OutputDir)
+{
+	HistoryPath = OutputDir + L"/CookHistory.json";
+	Runs.clear();
+
+	std::error_code Error;
+	if (!std::filesystem::exists(HistoryPath, Error))
+		return;
+
+	Json_t Root;
+	if (!LoadJsonFromFile(HistoryPath, Root) || !Root.is_object())
+	{
+		LOGWARNING("[HPCookHistory] Ignoring unreadable history %S", HistoryPath.c_str());
+		return;
+	}
+
+	int32_t Version = -1;
+	JsonHelpers::ParseInt(Root, "Version", Version);
+	if (Version != COOK_HISTORY_VERSION)
+	{
+		LOGINFO("[HPCookHistory] History version %d is not %d, starting a new one", Version, COOK_HISTORY_VERSION);
+		return;
+	}
+
+	auto RunsIt = Root.find("Runs");
+	if (RunsIt == Root.end() || !RunsIt->is_array())
+		return;
+
+	for (const Json_t& RunNode : *RunsIt)
+	{
+		Run_s& Run = Runs.emplace_back();
+		JsonHelpers::ParseInt(RunNode, "Time", Run.Time);
+
+		auto AssetsIt = RunNode.find("Assets");
+		if (AssetsIt == RunNode.end() || !AssetsIt->is_object())
+			continue;
+
+		for (auto AssetIt = AssetsIt->begin(); AssetIt != AssetsIt->end(); ++AssetIt)
+		{
+			const Json_t& Node = AssetIt.value();
+
+			Record_s& Record = Run.Assets[NarrowToWide(AssetIt.key())];
+			JsonHelpers::ParseWString(Node, "Type", Record.AssetType);
+			JsonHelpers::ParseInt(Node, "Input", Record.InputBytes);
+			JsonHelpers::ParseInt(Node, "Output", Record.OutputBytes);
+
+			auto SecondsIt = Node.find("Seconds");
+			if (SecondsIt != Node.end() && SecondsIt->is_number())
+			{
+				Record.Seconds = SecondsIt->get<double>();
+			}
+
+			auto StagesIt = Node.find("Stages");
+			if (StagesIt != Node.end() && StagesIt->is_object())
+			{
+				for (auto StageIt = StagesIt->begin(); StageIt != StagesIt->end(); ++StageIt)
+				{
+					if (StageIt.value().is_number())
+					{
+						Record.Stages[StageIt.key()] = StageIt.value().get<double>();
+					}
+				}
+			}
+		}
+	}
+}
+
+bool HPCookHistory_c::Save()
+{
+	{
+		std::lock_guard Lock(Mutex);
+		if (Pending.empty())
+			return true;
+
+		Run_s& Run = Runs.emplace_back();
+		Run.Time = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		Run.Assets = std::move(Pending);
+		Pending.clear();
+	}
+
+	// Newest runs first, so each asset keeps its latest records
+	std::unordered_map<std::wstring, size_t> RecordCounts;
+	for (auto RunIt = Runs.rbegin(); RunIt != Runs.rend(); ++RunIt)
+	{
+		std::erase_if(RunIt->Assets, [&RecordCounts](const auto& Asset) { return ++RecordCounts[Asset.first] > MaxRecordsPerAsset; });
+	}
+	std::erase_if(Runs, [](const Run_s& Run) { return Run.Assets.empty(); });
+
+	Json_t RunNodes = Json_t::array();
+	for (const Run_s& Run : Runs)
+	{
+		Json_t Assets = Json_t::object();
+		for (const auto& [Key, Record] : Run.Assets)
+		{
+			Json_t Stages = Json_t::object();
+			for (const auto& [Stage, Seconds] : Record.Stages)
+			{
+				Stages[Stage] = Seconds;
+			}
+
+			Assets[WideToNarrow(Key)] = {
+				{ "Type", WideToNarrow(Record.AssetType) },
+				{ "Seconds", Record.Seconds },
+				{ "Input", Record.InputBytes },
+				{ "Output", Record.OutputBytes },
+				{ "Stages", std::move(Stages) },
+			};
+		}
+
+		RunNodes.push_back({ { "Time", Run.Time }, { "Assets", std::move(Assets) } });
+	}
+
+	Json_t Root = { { "Version", COOK_HISTORY_VERSION }, { "Runs", std::move(RunNodes) } };
+
+	// Written aside and moved over the old one, so an interrupted cook never loses the runs already recorded
+	const std::wstring TempPath = HistoryPath + L".tmp";
+	{
+		std::ofstream Stream(std::filesystem::path(TempPath), std::ios::out | std::ios::trunc);
+		if (!Stream.is_open())
+		{
+			LOGERROR("[HPCookHistory] Failed to write history %S", TempPath.c_str());
+			return false;
+		}
+		Stream << Root.dump(1, '\t');
+
+		if (!Stream)
+		{
+			LOGERROR("[HPCookHistory] Failed writing history %S", TempPath.c_str());
+			return false;
+		}
+	}
+
+	std::error_code Error;
+	std::filesystem::rename(TempPath, HistoryPath, Error);
+	if (Error)
+	{
+		LOGERROR("[HPCookHistory] Failed to replace history %S: %s", HistoryPath.c_str(), Error.message().c_str());
+		return false;
+	}
+
+	return true;
+}
+
+void HPCookHistory_c::Record(const std::wstring& Key, Record_s Record)
+{
+	std::lock_guard Lock(Mutex);
+	Pending[Key] = std::move(Record);
+}
+
+uint32_t HPCookHistory_c::Report(const HPCookReportSettings_s& Settings) const
+{
+	if (Runs.empty())
+	{
+		LOGINFO("[HPCookHistory] No cook history in %S to report on", HistoryPath.c_str());
+		return 0;
+	}
+
+	const Run_s& Latest = Runs.back();
+	const double Limit = 1.0 + Settings.Threshold;
+
+	uint32_t ComparedCount = 0;
+	uint32_t RegressionCount = 0;
+	for (const auto& [Key, Record] : Latest.Assets)
+	{
+		// The newest earlier runs that cooked the asset, skipped and failed cooks leave no record
+		std::vector<const Record_s*> Earlier;
+		for (auto RunIt = std::next(Runs.rbegin()); RunIt != Runs.rend() && Earlier.size() < Settings.BaselineRuns; ++RunIt)
+		{
+			auto Found = RunIt->Assets.find(Key);
+			if (Found != RunIt->Assets.end())
+			{
+				Earlier.push_back(&Found->second);
+			}
+		}
+
+		if (Earlier.empty())
+			continue;
+
+		ComparedCount++;
+
+		std::vector<double> Seconds;
+		std::vector<double> OutputBytes;
+		for (const Record_s* Previous : Earlier)
+		{
+			Seconds.push_back(Previous->Seconds);
+			OutputBytes.push_back(static_cast<double>(Previous->OutputBytes));
+		}
+
+		const double BaselineSeconds = Median(Seconds);
+		const double BaselineBytes = Median(OutputBytes);
+
+		const bool Slower = Record.Seconds > BaselineSeconds * Limit && Record.Seconds - BaselineSeconds >= Settings.MinSeconds;
+		const bool Larger = static_cast<double>(Record.OutputBytes) > BaselineBytes * Limit;
+		if (!Slower && !Larger)
+			continue;
+
+		RegressionCount++;
+
+		if (Slower)
+		{
+			LOGWARNING("[HPCookHistory] %S cooked in %.3f seconds against a baseline of %.3f, %.0f%% slower", Key.c_str(), Record.Seconds, BaselineSeconds, PercentOver(Record.Seconds, BaselineSeconds));
+
+			// The stages that account for it
+			for (const auto& [Stage, StageSeconds] : Record.Stages)
+			{
+				std::vector<double> StageBaseline;
+				for (const Record_s* Previous : Earlier)
+				{
+					auto Found = Previous->Stages.find(Stage);
+					StageBaseline.push_back(Found != Previous->Stages.end() ? Found->second : 0.0);
+				}
+
+				const double StageBaselineSeconds = Median(StageBaseline);
+				if (StageSeconds > StageBaselineSeconds * Limit && StageSeconds - StageBaselineSeconds >= Settings.MinSeconds)
+				{
+					LOGWARNING("[HPCookHistory]   %s %.3f seconds against %.3f", Stage.c_str(), StageSeconds, StageBaselineSeconds);
+				}
+			}
+		}
+
+		if (Larger)
+		{
+			LOGWARNING("[HPCookHistory] %S cooked to %llu bytes against a baseline of %.0f, %.0f%% larger", Key.c_str(), static_cast<unsigned long long>(Record.OutputBytes), BaselineBytes, PercentOver(static_cast<double>(Record.OutputBytes), BaselineBytes));
+		}
+	}
+
+	LOGINFO("[HPCookHistory] %u of %u assets in the latest cook regressed more than %.0f%% against the median of up to %u earlier runs",
+		RegressionCount, ComparedCount, Settings.Threshold * 100.0f, Settings.BaselineRuns);
+
+	return RegressionCount;
+}
+
+void HPCookHistory_c::SetThreadRecord(Record_s* Record)
+{
+	ThreadRecord = Record;
+}
+
+void HPCookHistory_c::RecordStage(const char* Stage, double Seconds)
+{
+	if (ThreadRecord)
+	{
+		ThreadRecord->Stages[Stage] += Seconds;
+	}
+}
+
+HPCookStageTimer_s::HPCookStageTimer_s(const char* InStage, const std::wstring& AssetPath)
+	: Stage(InStage)
+	, Timer(std::string(InStage) + " " + WideToNarrow(AssetPath))
+	, StartTime(std::chrono::steady_clock::now())
+{}
+
+HPCookStageTimer_s::~HPCookStageTimer_s()
+{
+	HPCookHistory_c::RecordStage(Stage, std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count());
+}
+
+uint32_t HPReportCookRegressions(const std::wstring& OutputDir, const HPCookReportSettings_s& Settings)
+{
+	HPCookHistory_c History;
+	History.Load(OutputDir);
+	return History.Report(Settings);
+}
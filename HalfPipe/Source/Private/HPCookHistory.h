@@ -0,0 +1,75 @@
+#pragma once
+
+#include "HalfPipe.h"
+
+#include <Profiling/ScopeTimer.h>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Timings and sizes of the assets each cook cooked, kept as json in the output dir for the last runs of each asset,
+// so a later report can compare the latest run of each asset against its recent ones.
+class HPCookHistory_c
+{
+public:
+
+	struct Record_s
+	{
+		std::wstring AssetType;
+		double Seconds = 0.0;
+		uint64_t InputBytes = 0;
+		uint64_t OutputBytes = 0;
+
+		// Seconds per stage, summed if a stage runs more than once
+		std::map<std::string, double> Stages;
+	};
+
+	// A missing history is an empty one
+	void Load(const std::wstring& OutputDir);
+
+	// Adds the records of this cook as the newest run, dropping each asset's oldest records beyond those kept
+	bool Save();
+
+	// Called from the cook threads as assets finish
+	void Record(const std::wstring& Key, Record_s Record);
+
+	// Logs the assets of the newest run whose cook time or output size regressed past the report settings against
+	// the median of their earlier runs, returns how many did
+	uint32_t Report(const HPCookReportSettings_s& Settings) const;
+
+	// Stages timed on this thread are added to Record until cleared
+	static void SetThreadRecord(Record_s* Record);
+	static void RecordStage(const char* Stage, double Seconds);
+
+private:
+
+	struct Run_s
+	{
+		int64_t Time = 0; // Seconds since the epoch
+		std::map<std::wstring, Record_s> Assets;
+	};
+
+	std::wstring HistoryPath;
+	std::deque<Run_s> Runs;
+
+	std::mutex Mutex;
+	std::map<std::wstring, Record_s> Pending;
+};
+
+// Logs the stage like ScopeTimer_s and adds its time to the cook record of the running asset
+struct HPCookStageTimer_s
+{
+	HPCookStageTimer_s(const char* InStage, const std::wstring& AssetPath);
+	~HPCookStageTimer_s();
+
+private:
+
+	const char* Stage;
+	ScopeTimer_s Timer;
+	std::chrono::steady_clock::time_point StartTime;
+};
@@ -0,0 +1,320 @@
+#include "HPCookManifest.h"
+
+#include <FileUtils/JsonHelpers.h>
+#include <FileUtils/JsonValue.h>
+#include <Logging/Logging.h>
+#include <StringUtils/StringUtils.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+#define COOK_MANIFEST_VERSION 1
+
+namespace
+{
+
+constexpr uint64_t HashBasis = 0xcbf29ce484222325ull; // FNV-1a 64
+constexpr uint64_t HashPrime = 0x100000001b3ull;
+
+void HashBytes(uint64_t& Hash, const void* Data, size_t Size)
+{
+	const uint8_t* Bytes = static_cast<const uint8_t*>(Data);
+	for (size_t ByteIt = 0; ByteIt < Size; ByteIt++)
+	{
+		Hash ^= Bytes[ByteIt];
+		Hash *= HashPrime;
+	}
+}
+
+bool HashFile(const std::filesystem::path& Path, uint64_t& OutHash)
+{
+	std::ifstream Stream(Path, std::ios::in | std::ios::binary);
+	if (!Stream.is_open())
+		return false;
+
+	constexpr size_t BufferSize = 1024 * 1024;
+	std::unique_ptr<char[]> Buffer = std::make_unique<char[]>(BufferSize);
+
+	OutHash = HashBasis;
+	while (Stream)
+	{
+		Stream.read(Buffer.get(), BufferSize);
+		HashBytes(OutHash, Buffer.get(), static_cast<size_t>(Stream.gcount()));
+	}
+
+	return !Stream.bad();
+}
+
+}
+
+void HPCookManifest_c::Load(const std::wstring& InOutputDir)
+{
+	OutputDir = InOutputDir;
+	ManifestPath = OutputDir + L"/CookManifest.json";
+	Entries.clear();
+
+	std::error_code Error;
+	if (!std::filesystem::exists(ManifestPath, Error))
+		return;
+
+	Json_t Root;
+	if (!LoadJsonFromFile(ManifestPath, Root) || !Root.is_object())
+	{
+		LOGWARNING("[HPCookManifest] Ignoring unreadable manifest %S, every asset will cook", ManifestPath.c_str());
+		return;
+	}
+
+	int32_t Version = -1;
+	JsonHelpers::ParseInt(Root, "Version", Version);
+	if (Version != COOK_MANIFEST_VERSION)
+	{
+		LOGINFO("[HPCookManifest] Manifest version %d is not %d, every asset will cook", Version, COOK_MANIFEST_VERSION);
+		return;
+	}
+
+	auto AssetsIt = Root.find("Assets");
+	if (AssetsIt == Root.end() || !AssetsIt->is_object())
+		return;
+
+	for (auto AssetIt = AssetsIt->begin(); AssetIt != AssetsIt->end(); ++AssetIt)
+	{
+		const Json_t& Node = AssetIt.value();
+
+		Entry_s Entry;
+		JsonHelpers::ParseWString(Node, "Type", Entry.AssetType);
+		JsonHelpers::ParseInt(Node, "PipeVersion", Entry.PipeVersion);
+		JsonHelpers::ParseInt(Node, "ArgsHash", Entry.ArgsHash);
+
+		auto SourcesIt = Node.find("Sources");
+		if (SourcesIt != Node.end() && SourcesIt->is_array())
+		{
+			for (const Json_t& SourceNode : *SourcesIt)
+			{
+				Source_s& Source = Entry.Sources.emplace_back();
+				JsonHelpers::ParseWString(SourceNode, "Path", Source.Path);
+				JsonHelpers::ParseInt(SourceNode, "Size", Source.Size);
+				JsonHelpers::ParseInt(SourceNode, "Time", Source.WriteTime);
+				JsonHelpers::ParseInt(SourceNode, "Hash", Source.Hash);
+			}
+		}
+
+		auto DependenciesIt = Node.find("Dependencies");
+		if (DependenciesIt != Node.end() && DependenciesIt->is_array())
+		{
+			for (const Json_t& DependencyNode : *DependenciesIt)
+			{
+				HPAssetArgs_s& Dependency = Entry.Dependencies.emplace_back();
+				JsonHelpers::ParseWString(DependencyNode, "Type", Dependency.AssetType);
+
+				auto ArgsIt = DependencyNode.find("Args");
+				if (ArgsIt != DependencyNode.end() && ArgsIt->is_array())
+				{
+					for (const Json_t& Arg : *ArgsIt)
+					{
+						Dependency.Args.push_back(NarrowToWide(Arg.is_string() ? Arg.get<std::string>() : std::string()));
+					}
+				}
+			}
+		}
+
+		auto OutputsIt = Node.find("Outputs");
+		if (OutputsIt != Node.end() && OutputsIt->is_array())
+		{
+			for (const Json_t& Output : *OutputsIt)
+			{
+				Entry.Outputs.push_back(NarrowToWide(Output.is_string() ? Output.get<std::string>() : std::string()));
+			}
+		}
+
+		Entries[NarrowToWide(AssetIt.key())] = std::move(Entry);
+	}
+}
+
+bool HPCookManifest_c::Save() const
+{
+	std::lock_guard Lock(Mutex);
+
+	Json_t Assets = Json_t::object();
+	for (const auto& [Key, Entry] : Entries)
+	{
+		Json_t Sources = Json_t::array();
+		for (const Source_s& Source : Entry.Sources)
+		{
+			Sources.push_back({ { "Path", WideToNarrow(Source.Path) }, { "Size", Source.Size }, { "Time", Source.WriteTime }, { "Hash", Source.Hash } });
+		}
+
+		Json_t Dependencies = Json_t::array();
+		for (const HPAssetArgs_s& Dependency : Entry.Dependencies)
+		{
+			Json_t Args = Json_t::array();
+			for (const std::wstring& Arg : Dependency.Args)
+			{
+				Args.push_back(WideToNarrow(Arg));
+			}
+			Dependencies.push_back({ { "Type", WideToNarrow(Dependency.AssetType) }, { "Args", std::move(Args) } });
+		}
+
+		Json_t Outputs = Json_t::array();
+		for (const std::wstring& Output : Entry.Outputs)
+		{
+			Outputs.push_back(WideToNarrow(Output));
+		}
+
+		Assets[WideToNarrow(Key)] = {
+			{ "Type", WideToNarrow(Entry.AssetType) },
+			{ "PipeVersion", Entry.PipeVersion },
+			{ "ArgsHash", Entry.ArgsHash },
+			{ "Sources", std::move(Sources) },
+			{ "Dependencies", std::move(Dependencies) },
+			{ "Outputs", std::move(Outputs) },
+		};
+	}
+
+	Json_t Root = { { "Version", COOK_MANIFEST_VERSION }, { "Assets", std::move(Assets) } };
+
+	// Written aside and moved over the old one, so an interrupted cook never leaves half a manifest
+	const std::wstring TempPath = ManifestPath + L".tmp";
+	{
+		std::ofstream Stream(std::filesystem::path(TempPath), std::ios::out | std::ios::trunc);
+		if (!Stream.is_open())
+		{
+			LOGERROR("[HPCookManifest] Failed to write manifest %S", TempPath.c_str());
+			return false;
+		}
+		Stream << Root.dump(1, '\t');
+	}
+
+	std::error_code Error;
+	std::filesystem::rename(TempPath, ManifestPath, Error);
+	if (Error)
+	{
+		LOGERROR("[HPCookManifest] Failed to replace manifest %S: %s", ManifestPath.c_str(), Error.message().c_str());
+		return false;
+	}
+
+	return true;
+}
+
+std::string HPCookManifest_c::CheckUpToDate(const std::wstring& Key, const HPAssetArgs_s& Args, uint32_t PipeVersion, const std::wstring& SourceDir,
+	const std::wstring& OutputPath, std::vector<HPAssetArgs_s>& OutDependencies)
+{
+	Entry_s Entry;
+	{
+		std::lock_guard Lock(Mutex);
+		auto It = Entries.find(Key);
+		if (It == Entries.end())
+			return "not cooked before";
+
+		Entry = It->second;
+	}
+
+	if (Entry.AssetType != Args.AssetType)
+		return "asset type changed";
+
+	if (Entry.PipeVersion != PipeVersion)
+		return "pipe version changed";
+
+	if (Entry.ArgsHash != HashArgs(Args))
+		return "cook arguments changed";
+
+	std::error_code Error;
+	if (!std::filesystem::exists(OutputPath, Error))
+		return "output missing";
+
+	for (const std::wstring& Output : Entry.Outputs)
+	{
+		if (!std::filesystem::exists(std::filesystem::path(OutputDir) / Output, Error))
+			return "output " + WideToNarrow(Output) + " missing";
+	}
+
+	bool Refreshed = false;
+	for (Source_s& Source : Entry.Sources)
+	{
+		Source_s Current;
+		if (!StatSource(SourceDir, Source.Path, Current))
+			return "source " + WideToNarrow(Source.Path) + " missing";
+
+		if (Current.Size == Source.Size && Current.WriteTime == Source.WriteTime)
+			continue;
+
+		if (Current.Size != Source.Size)
+			return "source " + WideToNarrow(Source.Path) + " changed";
+
+		// Same size but a new write time, only the contents can tell
+		if (!HashFile(std::filesystem::path(SourceDir) / Source.Path, Current.Hash))
+			return "source " + WideToNarrow(Source.Path) + " missing";
+
+		if (Current.Hash != Source.Hash)
+			return "source " + WideToNarrow(Source.Path) + " changed";
+
+		// Touched without changing
+		Source = Current;
+		Refreshed = true;
+	}
+
+	if (Refreshed)
+	{
+		std::lock_guard Lock(Mutex);
+		Entries[Key].Sources = Entry.Sources;
+	}
+
+	OutDependencies = std::move(Entry.Dependencies);
+	return {};
+}
+
+void HPCookManifest_c::Record(const std::wstring& Key, Entry_s Entry)
+{
+	std::lock_guard Lock(Mutex);
+	Entries[Key] = std::move(Entry);
+}
+
+void HPCookManifest_c::Remove(const std::wstring& Key)
+{
+	std::lock_guard Lock(Mutex);
+	Entries.erase(Key);
+}
+
+bool HPCookManifest_c::GetEntry(const std::wstring& Key, Entry_s& OutEntry) const
+{
+	std::lock_guard Lock(Mutex);
+
+	auto It = Entries.find(Key);
+	if (It == Entries.end())
+		return false;
+
+	OutEntry = It->second;
+	return true;
+}
+
+bool HPCookManifest_c::StatSource(const std::wstring& SourceDir, const std::wstring& Path, Source_s& OutSource)
+{
+	const std::filesystem::path FullPath = std::filesystem::path(SourceDir) / Path;
+
+	std::error_code Error;
+	OutSource.Path = Path;
+	OutSource.Size = std::filesystem::file_size(FullPath, Error);
+	if (Error)
+		return false;
+
+	OutSource.WriteTime = std::filesystem::last_write_time(FullPath, Error).time_since_epoch().count();
+	return !Error;
+}
+
+bool HPCookManifest_c::StampSource(const std::wstring& SourceDir, const std::wstring& Path, Source_s& OutSource)
+{
+	return StatSource(SourceDir, Path, OutSource) && HashFile(std::filesystem::path(SourceDir) / Path, OutSource.Hash);
+}
+
+uint64_t HPCookManifest_c::HashArgs(const HPAssetArgs_s& Args)
+{
+	uint64_t Hash = HashBasis;
+	HashBytes(Hash, Args.AssetType.data(), Args.AssetType.size() * sizeof(wchar_t));
+	for (const std::wstring& Arg : Args.Args)
+	{
+		// Separated, so splitting an argument differently hashes differently
+		HashBytes(Hash, Arg.data(), Arg.size() * sizeof(wchar_t));
+		HashBytes(Hash, L"\0", sizeof(wchar_t));
+	}
+	return Hash;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "HalfPipe.h"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Remembers what each cooked asset was cooked from, so a cook can skip assets whose sources, arguments and pipe
+// version are unchanged. Kept as json in the output dir, keyed by the asset's package path.
+class HPCookManifest_c
+{
+public:
+
+	struct Source_s
+	{
+		std::wstring Path; // Relative to the source dir
+		uint64_t Size = 0;
+		int64_t WriteTime = 0;
+		uint64_t Hash = 0; // Of the contents, only computed when the size or write time differ
+	};
+
+	struct Entry_s
+	{
+		std::wstring AssetType;
+		uint32_t PipeVersion = 0;
+		uint64_t ArgsHash = 0;
+		std::vector<Source_s> Sources;
+
+		// Cooks the asset pushed, like a material library's textures. Pushed again when the asset is skipped,
+		// so they are checked in turn.
+		std::vector<HPAssetArgs_s> Dependencies;
+
+		// Files the cook wrote besides the cooked asset, relative to the output dir, like a partitioned level's cells
+		std::vector<std::wstring> Outputs;
+	};
+
+	// A missing manifest is an empty one
+	void Load(const std::wstring& InOutputDir);
+	bool Save() const;
+
+	// Empty if the asset is up to date, otherwise why it needs cooking. When up to date, OutDependencies are the
+	// cooks it pushed last time. Sources touched without changing have their recorded size and time refreshed.
+	std::string CheckUpToDate(const std::wstring& Key, const HPAssetArgs_s& Args, uint32_t PipeVersion, const std::wstring& SourceDir,
+		const std::wstring& OutputPath, std::vector<HPAssetArgs_s>& OutDependencies);
+
+	// Called from the cook threads as assets finish
+	void Record(const std::wstring& Key, Entry_s Entry);
+	void Remove(const std::wstring& Key);
+
+	// False if the asset has not been cooked, or failed its last cook
+	bool GetEntry(const std::wstring& Key, Entry_s& OutEntry) const;
+
+	// Size and write time only, without reading the file. False if it can not be found.
+	static bool StatSource(const std::wstring& SourceDir, const std::wstring& Path, Source_s& OutSource);
+
+	// StatSource plus the hash of the contents, for recording a cook. False if the file can not be read.
+	static bool StampSource(const std::wstring& SourceDir, const std::wstring& Path, Source_s& OutSource);
+	static uint64_t HashArgs(const HPAssetArgs_s& Args);
+
+private:
+
+	std::wstring OutputDir;
+	std::wstring ManifestPath;
+
+	mutable std::mutex Mutex;
+	std::map<std::wstring, Entry_s> Entries;
+};
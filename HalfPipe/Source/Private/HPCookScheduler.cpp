@@ -0,0 +1,266 @@
+#include "HPCookScheduler.h"
+
+#include <Logging/Logging.h>
+#include <Profiling/ProcessMemory.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+
+// The scheduler and thread index of the cook running on this thread, so pushes from a cook stay on its thread
+thread_local const HPCookScheduler_c* CurrentScheduler = nullptr;
+thread_local uint32_t CurrentThread = 0;
+
+// Cheap to read, and often enough to catch the peak of all but the shortest stages
+constexpr std::chrono::milliseconds MemorySampleInterval(5);
+
+constexpr double Megabytes = 1024.0 * 1024.0;
+
+}
+
+HPCookScheduler_c::HPCookScheduler_c(uint32_t ThreadCount, uint64_t InMemoryBudget)
+	: MemoryBudget(InMemoryBudget)
+{
+	if (ThreadCount == 0)
+	{
+		ThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	Threads.reserve(ThreadCount);
+	for (uint32_t ThreadIt = 0; ThreadIt < ThreadCount; ThreadIt++)
+	{
+		Threads.push_back(std::make_unique<Thread_s>());
+	}
+}
+
+void HPCookScheduler_c::Push(HPAssetArgs_s Args)
+{
+	const uint32_t Thread = CurrentScheduler == this ? CurrentThread : NextThread.fetch_add(1) % GetThreadCount();
+
+	// Counted before it is queued, so no thread sees the work run out while it is in flight
+	Outstanding.fetch_add(1);
+	{
+		std::lock_guard Lock(Threads[Thread]->Mutex);
+		Threads[Thread]->Queue.push_back(std::move(Args));
+	}
+
+	{
+		std::lock_guard Lock(WakeMutex);
+	}
+	WakeCondition.notify_one();
+}
+
+bool HPCookScheduler_c::TryPop(uint32_t Thread, HPAssetArgs_s& OutArgs)
+{
+	// Newest first from its own queue, which are the dependencies its last cook pushed
+	{
+		Thread_s& Own = *Threads[Thread];
+		std::lock_guard Lock(Own.Mutex);
+		if (!Own.Queue.empty())
+		{
+			OutArgs = std::move(Own.Queue.back());
+			Own.Queue.pop_back();
+			return true;
+		}
+	}
+
+	for (uint32_t Offset = 1; Offset < GetThreadCount(); Offset++)
+	{
+		Thread_s& Victim = *Threads[(Thread + Offset) % GetThreadCount()];
+		std::lock_guard Lock(Victim.Mutex);
+		if (!Victim.Queue.empty())
+		{
+			OutArgs = std::move(Victim.Queue.front());
+			Victim.Queue.pop_front();
+			Threads[Thread]->Stats.StealCount++;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void HPCookScheduler_c::WorkerMain(uint32_t Thread, const CookFunction_t& Cook)
+{
+	CurrentScheduler = this;
+	CurrentThread = Thread;
+
+	ThreadStats_s& Stats = Threads[Thread]->Stats;
+
+	for (;;)
+	{
+		HPAssetArgs_s Args;
+		if (TryPop(Thread, Args))
+		{
+			const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+			Cook(Args);
+			Stats.BusySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+			Stats.CookCount++;
+
+			if (Outstanding.fetch_sub(1) == 1)
+			{
+				{
+					std::lock_guard Lock(WakeMutex);
+				}
+				WakeCondition.notify_all();
+			}
+			continue;
+		}
+
+		std::unique_lock Lock(WakeMutex);
+		if (Outstanding.load() == 0)
+			break;
+
+		// Woken by pushes and by the last cook finishing, the timeout covers a push landing between TryPop and here
+		WakeCondition.wait_for(Lock, std::chrono::milliseconds(10));
+	}
+
+	CurrentScheduler = nullptr;
+}
+
+void HPCookScheduler_c::Run(const CookFunction_t& Cook)
+{
+	const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+
+	{
+		std::lock_guard Lock(MemoryMutex);
+		Sampling = true;
+	}
+	std::thread Sampler([this]() { SampleMemory(); });
+
+	std::vector<std::thread> Workers;
+	Workers.reserve(GetThreadCount() - 1);
+	for (uint32_t ThreadIt = 1; ThreadIt < GetThreadCount(); ThreadIt++)
+	{
+		Workers.emplace_back([this, ThreadIt, &Cook]() { WorkerMain(ThreadIt, Cook); });
+	}
+
+	WorkerMain(0, Cook);
+
+	for (std::thread& Worker : Workers)
+	{
+		Worker.join();
+	}
+
+	{
+		std::lock_guard Lock(MemoryMutex);
+		Sampling = false;
+	}
+	MemoryCondition.notify_all();
+	Sampler.join();
+
+	WallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+}
+
+void HPCookScheduler_c::AdmitMemory(HPCookMemoryGrant_c& Grant)
+{
+	std::unique_lock Lock(MemoryMutex);
+
+	if (MemoryBudget > 0 && AdmittedBytes > 0 && AdmittedBytes + Grant.Estimate > MemoryBudget)
+	{
+		const std::chrono::steady_clock::time_point WaitStart = std::chrono::steady_clock::now();
+		MemoryCondition.wait(Lock, [this, &Grant]() { return AdmittedBytes == 0 || AdmittedBytes + Grant.Estimate <= MemoryBudget; });
+
+		MemoryStats.WaitCount++;
+		MemoryStats.WaitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - WaitStart).count();
+	}
+
+	AdmittedBytes += Grant.Estimate;
+	MemoryStats.PeakAdmittedBytes = std::max(MemoryStats.PeakAdmittedBytes, AdmittedBytes);
+	Grants.push_back(&Grant);
+}
+
+void HPCookScheduler_c::ReleaseMemory(HPCookMemoryGrant_c& Grant)
+{
+	{
+		std::lock_guard Lock(MemoryMutex);
+		AdmittedBytes -= Grant.Estimate;
+		Grants.erase(std::find(Grants.begin(), Grants.end(), &Grant));
+	}
+	MemoryCondition.notify_all();
+}
+
+void HPCookScheduler_c::SampleMemory()
+{
+	std::unique_lock Lock(MemoryMutex);
+	while (Sampling)
+	{
+		if (!Grants.empty())
+		{
+			const uint64_t Resident = GetProcessResidentBytes();
+			for (HPCookMemoryGrant_c* Grant : Grants)
+			{
+				Grant->Sample(Resident);
+			}
+		}
+
+		MemoryCondition.wait_for(Lock, MemorySampleInterval, [this]() { return !Sampling; });
+	}
+}
+
+void HPCookScheduler_c::LogSummary() const
+{
+	uint32_t CookCount = 0;
+	double BusySeconds = 0.0;
+	for (const std::unique_ptr<Thread_s>& Thread : Threads)
+	{
+		CookCount += Thread->Stats.CookCount;
+		BusySeconds += Thread->Stats.BusySeconds;
+	}
+
+	auto Utilization = [this](double Busy) { return WallSeconds > 0.0 ? 100.0 * Busy / WallSeconds : 0.0; };
+
+	LOGINFO("[HPCookScheduler] Cooked %u assets in %.2f seconds on %u threads, %.0f%% utilization", CookCount, WallSeconds, GetThreadCount(), Utilization(BusySeconds / GetThreadCount()));
+
+	for (uint32_t ThreadIt = 0; ThreadIt < GetThreadCount(); ThreadIt++)
+	{
+		const ThreadStats_s& Stats = Threads[ThreadIt]->Stats;
+		LOGINFO("[HPCookScheduler]   Thread %u: %u cooks, %u stolen, %.2f seconds busy, %.0f%% utilization", ThreadIt, Stats.CookCount, Stats.StealCount, Stats.BusySeconds, Utilization(Stats.BusySeconds));
+	}
+
+	if (MemoryBudget > 0)
+	{
+		LOGINFO("[HPCookScheduler] Memory budget %.0f MB, at most %.0f MB estimated at once, %u cooks waited %.2f seconds for memory", MemoryBudget / Megabytes,
+			MemoryStats.PeakAdmittedBytes / Megabytes, MemoryStats.WaitCount, MemoryStats.WaitSeconds);
+	}
+	LOGINFO("[HPCookScheduler] Peak resident memory %.0f MB", GetProcessPeakResidentBytes() / Megabytes);
+}
+
+HPCookMemoryGrant_c::HPCookMemoryGrant_c(HPCookScheduler_c& InScheduler, uint64_t InEstimate)
+	: Scheduler(InScheduler)
+	, Estimate(InEstimate)
+{
+	if (Scheduler.MemoryBudget > 0 && Estimate > Scheduler.MemoryBudget)
+	{
+		LOGWARNING("[HPCookScheduler] A cook estimated at %.0f MB is over the %.0f MB memory budget, it will run alone", Estimate / Megabytes, Scheduler.MemoryBudget / Megabytes);
+	}
+
+	Scheduler.AdmitMemory(*this);
+
+	// After waiting, memory freed by the cooks waited on is not counted against this one
+	StartResident = GetProcessResidentBytes();
+	PeakResident = StartResident;
+}
+
+HPCookMemoryGrant_c::~HPCookMemoryGrant_c()
+{
+	Sample(GetProcessResidentBytes());
+	Scheduler.ReleaseMemory(*this);
+}
+
+uint64_t HPCookMemoryGrant_c::GetPeakGrowth() const noexcept
+{
+	const uint64_t Peak = PeakResident.load();
+	return Peak > StartResident ? Peak - StartResident : 0;
+}
+
+void HPCookMemoryGrant_c::Sample(uint64_t Resident) noexcept
+{
+	uint64_t Peak = PeakResident.load();
+	while (Resident > Peak && !PeakResident.compare_exchange_weak(Peak, Resident))
+	{
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "HalfPipe.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class HPCookMemoryGrant_c;
+
+// Cooks on a fixed set of threads, each with a queue of its own. A cook that pushes more cooks, like a material
+// library pushing its textures, puts them on its own thread's queue and runs them next. Threads that run out of
+// work steal the oldest command queued on another thread.
+// Cooks hold an HPCookMemoryGrant_c while they run, which keeps the memory the running cooks are estimated to need
+// under the budget.
+class HPCookScheduler_c
+{
+public:
+
+	using CookFunction_t = std::function<void(const HPAssetArgs_s& Args)>;
+
+	struct ThreadStats_s
+	{
+		uint32_t CookCount = 0;
+		uint32_t StealCount = 0;
+		double BusySeconds = 0.0;
+	};
+
+	struct MemoryStats_s
+	{
+		uint64_t PeakAdmittedBytes = 0;
+		uint32_t WaitCount = 0;
+		double WaitSeconds = 0.0;
+	};
+
+	// 0 for a thread per hardware thread. A MemoryBudget of 0 admits every cook.
+	explicit HPCookScheduler_c(uint32_t ThreadCount, uint64_t InMemoryBudget = 0);
+
+	HPCookScheduler_c(const HPCookScheduler_c&) = delete;
+	HPCookScheduler_c& operator=(const HPCookScheduler_c&) = delete;
+
+	// Safe from any thread, including from inside a cook
+	void Push(HPAssetArgs_s Args);
+
+	// Cooks until every queue is empty and no cook is running. The calling thread is thread 0.
+	void Run(const CookFunction_t& Cook);
+
+	uint32_t GetThreadCount() const noexcept { return static_cast<uint32_t>(Threads.size()); }
+	const ThreadStats_s& GetThreadStats(uint32_t Thread) const noexcept { return Threads[Thread]->Stats; }
+	double GetWallSeconds() const noexcept { return WallSeconds; }
+
+	// Logs the cooks and steals of each thread and how much of the run it spent cooking, and the memory admitted
+	void LogSummary() const;
+
+private:
+
+	friend class HPCookMemoryGrant_c;
+
+	// Blocks until the estimate fits in the budget, a cook estimated over the whole budget runs once no other does
+	void AdmitMemory(HPCookMemoryGrant_c& Grant);
+	void ReleaseMemory(HPCookMemoryGrant_c& Grant);
+
+	// Raises the resident peak of every running cook until the run ends
+	void SampleMemory();
+
+	struct Thread_s
+	{
+		std::mutex Mutex;
+		std::deque<HPAssetArgs_s> Queue;
+		ThreadStats_s Stats; // Only written by the thread itself
+	};
+
+	bool TryPop(uint32_t Thread, HPAssetArgs_s& OutArgs);
+	void WorkerMain(uint32_t Thread, const CookFunction_t& Cook);
+
+	std::vector<std::unique_ptr<Thread_s>> Threads;
+
+	// Pushes from outside the cook threads are dealt out round robin
+	std::atomic<uint32_t> NextThread = 0;
+
+	// Queued plus running, the threads stop once it reaches 0
+	std::atomic<uint32_t> Outstanding = 0;
+
+	std::mutex WakeMutex;
+	std::condition_variable WakeCondition;
+
+	double WallSeconds = 0.0;
+
+	uint64_t MemoryBudget = 0;
+
+	std::mutex MemoryMutex;
+	std::condition_variable MemoryCondition;
+	uint64_t AdmittedBytes = 0;
+	std::vector<HPCookMemoryGrant_c*> Grants;
+	MemoryStats_s MemoryStats;
+	bool Sampling = false;
+};
+
+// Held by a cook while it runs, waiting on construction until the scheduler admits its estimated memory. Tracks how
+// far the process's resident memory rose above where it was when the cook started, which includes whatever cooks
+// ran alongside it.
+class HPCookMemoryGrant_c
+{
+public:
+
+	HPCookMemoryGrant_c(HPCookScheduler_c& InScheduler, uint64_t InEstimate);
+	~HPCookMemoryGrant_c();
+
+	HPCookMemoryGrant_c(const HPCookMemoryGrant_c&) = delete;
+	HPCookMemoryGrant_c& operator=(const HPCookMemoryGrant_c&) = delete;
+
+	uint64_t GetEstimate() const noexcept { return Estimate; }
+	uint64_t GetPeakGrowth() const noexcept;
+
+private:
+
+	friend class HPCookScheduler_c;
+
+	void Sample(uint64_t Resident) noexcept;
+
+	HPCookScheduler_c& Scheduler;
+	uint64_t Estimate = 0;
+	uint64_t StartResident = 0;
+	std::atomic<uint64_t> PeakResident = 0;
+};
@@ -0,0 +1,553 @@
+#include "HPLevelPipe.h"
+
+#include "HPLevel.h"
+#include "WaveFrontReader.h"
+
+#include <FileUtils/FileStream.h>
+#include <FileUtils/JsonHelpers.h>
+#include <FileUtils/JsonValue.h>
+#include <FileUtils/PathUtils.h>
+#include <Logging/Logging.h>
+#include <StringUtils/StringUtils.h>
+
+#include <SurfMath.h>
+
+#include <cfloat>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <unordered_map>
+
+// Version of the .hp_lvl source the pipe understands
+#define LEVEL_SOURCE_VERSION 1
+
+// Version of the .hp_world written when partitioning into cells, read by LevelStreamer_c
+#define WORLD_VERSION 1
+
+// Bumped when partitioned cooks change without the world format changing, so existing worlds recook
+#define WORLD_COOK_REVISION 2
+
+static std::wstring GenerateOutputPath(const std::wstring& OutputDir, const std::wstring& AssetPath, bool Partitioned)
+{
+	return OutputDir + L"/" + ReplacePathExtension(AssetPath, Partitioned ? L"hp_world" : L"hp_clv");
+}
+
+namespace
+{
+
+uint64_t HashName(const std::string& Name)
+{
+	uint64_t Hash = 0xcbf29ce484222325ull; // FNV-1a 64
+	for (char Char : Name)
+	{
+		Hash ^= static_cast<uint8_t>(Char);
+		Hash *= 0x100000001b3ull;
+	}
+	return Hash;
+}
+
+struct LevelWriter_s
+{
+	HPLevelHeader_s Header;
+	std::vector<HPLevelClass_s> Classes;
+	std::vector<HPLevelObject_s> Objects;
+	std::vector<HPLevelComponent_s> Components;
+	std::vector<char> Strings;
+	std::vector<uint8_t> Payload;
+
+	std::unordered_map<std::string, uint32_t> ObjectClassIndices;
+	std::unordered_map<std::string, uint32_t> ComponentClassIndices;
+
+	uint32_t AddClass(const std::string& Name, HPLevelClassKind_e Kind)
+	{
+		std::unordered_map<std::string, uint32_t>& Indices = Kind == HPLevelClassKind_e::OBJECT ? ObjectClassIndices : ComponentClassIndices;
+
+		auto It = Indices.find(Name);
+		if (It != Indices.end())
+			return It->second;
+
+		HPLevelClass_s& Class = Classes.emplace_back();
+		Class.NameHash = HashName(Name);
+		Class.NameOffset = static_cast<uint32_t>(Strings.size());
+		Class.NameLength = static_cast<uint32_t>(Name.size());
+		Class.Kind = Kind;
+		Class.Padding = 0;
+
+		Strings.insert(Strings.end(), Name.begin(), Name.end());
+
+		const uint32_t Index = static_cast<uint32_t>(Classes.size() - 1);
+		Indices[Name] = Index;
+		return Index;
+	}
+
+	// Whatever is left of the node once the fields the cooked layout stores itself are removed
+	void AddPayload(Json_t Node, std::initializer_list<const char*> CookedFields, uint32_t& OutOffset, uint32_t& OutSize)
+	{
+		for (const char* Field : CookedFields)
+		{
+			Node.erase(Field);
+		}
+
+		OutOffset = static_cast<uint32_t>(Payload.size());
+		OutSize = 0;
+
+		if (Node.empty())
+			return;
+
+		const std::vector<uint8_t> Bytes = Json_t::to_cbor(Node);
+		Payload.insert(Payload.end(), Bytes.begin(), Bytes.end());
+		OutSize = static_cast<uint32_t>(Bytes.size());
+	}
+
+	// Size of the file once written
+	uint64_t WrittenSize = 0;
+
+	bool Write(const std::wstring& Path)
+	{
+		// Tables start 8 byte aligned so they can be read in place
+		uint32_t Offset = sizeof(HPLevelHeader_s);
+		auto Place = [&Offset](size_t Size)
+		{
+			const uint32_t Placed = AlignUpPow2(Offset, 8u);
+			Offset = Placed + static_cast<uint32_t>(Size);
+			return Placed;
+		};
+
+		Header.ClassCount = static_cast<uint32_t>(Classes.size());
+		Header.ObjectCount = static_cast<uint32_t>(Objects.size());
+		Header.ComponentCount = static_cast<uint32_t>(Components.size());
+		Header.ClassTableOffset = Place(Classes.size() * sizeof(HPLevelClass_s));
+		Header.ObjectTableOffset = Place(Objects.size() * sizeof(HPLevelObject_s));
+		Header.ComponentTableOffset = Place(Components.size() * sizeof(HPLevelComponent_s));
+		Header.StringTableOffset = Place(Strings.size());
+		Header.StringTableSize = static_cast<uint32_t>(Strings.size());
+		Header.PayloadOffset = Place(Payload.size());
+		Header.PayloadSize = static_cast<uint32_t>(Payload.size());
+
+		FileStream_s Stream(Path, FileStreamMode_e::WRITE);
+		if (!Stream.IsOpen())
+			return false;
+
+		auto WritePadded = [&Stream](uint32_t TableOffset, const void* Data, size_t Size)
+		{
+			static const uint8_t Zeros[8] = {};
+			Stream.WriteArray(Zeros, TableOffset - Stream.GetSize());
+			Stream.WriteArray(static_cast<const uint8_t*>(Data), Size);
+		};
+
+		Stream.Write(&Header);
+		WritePadded(Header.ClassTableOffset, Classes.data(), Classes.size() * sizeof(HPLevelClass_s));
+		WritePadded(Header.ObjectTableOffset, Objects.data(), Objects.size() * sizeof(HPLevelObject_s));
+		WritePadded(Header.ComponentTableOffset, Components.data(), Components.size() * sizeof(HPLevelComponent_s));
+		WritePadded(Header.StringTableOffset, Strings.data(), Strings.size());
+		WritePadded(Header.PayloadOffset, Payload.data(), Payload.size());
+
+		WrittenSize = Stream.GetSize();
+		return true;
+	}
+};
+
+bool CookObject(const Json_t& Node, LevelWriter_s& Writer)
+{
+	std::string Class;
+	if (!Node.is_object() || !JsonHelpers::ParseString(Node, "Class", Class) || Class.empty())
+	{
+		LOGWARNING("[HPLevelPipe] Skipping object entry without a 'Class'");
+		return false;
+	}
+
+	HPLevelObject_s Object = {};
+	Object.ClassIndex = Writer.AddClass(Class, HPLevelClassKind_e::OBJECT);
+
+	float3 Position = float3(0.0f);
+	float3 Rotation = float3(0.0f);
+	float Scale = 1.0f;
+	bool HasTransform = JsonHelpers::ParseFloat3(Node, "Position", Position);
+	HasTransform |= JsonHelpers::ParseFloat3(Node, "Rotation", Rotation);
+	HasTransform |= JsonHelpers::ParseFloat(Node, "Scale", Scale);
+
+	Object.Position[0] = Position.x;
+	Object.Position[1] = Position.y;
+	Object.Position[2] = Position.z;
+	Object.Rotation[0] = Rotation.x;
+	Object.Rotation[1] = Rotation.y;
+	Object.Rotation[2] = Rotation.z;
+	Object.Scale = Scale;
+	Object.Flags = HasTransform ? HPLEVEL_OBJECT_HAS_TRANSFORM : 0;
+
+	Object.FirstComponent = static_cast<uint32_t>(Writer.Components.size());
+
+	auto ComponentsIt = Node.find("Components");
+	if (ComponentsIt != Node.end() && ComponentsIt->is_array())
+	{
+		for (const Json_t& ComponentNode : *ComponentsIt)
+		{
+			std::string ComponentClass;
+			if (!ComponentNode.is_object() || !JsonHelpers::ParseString(ComponentNode, "Class", ComponentClass) || ComponentClass.empty())
+			{
+				LOGWARNING("[HPLevelPipe] Skipping component entry without a 'Class' on object '%s'", Class.c_str());
+				continue;
+			}
+
+			HPLevelComponent_s Component = {};
+			Component.ClassIndex = Writer.AddClass(ComponentClass, HPLevelClassKind_e::COMPONENT);
+			Writer.AddPayload(ComponentNode, { "Class" }, Component.PayloadOffset, Component.PayloadSize);
+			Writer.Components.push_back(Component);
+		}
+	}
+
+	Object.ComponentCount = static_cast<uint32_t>(Writer.Components.size()) - Object.FirstComponent;
+
+	Writer.AddPayload(Node, { "Class", "Position", "Rotation", "Scale", "Components" }, Object.PayloadOffset, Object.PayloadSize);
+	Writer.Objects.push_back(Object);
+
+	return true;
+}
+
+// The game opens mesh paths as they are, fall back to the source directory when cooking from elsewhere
+std::wstring ResolveMeshPath(const std::wstring& SourceDir, const std::wstring& Path)
+{
+	std::error_code Error;
+	if (std::filesystem::exists(Path, Error))
+		return Path;
+
+	return SourceDir + L"/" + Path;
+}
+
+// The mesh asset paths of the object and its components
+template<typename Visitor_t>
+void ForEachMeshAssetPath(const Json_t& ObjectNode, Visitor_t&& Visitor)
+{
+	auto VisitNode = [&Visitor](const Json_t& Node)
+	{
+		std::wstring MeshAssetPath;
+		if (JsonHelpers::ParseWString(Node, "MeshAssetPath", MeshAssetPath))
+		{
+			Visitor(MeshAssetPath);
+		}
+	};
+
+	VisitNode(ObjectNode);
+
+	auto ComponentsIt = ObjectNode.find("Components");
+	if (ComponentsIt != ObjectNode.end() && ComponentsIt->is_array())
+	{
+		for (const Json_t& ComponentNode : *ComponentsIt)
+		{
+			if (ComponentNode.is_object())
+			{
+				VisitNode(ComponentNode);
+			}
+		}
+	}
+}
+
+struct LevelCell_s
+{
+	LevelWriter_s Writer;
+	AABB Bounds;
+};
+
+// Local bounds of the meshes objects use, read from their source files once per mesh asset
+class MeshBoundsCache_c
+{
+public:
+
+	explicit MeshBoundsCache_c(const std::wstring& InSourceDir)
+		: SourceDir(InSourceDir)
+	{}
+
+	// Empty if the mesh could not be read
+	const AABB& Get(const std::wstring& MeshAssetPath)
+	{
+		auto [It, Inserted] = Bounds.try_emplace(MeshAssetPath);
+		if (!Inserted)
+			return It->second;
+
+		Json_t Mesh;
+		std::wstring SourceFilePath;
+		if (!LoadJsonFromFile(ResolveMeshPath(SourceDir, MeshAssetPath), Mesh) || !JsonHelpers::ParseWString(Mesh, "SourceFilePath", SourceFilePath))
+		{
+			LOGWARNING("[HPLevelPipe] Failed to read mesh [%S], cell bounds only cover its objects' positions", MeshAssetPath.c_str());
+			return It->second;
+		}
+
+		WaveFrontReader_c Reader;
+		if (!Reader.Load(ResolveMeshPath(SourceDir, SourceFilePath).c_str()))
+		{
+			LOGWARNING("[HPLevelPipe] Failed to read mesh source [%S], cell bounds only cover its objects' positions", SourceFilePath.c_str());
+			return It->second;
+		}
+
+		for (const WaveFrontReader_c::Vertex_s& Vertex : Reader.Vertices)
+		{
+			It->second.Grow(Vertex.Position);
+		}
+
+		return It->second;
+	}
+
+private:
+
+	std::wstring SourceDir;
+	std::unordered_map<std::wstring, AABB> Bounds;
+};
+
+// The object's position grown by the meshes it and its components use. Meshes are bounded by a sphere around
+// the position, which holds whatever the rotation.
+AABB CalculateObjectBounds(const Json_t& ObjectNode, const float3& Position, MeshBoundsCache_c& MeshBounds)
+{
+	AABB Bounds(Position, Position);
+
+	float Scale = 1.0f;
+	JsonHelpers::ParseFloat(ObjectNode, "Scale", Scale);
+
+	ForEachMeshAssetPath(ObjectNode, [&](const std::wstring& MeshAssetPath)
+	{
+		// Still empty if the mesh could not be read
+		const AABB& MeshBox = MeshBounds.Get(MeshAssetPath);
+		if (MeshBox.mins.x > MeshBox.maxs.x)
+			return;
+
+		const float3 Farthest = MaxVector(MeshBox.maxs, -MeshBox.mins);
+		const float Radius = Length(Farthest) * fabsf(Scale);
+		Bounds.Grow(AABB(Position - Radius, Position + Radius));
+	});
+
+	return Bounds;
+}
+
+// Bins objects into square cells on the XZ plane by position, objects without one land in the cell at the origin.
+// Cell bounds cover the meshes of their objects, which may reach past the cell's square.
+bool CookPartitioned(const Json_t& Objects, float CellSize, const std::wstring& SourceDir, const std::wstring& OutputDir, const std::wstring& AssetPath)
+{
+	// Ordered so the world file lists cells the same way every cook
+	std::map<std::pair<int32_t, int32_t>, LevelCell_s> Cells;
+	MeshBoundsCache_c MeshBounds(SourceDir);
+
+	for (const Json_t& ObjectNode : Objects)
+	{
+		float3 Position = float3(0.0f);
+		if (ObjectNode.is_object())
+		{
+			JsonHelpers::ParseFloat3(ObjectNode, "Position", Position);
+		}
+
+		const std::pair<int32_t, int32_t> Key = { static_cast<int32_t>(floorf(Position.x / CellSize)), static_cast<int32_t>(floorf(Position.z / CellSize)) };
+		LevelCell_s& Cell = Cells[Key];
+		if (CookObject(ObjectNode, Cell.Writer))
+		{
+			Cell.Bounds.Grow(CalculateObjectBounds(ObjectNode, Position, MeshBounds));
+		}
+	}
+
+	const std::wstring WorldOutputPath = GenerateOutputPath(OutputDir, AssetPath, true);
+	CreateDirectories(WorldOutputPath);
+
+	// Cells sit next to the world file and are named relative to it
+	const std::wstring CellBasePath = ReplacePathExtension(WorldOutputPath, L"");
+	const size_t NameStart = CellBasePath.find_last_of(L"/\\");
+	const std::wstring CellBaseName = NameStart == std::wstring::npos ? CellBasePath : CellBasePath.substr(NameStart + 1);
+	const std::wstring CellBaseAssetPath = ReplacePathExtension(AssetPath, L"");
+
+	Json_t CellsNode = Json_t::array();
+	for (auto& [Key, Cell] : Cells)
+	{
+		if (Cell.Writer.Objects.empty())
+			continue;
+
+		const std::wstring CellSuffix = L"_" + std::to_wstring(Key.first) + L"_" + std::to_wstring(Key.second) + L".hp_clv";
+		if (!Cell.Writer.Write(CellBasePath + CellSuffix))
+		{
+			LOGERROR("[HPLevelPipe] Failed to write cell [%S]", (CellBasePath + CellSuffix).c_str());
+			return false;
+		}
+
+		// Recorded so the cell is packaged with the world, and deleted once a cook no longer writes it
+		RecordCookOutput(CellBaseAssetPath + CellSuffix);
+
+		const float3 Min = MinVector(float3(Key.first * CellSize, Cell.Bounds.mins.y, Key.second * CellSize), Cell.Bounds.mins);
+		const float3 Max = MaxVector(float3((Key.first + 1) * CellSize, Cell.Bounds.maxs.y, (Key.second + 1) * CellSize), Cell.Bounds.maxs);
+
+		char Bounds[2][96];
+		snprintf(Bounds[0], sizeof(Bounds[0]), "%g, %g, %g", Min.x, Min.y, Min.z);
+		snprintf(Bounds[1], sizeof(Bounds[1]), "%g, %g, %g", Max.x, Max.y, Max.z);
+
+		Json_t CellNode;
+		CellNode["Level"] = WideToNarrow(CellBaseName + CellSuffix);
+		CellNode["Min"] = Bounds[0];
+		CellNode["Max"] = Bounds[1];
+		CellNode["Size"] = Cell.Writer.WrittenSize;
+		CellsNode.push_back(std::move(CellNode));
+	}
+
+	Json_t World;
+	World["Version"] = WORLD_VERSION;
+	World["LoadDistance"] = CellSize;
+	World["UnloadDistance"] = CellSize * 1.5f;
+	World["Cells"] = std::move(CellsNode);
+
+	std::ofstream WorldStream{ std::filesystem::path(WorldOutputPath) };
+	WorldStream << World.dump(1, '\t');
+	if (!WorldStream)
+	{
+		LOGERROR("[HPLevelPipe] Failed to write world [%S]", WorldOutputPath.c_str());
+		return false;
+	}
+
+	LOGINFO("[HPLevelPipe] Cooked world [%S], %zu objects in %zu cells of %g", WorldOutputPath.c_str(), Objects.size(), World["Cells"].size(), CellSize);
+	return true;
+}
+
+}
+
+bool HPLevelPipe_c::Cook(const std::wstring& SourceDir, const std::wstring& OutputDir, const HPArgs_t& Args)
+{
+	std::wstring AssetPath;
+	if (!ParseArgs(Args, L"-src", AssetPath) || AssetPath.empty())
+	{
+		LOGERROR("[HPLevelPipe] No source path provided for asset");
+		return false;
+	}
+
+	std::wstring AbsSrcPath = SourceDir + L"/" + AssetPath;
+
+	if (!HasPathExtension(AbsSrcPath, L".hp_lvl"))
+	{
+		LOGERROR("[HPLevelPipe] Unsupported file extension for source asset [%S]", AbsSrcPath.c_str());
+		return false;
+	}
+
+	Json_t Root;
+	if (!LoadJsonFromFile(AbsSrcPath, Root) || !Root.is_object())
+	{
+		LOGERROR("[HPLevelPipe] Failed to load level json [%S]", AbsSrcPath.c_str());
+		return false;
+	}
+
+	int32_t Version = -1;
+	JsonHelpers::ParseInt(Root, "Version", Version);
+	if (Version != LEVEL_SOURCE_VERSION)
+	{
+		LOGERROR("[HPLevelPipe] Unsupported level version %d in [%S], expected %d", Version, AbsSrcPath.c_str(), LEVEL_SOURCE_VERSION);
+		return false;
+	}
+
+	auto ObjectsIt = Root.find("Objects");
+	if (ObjectsIt == Root.end() || !ObjectsIt->is_array())
+	{
+		LOGERROR("[HPLevelPipe] Level [%S] requires an 'Objects' array", AbsSrcPath.c_str());
+		return false;
+	}
+
+	std::wstring CellSizeString;
+	if (ParseArgs(Args, L"-cell", CellSizeString))
+	{
+		const float CellSize = wcstof(CellSizeString.c_str(), nullptr);
+		if (CellSize <= 0.0f)
+		{
+			LOGERROR("[HPLevelPipe] Invalid cell size '%S' for [%S]", CellSizeString.c_str(), AbsSrcPath.c_str());
+			return false;
+		}
+
+		return CookPartitioned(*ObjectsIt, CellSize, SourceDir, OutputDir, AssetPath);
+	}
+
+	LevelWriter_s Writer;
+	Writer.Objects.reserve(ObjectsIt->size());
+
+	for (const Json_t& ObjectNode : *ObjectsIt)
+	{
+		CookObject(ObjectNode, Writer);
+	}
+
+	std::wstring AssetOutputPath = GenerateOutputPath(OutputDir, AssetPath, false);
+
+	CreateDirectories(AssetOutputPath);
+
+	if (!Writer.Write(AssetOutputPath))
+	{
+		LOGERROR("[HPLevelPipe] Failed to write asset [%S]", AssetOutputPath.c_str());
+		return false;
+	}
+
+	LOGINFO("[HPLevelPipe] Cooked level [%S], %zu objects, %zu components, %zu classes", AssetOutputPath.c_str(), Writer.Objects.size(), Writer.Components.size(), Writer.Classes.size());
+
+	return true;
+}
+
+bool HPLevelPipe_c::IsPartitioned(const HPArgs_t& Args)
+{
+	std::wstring CellSize;
+	return ParseArgs(Args, L"-cell", CellSize);
+}
+
+void HPLevelPipe_c::GetSourcePaths(const std::wstring& SourceDir, const HPArgs_t& Args, std::vector<std::wstring>& OutPaths) const
+{
+	IHPPipe_c::GetSourcePaths(SourceDir, Args, OutPaths);
+
+	// Partitioned cooks also read the meshes their objects use, for the cell bounds
+	if (OutPaths.empty() || !IsPartitioned(Args))
+		return;
+
+	Json_t Root;
+	if (!LoadJsonFromFile(SourceDir + L"/" + OutPaths.front(), Root) || !Root.is_object())
+		return;
+
+	auto ObjectsIt = Root.find("Objects");
+	if (ObjectsIt == Root.end() || !ObjectsIt->is_array())
+		return;
+
+	// Ordered so the manifest lists the sources the same way every cook
+	std::set<std::wstring> MeshAssetPaths;
+	for (const Json_t& ObjectNode : *ObjectsIt)
+	{
+		if (ObjectNode.is_object())
+		{
+			ForEachMeshAssetPath(ObjectNode, [&MeshAssetPaths](const std::wstring& MeshAssetPath) { MeshAssetPaths.insert(MeshAssetPath); });
+		}
+	}
+
+	for (const std::wstring& MeshAssetPath : MeshAssetPaths)
+	{
+		const std::wstring MeshPath = ResolveMeshPath(SourceDir, MeshAssetPath);
+		OutPaths.push_back(MakePathRelativeTo(MeshPath, SourceDir));
+
+		Json_t Mesh;
+		std::wstring SourceFilePath;
+		if (LoadJsonFromFile(MeshPath, Mesh) && JsonHelpers::ParseWString(Mesh, "SourceFilePath", SourceFilePath))
+		{
+			OutPaths.push_back(MakePathRelativeTo(ResolveMeshPath(SourceDir, SourceFilePath), SourceDir));
+		}
+	}
+}
+
+uint32_t HPLevelPipe_c::GetVersion() const
+{
+	// The level format, and the world format and cook revision of partitioned levels
+	return (static_cast<uint32_t>(HPLevelVersion_e::CURRENT) << 16) | (WORLD_COOK_REVISION << 8) | WORLD_VERSION;
+}
+
+std::wstring HPLevelPipe_c::GetCookedAssetPath(const std::wstring& OutputDir, const HPArgs_t& Args) const
+{
+	std::wstring AssetPath;
+	if (!ParseArgs(Args, L"-src", AssetPath))
+	{
+		LOGERROR("[HPLevelPipe] No source path provided for asset");
+		return {};
+	}
+
+	return GenerateOutputPath(OutputDir, AssetPath, IsPartitioned(Args));
+}
+
+std::wstring HPLevelPipe_c::GetPackageAssetPath(const HPArgs_t& Args) const
+{
+	std::wstring AssetPath;
+	if (!ParseArgs(Args, L"-src", AssetPath))
+	{
+		LOGERROR("[HPLevelPipe] No source path provided for asset");
+		return {};
+	}
+	return ReplacePathExtension(AssetPath, IsPartitioned(Args) ? L"hp_world" : L"hp_clv");
+}
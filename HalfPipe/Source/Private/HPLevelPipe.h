@@ -0,0 +1,19 @@
+#pragma once
+
+#include "HPPipe.h"
+
+class HPLevelPipe_c : public IHPPipe_c
+{
+public:
+	const wchar_t* GetAssetType() const override { return L"Level"; }
+	bool Cook(const std::wstring& SourceDir, const std::wstring& OutputDir, const HPArgs_t& Args) override;
+	uint32_t GetVersion() const override;
+	void GetSourcePaths(const std::wstring& SourceDir, const HPArgs_t& Args, std::vector<std::wstring>& OutPaths) const override;
+	std::wstring GetCookedAssetPath(const std::wstring& OutputDir, const HPArgs_t& Args) const override;
+	std::wstring GetPackageAssetPath(const HPArgs_t& Args) const override;
+
+private:
+
+	// With -cell <size> the level is split into a grid of cooked cell levels listed by a .hp_world, rather than one .hp_clv
+	static bool IsPartitioned(const HPArgs_t& Args);
+};
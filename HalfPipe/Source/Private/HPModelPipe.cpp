@@ -1,5 +1,6 @@
 #include "HPModelPipe.h"
 
+#include "HPCookHistory.h"
 #include "HPModel.h"
 #include "MeshProcessing.h"
 #include "WaveFrontReader.h"
@@ -7,13 +8,22 @@
 #include <FileUtils/FileStream.h>
 #include <FileUtils/PathUtils.h>
 #include <Logging/Logging.h>
-#include <Profiling/ScopeTimer.h>
+
+// Bumped when model cooks change without the model format changing, so existing models recook
+#define MODEL_COOK_REVISION 1
+
+// Frees a vector as soon as the stages using it are done, clear() would keep its capacity until the cook ends
+template<class T>
+static void ReleaseVector(std::vector<T>& Vector)
+{
+    std::vector<T>().swap(Vector);
+}
 
 bool LoadModelFromWavefront(const std::wstring& SourceDir, const std::wstring& OutputDir, const wchar_t* WavefrontPath, HPModel_s& OutModel)
 {
     WaveFrontReader_c Reader;
     {
-        ScopeTimer_s ScopeTimer(L"Loaded Wavefront file " + std::wstring(WavefrontPath));
+        HPCookStageTimer_s StageTimer("Load Wavefront file", WavefrontPath);
 
         if (!Reader.Load(WavefrontPath))
         {
@@ -69,6 +79,8 @@ bool LoadModelFromWavefront(const std::wstring& SourceDir, const std::wstring& O
         }
     }
 
+    ReleaseVector(Reader.Vertices);
+
     OutModel.Indices.resize(Reader.Indices.size() * sizeof(uint32_t));
     OutModel.IndexCount = static_cast<uint32_t>(Reader.Indices.size());
     const uint32_t TriCount = OutModel.IndexCount / 3;
@@ -84,7 +96,9 @@ bool LoadModelFromWavefront(const std::wstring& SourceDir, const std::wstring& O
         }
     }
 
-    Attributes = Reader.Attributes;
+    ReleaseVector(Reader.Indices);
+
+    Attributes = std::move(Reader.Attributes);
 
    
     OutModel.VertexCount = static_cast<uint32_t>(OutModel.Positions.size());
@@ -98,7 +112,7 @@ bool LoadModelFromWavefront(const std::wstring& SourceDir, const std::wstring& O
     FaceRemap.resize(TriCount);
 
     {
-        ScopeTimer_s ScopeTimer(L"Clean and sort mesh by attributes " + std::wstring(WavefrontPath));
+        HPCookStageTimer_s StageTimer("Clean and sort mesh by attributes", WavefrontPath);
 
         std::vector<uint32_t> DupedVerts;
 
@@ -149,10 +163,21 @@ bool LoadModelFromWavefront(const std::wstring& SourceDir, const std::wstring& O
         std::swap(OutModel.Indices, IndexReorder);
     }
 
+    std::vector<MeshProcessing::Subset_s> Subsets;
+
     {
-        ScopeTimer_s ScopeTimer(L"Optimise mesh faces " + std::wstring(WavefrontPath));
+        HPCookStageTimer_s StageTimer("Compute mesh subsets", WavefrontPath);
 
-        if (!ENSUREMSG(MeshProcessing::OptimizeFacesLRU(reinterpret_cast<MeshProcessing::index_t*>(OutModel.Indices.data()), TriCount, FaceRemap.data()), "OptimizeFacesLRU failed"))
+        Subsets = MeshProcessing::ComputeSubsets(Attributes.data(), Attributes.size());
+    }
+
+    ReleaseVector(Attributes);
+
+    {
+        HPCookStageTimer_s StageTimer("Optimise mesh faces", WavefrontPath);
+
+        // Per subset, so faces keep to their material
+        if (!ENSUREMSG(MeshProcessing::OptimizeFacesLRU(reinterpret_cast<MeshProcessing::index_t*>(OutModel.Indices.data()), TriCount, Subsets.data(), Subsets.size(), FaceRemap.data()), "OptimizeFacesLRU failed"))
             return false;
 
         if (!ENSUREMSG(MeshProcessing::ReorderIndices(reinterpret_cast<MeshProcessing::index_t*>(OutModel.Indices.data()), TriCount, FaceRemap.data(), reinterpret_cast<MeshProcessing::index_t*>(IndexReorder.data())), "ReorderIndices failed"))
@@ -161,18 +186,20 @@ bool LoadModelFromWavefront(const std::wstring& SourceDir, const std::wstring& O
         std::swap(OutModel.Indices, IndexReorder);
     }
 
+    ReleaseVector(FaceRemap);
+
     std::vector<uint32_t> VertexRemap;
     VertexRemap.resize(OutModel.VertexCount);
 
     {
-        ScopeTimer_s ScopeTimer(L"Optimise mesh vertices " + std::wstring(WavefrontPath));
+        HPCookStageTimer_s StageTimer("Optimise mesh vertices", WavefrontPath);
 
         if (!ENSUREMSG(MeshProcessing::OptimizeVertices(reinterpret_cast<MeshProcessing::index_t*>(OutModel.Indices.data()), TriCount, OutModel.VertexCount, VertexRemap.data()), "OptimizeVertices failed"))
             return false;
     }
 
     {
-        ScopeTimer_s ScopeTimer(L"Finalise mesh buffers " + std::wstring(WavefrontPath));
+        HPCookStageTimer_s StageTimer("Finalise mesh buffers", WavefrontPath);
 
         if (!ENSUREMSG(MeshProcessing::FinalizeIndices(reinterpret_cast<MeshProcessing::index_t*>(OutModel.Indices.data()), TriCount, VertexRemap.data(), OutModel.VertexCount, reinterpret_cast<MeshProcessing::index_t*>(IndexReorder.data())), "FinalizeIndices failed"))
             return false;
@@ -209,13 +236,8 @@ bool LoadModelFromWavefront(const std::wstring& SourceDir, const std::wstring& O
         }
     }
 
-    std::vector<MeshProcessing::Subset_s> Subsets;
-
-    {
-        ScopeTimer_s ScopeTimer(L"Compute mesh subsets " + std::wstring(WavefrontPath));
-
-        Subsets = MeshProcessing::ComputeSubsets(Attributes.data(), Attributes.size());
-    }
+    ReleaseVector(VertexRemap);
+    ReleaseVector(IndexReorder);
 
     std::vector<MeshProcessing::Subset_s> IndexSubsets;
     IndexSubsets.resize(Subsets.size());
@@ -227,7 +249,7 @@ bool LoadModelFromWavefront(const std::wstring& SourceDir, const std::wstring& O
 
     if (!Reader.HasNormals)
     {
-        ScopeTimer_s ScopeTimer(L"Compute mesh normals " + std::wstring(WavefrontPath));
+        HPCookStageTimer_s StageTimer("Compute mesh normals", WavefrontPath);
 
         OutModel.Normals.resize(OutModel.VertexCount);
 
@@ -239,7 +261,7 @@ bool LoadModelFromWavefront(const std::wstring& SourceDir, const std::wstring& O
 
     if (Reader.HasNormals && Reader.HasTexcoords)
     {
-        ScopeTimer_s ScopeTimer(L"Compute mesh tangents " + std::wstring(WavefrontPath));
+        HPCookStageTimer_s StageTimer("Compute mesh tangents", WavefrontPath);
 
         OutModel.Tangents.resize(OutModel.VertexCount);
         OutModel.Bitangents.resize(OutModel.VertexCount);
@@ -256,7 +278,7 @@ bool LoadModelFromWavefront(const std::wstring& SourceDir, const std::wstring& O
     std::vector<MeshProcessing::Subset_s> MeshletSubsets;
 
     {
-        ScopeTimer_s ScopeTimer(L"Meshletize mesh " + std::wstring(WavefrontPath));
+        HPCookStageTimer_s StageTimer("Meshletize mesh", WavefrontPath);
 
         constexpr uint32_t MeshletMaxVerts = 64;
         constexpr uint32_t MeshletMaxPrims = 126;
@@ -277,6 +299,7 @@ bool LoadModelFromWavefront(const std::wstring& SourceDir, const std::wstring& O
     OutModel.PrimitiveIndices.resize(PrimitiveIndices.size());
 
     memcpy(OutModel.PrimitiveIndices.data(), PrimitiveIndices.data(), sizeof(uint32_t) * PrimitiveIndices.size());
+    ReleaseVector(PrimitiveIndices);
 
     bool UsingMaterials = !Reader.Materials.empty();
     if (UsingMaterials)
@@ -323,13 +346,13 @@ static std::wstring GenerateOutputPath(const std::wstring& OutputDir, const std:
     return OutputDir + L"/" + ReplacePathExtension(AssetPath, L"hp_mdl");
 }
 
-void HPModelPipe_c::Cook(const std::wstring& SourceDir, const std::wstring& OutputDir, const HPArgs_t& Args)
+bool HPModelPipe_c::Cook(const std::wstring& SourceDir, const std::wstring& OutputDir, const HPArgs_t& Args)
 {
     std::wstring AssetPath;
     if (!ParseArgs(Args, L"-src", AssetPath))
     {
         LOGERROR("[HPModelPipe] No source path provided for asset");
-        return;
+        return false;
     }
 
     std::wstring AbsSrcPath = SourceDir + L"/" + AssetPath;
@@ -341,13 +364,13 @@ void HPModelPipe_c::Cook(const std::wstring& SourceDir, const std::wstring& Outp
         if (!LoadModelFromWavefront( SourceDir, OutputDir, AbsSrcPath.c_str(), ProcessedModel))
         {
             LOGERROR("[HPModelPipe] Failed to process model");
-            return;
+            return false;
         }
     }
     else
     {
         LOGERROR("[HPModelPipe] Unsupported file extension for source asset [%S]", AssetPath.c_str());
-        return;
+        return false;
     }
 
     std::wstring AssetOutputPath = GenerateOutputPath(OutputDir, AssetPath);
@@ -357,10 +380,25 @@ void HPModelPipe_c::Cook(const std::wstring& SourceDir, const std::wstring& Outp
     if (!ProcessedModel.Serialize(AssetOutputPath, FileStreamMode_e::WRITE))
     {
         LOGERROR("[HPModelPipe] Failed to write asset [%S]", AssetOutputPath.c_str());
-        return;
+        return false;
     }
 
     LOGINFO("[HPModelPipe] Cooked model [%S]", AssetOutputPath.c_str());
+
+    return true;
+}
+
+uint32_t HPModelPipe_c::GetVersion() const
+{
+    // The model format, and the cook revision
+    return (static_cast<uint32_t>(HPModelVersion_e::CURRENT) << 16) | MODEL_COOK_REVISION;
+}
+
+uint64_t HPModelPipe_c::EstimateCookMemory(uint64_t InputBytes) const
+{
+    // The text source is several times smaller than the reader's vertex cache, or than the model's streams with
+    // the remaps and reorder copies beside them
+    return InputBytes * 8;
 }
 
 std::wstring HPModelPipe_c::GetCookedAssetPath(const std::wstring& OutputDir, const HPArgs_t& Args) const
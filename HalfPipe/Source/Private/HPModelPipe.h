@@ -6,7 +6,9 @@ class HPModelPipe_c : public IHPPipe_c
 {
 public:
 	const wchar_t* GetAssetType() const override { return L"Model"; }
-	void Cook(const std::wstring& SourceDir, const std::wstring& OutputDir, const HPArgs_t& Args) override;
+	bool Cook(const std::wstring& SourceDir, const std::wstring& OutputDir, const HPArgs_t& Args) override;
+	uint32_t GetVersion() const override;
+	uint64_t EstimateCookMemory(uint64_t InputBytes) const override;
 	std::wstring GetCookedAssetPath(const std::wstring& OutputDir, const HPArgs_t& Args) const;
 	std::wstring GetPackageAssetPath(const HPArgs_t& Args) const override;
 };
@@ -0,0 +1,257 @@
+#include "HPPackage.h"
+
+#include <FileUtils/FileLoader.h>
+#include <Logging/Logging.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+uint64_t HashPackagePath(std::wstring_view Path)
+{
+	uint64_t Hash = 0xcbf29ce484222325ull; // FNV-1a 64
+	for (wchar_t Char : Path)
+	{
+		if (Char == L'\\')
+		{
+			Char = L'/';
+		}
+		else if (Char >= L'A' && Char <= L'Z')
+		{
+			Char = Char - L'A' + L'a';
+		}
+
+		// Two bytes per character whatever the size of wchar_t, so packages hash the same on every platform
+		Hash ^= static_cast<uint8_t>(Char & 0xFF);
+		Hash *= 0x100000001b3ull;
+		Hash ^= static_cast<uint8_t>((Char >> 8) & 0xFF);
+		Hash *= 0x100000001b3ull;
+	}
+	return Hash;
+}
+
+bool HPPackageDecompress(std::span<const uint8_t> Compressed, std::span<uint8_t> OutData)
+{
+	// Sequences of a token, literals and a match. The token's high nibble is the literal count and the low nibble
+	// the match length less 4, either extended by following bytes when 15. The last sequence has no match.
+	const uint8_t* In = Compressed.data();
+	const uint8_t* const InEnd = In + Compressed.size();
+	uint8_t* Out = OutData.data();
+	uint8_t* const OutEnd = Out + OutData.size();
+
+	auto ReadLength = [&In, InEnd](size_t Length) -> size_t
+	{
+		if (Length != 15)
+			return Length;
+
+		for (;;)
+		{
+			if (In >= InEnd)
+				return SIZE_MAX;
+
+			const uint8_t Byte = *In++;
+			Length += Byte;
+			if (Byte != 255)
+				return Length;
+		}
+	};
+
+	while (In < InEnd)
+	{
+		const uint8_t Token = *In++;
+
+		const size_t LiteralCount = ReadLength(Token >> 4);
+		if (LiteralCount > static_cast<size_t>(InEnd - In) || LiteralCount > static_cast<size_t>(OutEnd - Out))
+			return false;
+
+		memcpy(Out, In, LiteralCount);
+		In += LiteralCount;
+		Out += LiteralCount;
+
+		if (Out == OutEnd)
+			break;
+
+		if (InEnd - In < 2)
+			return false;
+
+		const size_t Distance = In[0] | (In[1] << 8);
+		In += 2;
+
+		const size_t MatchLength = ReadLength(Token & 0xF);
+		if (MatchLength == SIZE_MAX || Distance == 0 || Distance > static_cast<size_t>(Out - OutData.data()) || MatchLength + 4 > static_cast<size_t>(OutEnd - Out))
+			return false;
+
+		// Byte at a time, a match may overlap what it is writing
+		const uint8_t* Match = Out - Distance;
+		for (size_t ByteIt = 0; ByteIt < MatchLength + 4; ByteIt++)
+		{
+			*Out++ = *Match++;
+		}
+	}
+
+	return In == InEnd && Out == OutEnd;
+}
+
+bool HPPackage_c::Open(const std::wstring& Path)
+{
+	Close();
+
+	if (!File.Open(Path))
+		return false;
+
+	const uint8_t* const Data = File.GetData();
+	const size_t Size = File.GetSize();
+
+	const HPPackageHeader_s* const FileHeader = reinterpret_cast<const HPPackageHeader_s*>(Data);
+	if (Size < sizeof(HPPackageHeader_s) || FileHeader->Magic != HPPackageMagic)
+	{
+		LOGERROR("[HPPackage] %S is not a package", Path.c_str());
+		File.Close();
+		return false;
+	}
+
+	if (FileHeader->Version != HPPackageVersion_e::CURRENT)
+	{
+		LOGERROR("[HPPackage] Package %S has version %u, expected %u. Recook it.", Path.c_str(), static_cast<uint32_t>(FileHeader->Version), static_cast<uint32_t>(HPPackageVersion_e::CURRENT));
+		File.Close();
+		return false;
+	}
+
+	if (FileHeader->EntryTableOffset + static_cast<uint64_t>(FileHeader->EntryCount) * sizeof(HPPackageEntry_s) > Size
+		|| FileHeader->StringTableOffset + FileHeader->StringTableSize > Size)
+	{
+		LOGERROR("[HPPackage] Package %S is truncated", Path.c_str());
+		File.Close();
+		return false;
+	}
+
+	const HPPackageEntry_s* const FileEntries = reinterpret_cast<const HPPackageEntry_s*>(Data + FileHeader->EntryTableOffset);
+	for (uint32_t EntryIt = 0; EntryIt < FileHeader->EntryCount; EntryIt++)
+	{
+		const HPPackageEntry_s& Entry = FileEntries[EntryIt];
+		if (Entry.Offset + Entry.StoredSize > Size || static_cast<uint64_t>(Entry.PathOffset) + Entry.PathLength > FileHeader->StringTableSize)
+		{
+			LOGERROR("[HPPackage] Package %S has an entry outside the file", Path.c_str());
+			File.Close();
+			return false;
+		}
+	}
+
+	Header = FileHeader;
+	Entries = FileEntries;
+	Strings = reinterpret_cast<const char*>(Data + Header->StringTableOffset);
+	PackagePath = Path;
+
+	return true;
+}
+
+void HPPackage_c::Close()
+{
+	File.Close();
+	PackagePath.clear();
+
+	Header = nullptr;
+	Entries = nullptr;
+	Strings = nullptr;
+}
+
+std::span<const HPPackageEntry_s> HPPackage_c::GetEntries() const noexcept
+{
+	if (!Header)
+		return {};
+
+	return { Entries, Header->EntryCount };
+}
+
+std::string_view HPPackage_c::GetEntryPath(const HPPackageEntry_s& Entry) const noexcept
+{
+	return { Strings + Entry.PathOffset, Entry.PathLength };
+}
+
+const HPPackageEntry_s* HPPackage_c::FindEntry(std::wstring_view AssetPath) const noexcept
+{
+	const std::span<const HPPackageEntry_s> Sorted = GetEntries();
+	const uint64_t PathHash = HashPackagePath(AssetPath);
+
+	auto It = std::lower_bound(Sorted.begin(), Sorted.end(), PathHash, [](const HPPackageEntry_s& Entry, uint64_t Hash) { return Entry.PathHash < Hash; });
+	if (It == Sorted.end() || It->PathHash != PathHash)
+		return nullptr;
+
+	return &*It;
+}
+
+std::span<const uint8_t> HPPackage_c::GetStoredBytes(const HPPackageEntry_s& Entry) const noexcept
+{
+	return { File.GetData() + Entry.Offset, static_cast<size_t>(Entry.StoredSize) };
+}
+
+bool HPAssetReader_c::MountPackage(const std::wstring& PackagePath)
+{
+	std::unique_ptr<HPPackage_c> Package = std::make_unique<HPPackage_c>();
+	if (!Package->Open(PackagePath))
+		return false;
+
+	LOGINFO("[HPAssetReader] Mounted %S, %u assets", PackagePath.c_str(), static_cast<uint32_t>(Package->GetEntries().size()));
+	Packages.push_back(std::move(Package));
+	return true;
+}
+
+uint32_t HPAssetReader_c::MountPackagesInDir(const std::wstring& Dir)
+{
+	std::vector<std::filesystem::path> PackagePaths;
+
+	std::error_code Error;
+	for (const std::filesystem::directory_entry& Entry : std::filesystem::directory_iterator(Dir, Error))
+	{
+		if (Entry.is_regular_file() && Entry.path().extension() == L".hp_pak")
+		{
+			PackagePaths.push_back(Entry.path());
+		}
+	}
+	std::sort(PackagePaths.begin(), PackagePaths.end());
+
+	uint32_t MountCount = 0;
+	for (const std::filesystem::path& PackagePath : PackagePaths)
+	{
+		MountCount += MountPackage(PackagePath.wstring()) ? 1 : 0;
+	}
+	return MountCount;
+}
+
+bool HPAssetReader_c::Load(const std::wstring& AssetPath, HPAssetBytes_s& OutAsset) const
+{
+	for (const std::unique_ptr<HPPackage_c>& Package : Packages)
+	{
+		const HPPackageEntry_s* Entry = Package->FindEntry(AssetPath);
+		if (!Entry)
+			continue;
+
+		OutAsset.FromPackage = true;
+
+		if (Entry->Compression == HPPackageCompression_e::NONE)
+		{
+			OutAsset.Owned.clear();
+			OutAsset.Bytes = Package->GetStoredBytes(*Entry);
+			return true;
+		}
+
+		OutAsset.Owned.resize(static_cast<size_t>(Entry->Size));
+		if (Entry->Compression != HPPackageCompression_e::LZ || !HPPackageDecompress(Package->GetStoredBytes(*Entry), OutAsset.Owned))
+		{
+			LOGERROR("[HPAssetReader] %S in package %S failed to decompress", AssetPath.c_str(), Package->GetPath().c_str());
+			return false;
+		}
+
+		OutAsset.Bytes = OutAsset.Owned;
+		return true;
+	}
+
+	File_s Loose = LoadBinaryFile((LooseDir + AssetPath).c_str());
+	if (!Loose.Loaded())
+		return false;
+
+	OutAsset.FromPackage = false;
+	OutAsset.Owned = std::move(Loose.Bytes);
+	OutAsset.Bytes = OutAsset.Owned;
+	return true;
+}
@@ -0,0 +1,229 @@
+#include "HPPackageWriter.h"
+
+#include "HPPackage.h"
+
+#include <FileUtils/FileLoader.h>
+#include <Logging/Logging.h>
+#include <StringUtils/StringUtils.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+
+constexpr size_t MinMatch = 4;
+constexpr size_t MaxDistance = 65535;
+constexpr uint32_t HashBits = 16;
+
+uint32_t HashSequence(const uint8_t* Data)
+{
+	uint32_t Sequence;
+	memcpy(&Sequence, Data, sizeof(Sequence));
+	return (Sequence * 2654435761u) >> (32 - HashBits);
+}
+
+void WriteLength(std::vector<uint8_t>& Out, size_t Length)
+{
+	for (; Length >= 255; Length -= 255)
+	{
+		Out.push_back(255);
+	}
+	Out.push_back(static_cast<uint8_t>(Length));
+}
+
+void WriteSequence(std::vector<uint8_t>& Out, const uint8_t* Literals, size_t LiteralCount, size_t Distance, size_t MatchLength)
+{
+	const size_t MatchCode = MatchLength ? MatchLength - MinMatch : 0;
+	Out.push_back(static_cast<uint8_t>((std::min<size_t>(LiteralCount, 15) << 4) | std::min<size_t>(MatchCode, 15)));
+
+	if (LiteralCount >= 15)
+	{
+		WriteLength(Out, LiteralCount - 15);
+	}
+	Out.insert(Out.end(), Literals, Literals + LiteralCount);
+
+	// The last sequence is literals only
+	if (!MatchLength)
+		return;
+
+	Out.push_back(static_cast<uint8_t>(Distance & 0xFF));
+	Out.push_back(static_cast<uint8_t>(Distance >> 8));
+
+	if (MatchCode >= 15)
+	{
+		WriteLength(Out, MatchCode - 15);
+	}
+}
+
+}
+
+void HPPackageCompress(std::span<const uint8_t> Data, std::vector<uint8_t>& OutCompressed)
+{
+	OutCompressed.clear();
+	OutCompressed.reserve(Data.size() / 2 + 16);
+
+	const uint8_t* const Begin = Data.data();
+	const size_t Size = Data.size();
+
+	// Last position each hashed 4 bytes were seen at, plus one so zero is empty
+	std::vector<uint32_t> Table(size_t(1) << HashBits, 0);
+
+	size_t LiteralStart = 0;
+	size_t Pos = 0;
+	while (Pos + MinMatch <= Size)
+	{
+		const uint32_t Hash = HashSequence(Begin + Pos);
+		const size_t Candidate = Table[Hash];
+		Table[Hash] = static_cast<uint32_t>(Pos + 1);
+
+		if (Candidate == 0 || Pos - (Candidate - 1) > MaxDistance || memcmp(Begin + Candidate - 1, Begin + Pos, MinMatch) != 0)
+		{
+			Pos++;
+			continue;
+		}
+
+		const size_t MatchStart = Candidate - 1;
+		size_t MatchLength = MinMatch;
+		while (Pos + MatchLength < Size && Begin[MatchStart + MatchLength] == Begin[Pos + MatchLength])
+		{
+			MatchLength++;
+		}
+
+		WriteSequence(OutCompressed, Begin + LiteralStart, Pos - LiteralStart, Pos - MatchStart, MatchLength);
+
+		Pos += MatchLength;
+		LiteralStart = Pos;
+	}
+
+	WriteSequence(OutCompressed, Begin + LiteralStart, Size - LiteralStart, 0, 0);
+}
+
+bool WritePackage(const std::wstring& PackagePath, const std::wstring& OutputDir, const std::vector<std::wstring>& AssetPaths, bool Compress)
+{
+	struct PendingEntry_s
+	{
+		HPPackageEntry_s Entry = {};
+		std::string Path;
+		std::vector<uint8_t> Bytes;
+	};
+
+	std::vector<PendingEntry_s> Pending;
+	Pending.reserve(AssetPaths.size());
+
+	uint64_t TotalSize = 0;
+	for (const std::wstring& AssetPath : AssetPaths)
+	{
+		File_s Loaded = LoadBinaryFile((OutputDir + L"/" + AssetPath).c_str());
+		if (!Loaded.Loaded())
+		{
+			LOGWARNING("[HPPackage] %S was not cooked and is left out of %S", AssetPath.c_str(), PackagePath.c_str());
+			continue;
+		}
+
+		PendingEntry_s& Asset = Pending.emplace_back();
+		Asset.Path = WideToNarrow(AssetPath);
+		Asset.Entry.PathHash = HashPackagePath(AssetPath);
+		Asset.Entry.Size = Loaded.GetSize();
+		Asset.Entry.Compression = HPPackageCompression_e::NONE;
+		Asset.Bytes = std::move(Loaded.Bytes);
+		TotalSize += Asset.Entry.Size;
+
+		if (Compress)
+		{
+			std::vector<uint8_t> Compressed;
+			HPPackageCompress(Asset.Bytes, Compressed);
+			if (Compressed.size() <= Asset.Bytes.size() - Asset.Bytes.size() / 8)
+			{
+				Asset.Entry.Compression = HPPackageCompression_e::LZ;
+				Asset.Bytes = std::move(Compressed);
+			}
+		}
+		Asset.Entry.StoredSize = Asset.Bytes.size();
+	}
+
+	std::sort(Pending.begin(), Pending.end(), [](const PendingEntry_s& A, const PendingEntry_s& B) { return A.Entry.PathHash < B.Entry.PathHash; });
+
+	for (size_t EntryIt = 1; EntryIt < Pending.size(); EntryIt++)
+	{
+		if (Pending[EntryIt].Entry.PathHash == Pending[EntryIt - 1].Entry.PathHash)
+		{
+			LOGERROR("[HPPackage] %s and %s hash the same, %S can not hold both", Pending[EntryIt - 1].Path.c_str(), Pending[EntryIt].Path.c_str(), PackagePath.c_str());
+			return false;
+		}
+	}
+
+	auto Align = [](uint64_t Offset) { return (Offset + HPPackageAlignment - 1) & ~(HPPackageAlignment - 1); };
+
+	HPPackageHeader_s Header;
+	Header.EntryCount = static_cast<uint32_t>(Pending.size());
+
+	std::string StringTable;
+	uint64_t Offset = HPPackageAlignment;
+	for (PendingEntry_s& Asset : Pending)
+	{
+		Asset.Entry.Offset = Offset;
+		Asset.Entry.PathOffset = static_cast<uint32_t>(StringTable.size());
+		Asset.Entry.PathLength = static_cast<uint32_t>(Asset.Path.size());
+		StringTable += Asset.Path;
+
+		Offset = Align(Offset + Asset.Entry.StoredSize);
+	}
+
+	Header.EntryTableOffset = Offset;
+	Header.StringTableOffset = Offset + Pending.size() * sizeof(HPPackageEntry_s);
+	Header.StringTableSize = static_cast<uint32_t>(StringTable.size());
+
+	// Written aside and moved over the old one, so a running game never maps half a package
+	const std::wstring TempPath = PackagePath + L".tmp";
+	{
+		std::ofstream Stream(std::filesystem::path(TempPath), std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!Stream.is_open())
+		{
+			LOGERROR("[HPPackage] Failed to write package %S", TempPath.c_str());
+			return false;
+		}
+
+		const std::vector<char> Zeros(HPPackageAlignment, 0);
+		auto PadTo = [&Stream, &Zeros](uint64_t Target)
+		{
+			const uint64_t Position = static_cast<uint64_t>(Stream.tellp());
+			Stream.write(Zeros.data(), static_cast<std::streamsize>(Target - Position));
+		};
+
+		Stream.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+		for (const PendingEntry_s& Asset : Pending)
+		{
+			PadTo(Asset.Entry.Offset);
+			Stream.write(reinterpret_cast<const char*>(Asset.Bytes.data()), static_cast<std::streamsize>(Asset.Bytes.size()));
+		}
+		PadTo(Header.EntryTableOffset);
+
+		for (const PendingEntry_s& Asset : Pending)
+		{
+			Stream.write(reinterpret_cast<const char*>(&Asset.Entry), sizeof(Asset.Entry));
+		}
+		Stream.write(StringTable.data(), static_cast<std::streamsize>(StringTable.size()));
+
+		if (!Stream)
+		{
+			LOGERROR("[HPPackage] Failed writing package %S", TempPath.c_str());
+			return false;
+		}
+	}
+
+	std::error_code Error;
+	std::filesystem::rename(TempPath, PackagePath, Error);
+	if (Error)
+	{
+		LOGERROR("[HPPackage] Failed to replace package %S: %s", PackagePath.c_str(), Error.message().c_str());
+		return false;
+	}
+
+	const uint64_t PackageSize = Header.StringTableOffset + Header.StringTableSize;
+	LOGINFO("[HPPackage] Wrote %S, %u assets, %.2f MB of assets in %.2f MB", PackagePath.c_str(), Header.EntryCount, TotalSize / (1024.0 * 1024.0), PackageSize / (1024.0 * 1024.0));
+
+	return true;
+}
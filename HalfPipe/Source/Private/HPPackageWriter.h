@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// LZ4 style block of Data, read back by HPPackageDecompress
+void HPPackageCompress(std::span<const uint8_t> Data, std::vector<uint8_t>& OutCompressed);
+
+// Packs the cooked assets at AssetPaths, relative to OutputDir, into a .hp_pak at PackagePath. With Compress each
+// asset is stored compressed when that saves at least an eighth of it, otherwise as is so it can be mapped.
+bool WritePackage(const std::wstring& PackagePath, const std::wstring& OutputDir, const std::vector<std::wstring>& AssetPaths, bool Compress);
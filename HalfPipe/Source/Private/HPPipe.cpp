@@ -1,22 +1,68 @@
 #include "HPPipe.h"
 
+#include "HPCookHistory.h"
+#include "HPCookManifest.h"
+#include "HPCookScheduler.h"
+#include "HPLevelPipe.h"
 #include "HPModelPipe.h"
+#include "HPPackageWriter.h"
 #include "HPTexturePipe.h"
 #include "HPWfMtlLibPipe.h"
 
 #include <Logging/Logging.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cwctype>
+#include <filesystem>
 #include <map>
-#include <queue>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// The first command to claim an output, later commands for it are checked against it
+struct HPCookRequest_s
+{
+	std::wstring AssetType;
+	std::wstring Settings;
+	HPArgs_t Args;
+};
 
 struct HPPipeGlobals_s
 {
 	std::map<std::wstring, IHPPipe_c*> Pipes;
 
-	std::queue<HPAssetArgs_s> CookCommands;
-	uint32_t CookCount = 0;
+	// Pushed before the cook starts, handed to the scheduler once it does
+	std::vector<HPAssetArgs_s> CookCommands;
+	HPCookScheduler_c* Scheduler = nullptr;
+
+	std::atomic<uint32_t> CookCount = 0;
+
+	// Keyed by normalized package path, cleared once the cook ends
+	std::mutex RequestsMutex;
+	std::unordered_map<std::wstring, HPCookRequest_s> Requests;
+	uint32_t CoalescedCount = 0;
+	uint32_t ConflictCount = 0;
 } G;
 
+// Resident memory a cook added at its peak against what it was estimated to need
+struct HPCookMemoryPeak_s
+{
+	std::wstring Key;
+	uint64_t PeakGrowth = 0;
+	uint64_t Estimate = 0;
+};
+
+// Collects the commands pushed by the cook running on this thread, recorded in the manifest as its dependencies
+thread_local std::vector<HPAssetArgs_s>* CurrentDependencies = nullptr;
+
+// Collects the extra files written by the cook running on this thread, recorded in the manifest as its outputs
+thread_local std::vector<std::wstring>* CurrentOutputs = nullptr;
+
 template<class Pipe_t>
 void RegisterPipe()
 {
@@ -35,6 +81,7 @@ void InitPipes()
 	RegisterPipe<HPModelPipe_c>();
 	RegisterPipe<HPWfMtlLibPipe_c>();
 	RegisterPipe<HPTexturePipe_c>();
+	RegisterPipe<HPLevelPipe_c>();
 }
 
 IHPPipe_c* GetPipeForAsset(const wchar_t* AssetType)
@@ -73,29 +120,353 @@ std::wstring GetPackagePathForAssetFromArgs(const HPAssetArgs_s& AssetArgs)
 	return {};
 }
 
+std::wstring NormalizeCookPath(const std::wstring& Path)
+{
+	std::wstring Normalized = std::filesystem::path(Path).lexically_normal().generic_wstring();
+
+#if defined(_WIN32)
+	// Same file on a case insensitive file system
+	std::transform(Normalized.begin(), Normalized.end(), Normalized.begin(), [](wchar_t Char) { return static_cast<wchar_t>(std::towlower(Char)); });
+#endif
+
+	return Normalized;
+}
+
+namespace
+{
+
+// Every argument pair, sorted so the order they were given in does not matter. The source is normalized so
+// different spellings of one file match, while different files mapping to the same output do not.
+std::wstring GetCookSettings(const HPArgs_t& Args)
+{
+	std::vector<std::pair<std::wstring, std::wstring>> Pairs;
+	for (size_t ArgIt = 0; ArgIt < Args.size(); ArgIt += 2)
+	{
+		std::wstring Value = ArgIt + 1 < Args.size() ? Args[ArgIt + 1] : std::wstring();
+		if (Args[ArgIt] == L"-src")
+		{
+			Value = NormalizeCookPath(Value);
+		}
+
+		Pairs.emplace_back(Args[ArgIt], std::move(Value));
+	}
+	std::sort(Pairs.begin(), Pairs.end());
+
+	std::wstring Settings;
+	for (const auto& [Command, Value] : Pairs)
+	{
+		Settings += Command + L" " + Value + L" ";
+	}
+	return Settings;
+}
+
+std::wstring JoinArgs(const HPArgs_t& Args)
+{
+	std::wstring Joined;
+	for (const std::wstring& Arg : Args)
+	{
+		Joined += Joined.empty() ? Arg : L" " + Arg;
+	}
+	return Joined;
+}
+
+// False if an earlier command already cooks the same output
+bool ClaimCookOutput(const HPAssetArgs_s& Args)
+{
+	IHPPipe_c* Pipe = GetPipeForAsset(Args.AssetType.c_str());
+	if (!Pipe)
+		return false;
+
+	// Left to fail in the cook, where the pipe reports it
+	const std::wstring Key = NormalizeCookPath(Pipe->GetPackageAssetPath(Args.Args));
+	if (Key.empty())
+		return true;
+
+	HPCookRequest_s Request;
+	Request.AssetType = Args.AssetType;
+	Request.Settings = GetCookSettings(Args.Args);
+
+	std::lock_guard Lock(G.RequestsMutex);
+
+	auto [It, Inserted] = G.Requests.try_emplace(Key);
+	if (Inserted)
+	{
+		Request.Args = Args.Args;
+		It->second = std::move(Request);
+		return true;
+	}
+
+	const HPCookRequest_s& Claimed = It->second;
+	if (Claimed.AssetType == Request.AssetType && Claimed.Settings == Request.Settings)
+	{
+		G.CoalescedCount++;
+		return false;
+	}
+
+	LOGERROR("PushCookCommand - Conflicting cooks of %S, keeping [%S %S] and dropping [%S %S]", Key.c_str(),
+		Claimed.AssetType.c_str(), JoinArgs(Claimed.Args).c_str(), Args.AssetType.c_str(), JoinArgs(Args.Args).c_str());
+	G.ConflictCount++;
+	return false;
+}
+
+// Outputs the last cook of an asset wrote that this one did not, like the cells of a level that shrank
+void DeleteStaleOutputs(const std::wstring& OutputDir, const std::vector<std::wstring>& PreviousOutputs, const std::vector<std::wstring>& Outputs)
+{
+	std::unordered_set<std::wstring> Written;
+	for (const std::wstring& Output : Outputs)
+	{
+		Written.insert(NormalizeCookPath(Output));
+	}
+
+	for (const std::wstring& PreviousOutput : PreviousOutputs)
+	{
+		if (Written.contains(NormalizeCookPath(PreviousOutput)))
+			continue;
+
+		std::error_code Error;
+		if (std::filesystem::remove(std::filesystem::path(OutputDir) / PreviousOutput, Error))
+		{
+			LOGINFO("ProcessCookCommands - Deleted stale output %S", PreviousOutput.c_str());
+		}
+		else if (Error)
+		{
+			LOGWARNING("ProcessCookCommands - Failed to delete stale output %S: %s", PreviousOutput.c_str(), Error.message().c_str());
+		}
+	}
+}
+
+}
+
 void PushCookCommand(const HPAssetArgs_s& Args)
 {
-	G.CookCommands.push(Args);
+	// Recorded even when coalesced, the asset still depends on it
+	if (CurrentDependencies)
+	{
+		CurrentDependencies->push_back(Args);
+	}
+
+	if (!ClaimCookOutput(Args))
+		return;
+
+	if (G.Scheduler)
+	{
+		G.Scheduler->Push(Args);
+		return;
+	}
+
+	G.CookCommands.push_back(Args);
+}
+
+void RecordCookOutput(const std::wstring& OutputPath)
+{
+	if (CurrentOutputs)
+	{
+		CurrentOutputs->push_back(OutputPath);
+	}
 }
 
-void ProcessCookCommands(const std::wstring& SourceDir, const std::wstring& OutputDir)
+void ProcessCookCommands(const std::wstring& SourceDir, const std::wstring& OutputDir, const HPCookSettings_s& Settings)
 {
+	HPCookScheduler_c Scheduler(Settings.ThreadCount, Settings.MemoryBudget);
+
+	for (HPAssetArgs_s& Args : G.CookCommands)
+	{
+		Scheduler.Push(std::move(Args));
+	}
+	G.CookCommands.clear();
+
+	HPCookManifest_c Manifest;
+	Manifest.Load(OutputDir);
+
+	HPCookHistory_c History;
+	History.Load(OutputDir);
+
+	std::atomic<uint32_t> SkippedCount = 0;
+	std::atomic<uint32_t> FailedCount = 0;
+
+	std::mutex MemoryPeaksMutex;
+	std::vector<HPCookMemoryPeak_s> MemoryPeaks;
+
 	G.CookCount = 0;
-	while (!G.CookCommands.empty())
+	G.Scheduler = &Scheduler;
+
+	Scheduler.Run([&](const HPAssetArgs_s& Args)
 	{
-		LOGINFO("ProcessCookCommands - Cooked %d - Remain %d", G.CookCount, static_cast<uint32_t>(G.CookCommands.size()));
+		// An unknown asset type is logged by GetPipeForAsset and skipped, the rest of the cook carries on
+		IHPPipe_c* Pipe = GetPipeForAsset(Args.AssetType.c_str());
+		if (!Pipe)
+			return;
+
+		const std::wstring Key = NormalizeCookPath(Pipe->GetPackageAssetPath(Args.Args));
+
+		if (Settings.Incremental)
+		{
+			std::vector<HPAssetArgs_s> Dependencies;
+			const std::string Reason = Manifest.CheckUpToDate(Key, Args, Pipe->GetVersion(), SourceDir, Pipe->GetCookedAssetPath(OutputDir, Args.Args), Dependencies);
+			if (Reason.empty())
+			{
+				// Its dependencies may have changed even though it has not
+				for (const HPAssetArgs_s& Dependency : Dependencies)
+				{
+					PushCookCommand(Dependency);
+				}
+
+				SkippedCount++;
+				return;
+			}
+
+			LOGINFO("ProcessCookCommands - Cooking %S, %s", Key.c_str(), Reason.c_str());
+		}
+
+		// Admitted once it is known to need cooking, up to date assets never wait on memory
+		std::vector<std::wstring> SourcePaths;
+		Pipe->GetSourcePaths(SourceDir, Args.Args, SourcePaths);
+
+		uint64_t SourceBytes = 0;
+		for (const std::wstring& SourcePath : SourcePaths)
+		{
+			std::error_code Error;
+			const uint64_t SourceSize = std::filesystem::file_size(std::filesystem::path(SourceDir) / SourcePath, Error);
+			SourceBytes += Error ? 0 : SourceSize;
+		}
+
+		std::optional<HPCookMemoryGrant_c> MemoryGrant(std::in_place, Scheduler, Pipe->EstimateCookMemory(SourceBytes));
+
+		HPCookManifest_c::Entry_s Entry;
+		Entry.AssetType = Args.AssetType;
+		Entry.PipeVersion = Pipe->GetVersion();
+		Entry.ArgsHash = HPCookManifest_c::HashArgs(Args);
+
+		HPCookHistory_c::Record_s CookRecord;
+		CookRecord.AssetType = Args.AssetType;
+
+		CurrentDependencies = &Entry.Dependencies;
+		CurrentOutputs = &Entry.Outputs;
+		HPCookHistory_c::SetThreadRecord(&CookRecord);
+
+		const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+		const bool Cooked = Pipe->Cook(SourceDir, OutputDir, Args.Args);
+		CookRecord.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+		HPCookHistory_c::SetThreadRecord(nullptr);
+		CurrentOutputs = nullptr;
+		CurrentDependencies = nullptr;
+
+		const uint64_t PeakGrowth = MemoryGrant->GetPeakGrowth();
+		{
+			std::lock_guard Lock(MemoryPeaksMutex);
+			MemoryPeaks.push_back({ Key, PeakGrowth, MemoryGrant->GetEstimate() });
+		}
+		MemoryGrant.reset();
+
+		if (!Cooked)
+		{
+			Manifest.Remove(Key);
+			FailedCount++;
+			return;
+		}
+
+		HPCookManifest_c::Entry_s PreviousEntry;
+		if (Manifest.GetEntry(Key, PreviousEntry))
+		{
+			DeleteStaleOutputs(OutputDir, PreviousEntry.Outputs, Entry.Outputs);
+		}
 
-		if (IHPPipe_c* Pipe = GetPipeForAsset(G.CookCommands.front().AssetType.c_str()))
+		// Stamped after the cook, a source edited mid cook is caught by the next one at worst a cook late
+		bool SourcesStamped = true;
+		for (const std::wstring& SourcePath : SourcePaths)
 		{
-			Pipe->Cook(SourceDir, OutputDir, G.CookCommands.front().Args);
+			if (!HPCookManifest_c::StampSource(SourceDir, SourcePath, Entry.Sources.emplace_back()))
+			{
+				LOGWARNING("ProcessCookCommands - Could not read source %S of %S, it will cook again next time", SourcePath.c_str(), Key.c_str());
+				Entry.Sources.pop_back();
+				SourcesStamped = false;
+				continue;
+			}
+
+			CookRecord.InputBytes += Entry.Sources.back().Size;
+		}
+
+		std::error_code Error;
+		CookRecord.OutputBytes = std::filesystem::file_size(Pipe->GetCookedAssetPath(OutputDir, Args.Args), Error);
+		if (Error)
+		{
+			CookRecord.OutputBytes = 0;
+		}
+		History.Record(Key, std::move(CookRecord));
 
-			G.CookCount++;
+		// Left out of the manifest, an entry missing a source would read as up to date
+		if (SourcesStamped)
+		{
+			Manifest.Record(Key, std::move(Entry));
 		}
 		else
 		{
-			break;
+			Manifest.Remove(Key);
+		}
+
+		LOGINFO("ProcessCookCommands - Cooked %u, %S peaked at %.1f MB", G.CookCount.fetch_add(1) + 1, Key.c_str(), PeakGrowth / (1024.0 * 1024.0));
+	});
+
+	G.Scheduler = nullptr;
+
+	Manifest.Save();
+	History.Save();
+
+	if (!Settings.PackagePath.empty())
+	{
+		// Up to date outputs too, the package holds the whole cook. Along with each cooked asset go the other files
+		// the manifest has its cook writing, like a partitioned level's cells.
+		std::vector<std::wstring> Outputs;
+		Outputs.reserve(G.Requests.size());
+		for (const auto& [Key, Request] : G.Requests)
+		{
+			Outputs.push_back(Key);
+
+			HPCookManifest_c::Entry_s Entry;
+			if (Manifest.GetEntry(Key, Entry))
+			{
+				Outputs.insert(Outputs.end(), Entry.Outputs.begin(), Entry.Outputs.end());
+			}
 		}
-		G.CookCommands.pop();
+
+		WritePackage(Settings.PackagePath, OutputDir, Outputs, Settings.CompressPackage);
+	}
+
+	Scheduler.LogSummary();
+	LOGINFO("ProcessCookCommands - %u cooked, %u up to date, %u failed, %u redundant cooks avoided", G.CookCount.load(), SkippedCount.load(), FailedCount.load(), G.CoalescedCount);
+
+	// The heaviest cooks, and how far off their estimates were
+	constexpr size_t MemoryPeakLogCount = 10;
+	const size_t LoggedPeakCount = std::min(MemoryPeaks.size(), MemoryPeakLogCount);
+	std::partial_sort(MemoryPeaks.begin(), MemoryPeaks.begin() + LoggedPeakCount, MemoryPeaks.end(),
+		[](const HPCookMemoryPeak_s& A, const HPCookMemoryPeak_s& B) { return A.PeakGrowth > B.PeakGrowth; });
+	if (LoggedPeakCount > 0)
+	{
+		LOGINFO("ProcessCookCommands - Heaviest cooks by resident memory added, which counts cooks running alongside them");
+	}
+	for (size_t PeakIt = 0; PeakIt < LoggedPeakCount; PeakIt++)
+	{
+		const HPCookMemoryPeak_s& Peak = MemoryPeaks[PeakIt];
+		LOGINFO("ProcessCookCommands -   %S peaked at %.1f MB, estimated %.1f MB", Peak.Key.c_str(), Peak.PeakGrowth / (1024.0 * 1024.0), Peak.Estimate / (1024.0 * 1024.0));
+	}
+
+	if (G.ConflictCount > 0)
+	{
+		LOGERROR("ProcessCookCommands - %u cooks dropped for conflicting with another cook of the same output", G.ConflictCount);
+	}
+
+	G.Requests.clear();
+	G.CoalescedCount = 0;
+	G.ConflictCount = 0;
+}
+
+void IHPPipe_c::GetSourcePaths(const std::wstring& SourceDir, const HPArgs_t& Args, std::vector<std::wstring>& OutPaths) const
+{
+	std::wstring AssetPath;
+	if (ParseArgs(Args, L"-src", AssetPath) && !AssetPath.empty())
+	{
+		OutPaths.push_back(AssetPath);
 	}
 }
 
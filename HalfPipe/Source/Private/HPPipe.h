@@ -2,17 +2,29 @@
 
 #include "HalfPipe.h"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
-// TODO rather than exporting with cook we should gather all cooked assets and write in one pass to ensure there
-// are no conflicts on output. For now I will just be careful with my asset set ups until it inevitably catches me out
-
 class IHPPipe_c
 {
 public:
 	virtual const wchar_t* GetAssetType() const = 0;
-	virtual void Cook(const std::wstring& SourceDir, const std::wstring& OutputDir, const HPArgs_t& Args) = 0;
+
+	// False if the asset failed to cook. Called from several threads at once.
+	virtual bool Cook(const std::wstring& SourceDir, const std::wstring& OutputDir, const HPArgs_t& Args) = 0;
+
+	// Changes whenever the same source would cook differently, usually the cooked format's version.
+	// Incremental cooks redo every asset of the pipe when it does.
+	virtual uint32_t GetVersion() const = 0;
+
+	// Source files the cook reads, relative to the source dir. Incremental cooks redo the asset when one changes.
+	virtual void GetSourcePaths(const std::wstring& SourceDir, const HPArgs_t& Args, std::vector<std::wstring>& OutPaths) const;
+
+	// Most memory the cook is expected to need for sources totalling InputBytes, the scheduler admits cooks so their
+	// estimates stay under the memory budget. Compare against the peaks in the cook summary when changing one.
+	virtual uint64_t EstimateCookMemory(uint64_t InputBytes) const { return InputBytes * 2; }
+
 	virtual std::wstring GetCookedAssetPath(const std::wstring& OutputDir, const HPArgs_t& Args) const = 0;
 	virtual std::wstring GetPackageAssetPath(const HPArgs_t& Args) const = 0;
 
@@ -26,5 +38,14 @@ IHPPipe_c* GetPipeForAsset(const wchar_t* AssetType);
 std::wstring GetCookedPathForAssetFromArgs(const std::wstring& OutputDir, const HPAssetArgs_s& AssetArgs);
 std::wstring GetPackagePathForAssetFromArgs(const HPAssetArgs_s& AssetArgs);
 
+// Lexically normal with forward slashes, and lower case on Windows, so two spellings of a path compare equal
+std::wstring NormalizeCookPath(const std::wstring& Path);
+
+// Safe to call from inside a cook, the command joins the running cook. A command for an output already pushed this
+// cook is coalesced into the earlier one, or dropped with an error if its asset type or arguments differ.
 void PushCookCommand(const HPAssetArgs_s& Args);
-void ProcessCookCommands(const std::wstring& SourceDir, const std::wstring& OutputDir);
+
+// Called from inside a cook for each file it writes besides its cooked asset, relative to the output dir. Recorded
+// in the manifest, so the file is packaged with the asset and deleted once a later cook of it no longer writes it.
+void RecordCookOutput(const std::wstring& OutputPath);
+void ProcessCookCommands(const std::wstring& SourceDir, const std::wstring& OutputDir, const HPCookSettings_s& Settings);
@@ -0,0 +1,239 @@
+#include "HPSourceWatcher.h"
+
+#include <Logging/Logging.h>
+#include <StringUtils/StringUtils.h>
+
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+HPSourceWatcher_c::~HPSourceWatcher_c()
+{
+	Stop();
+}
+
+void HPSourceWatcher_c::SetPolledSources(const std::vector<std::wstring>& Paths)
+{
+#if defined(__linux__)
+	if (NotifyHandle >= 0)
+		return;
+#endif
+
+	std::unordered_map<std::wstring, Stamp_s> NewPolled;
+	NewPolled.reserve(Paths.size());
+
+	for (const std::wstring& Path : Paths)
+	{
+		auto It = Polled.find(Path);
+		NewPolled[Path] = It != Polled.end() ? It->second : StampSource(SourceDir + L"/" + Path);
+	}
+
+	Polled = std::move(NewPolled);
+}
+
+bool HPSourceWatcher_c::TakeOverflow()
+{
+	const bool WasOverflow = Overflow;
+	Overflow = false;
+	return WasOverflow;
+}
+
+HPSourceWatcher_c::Stamp_s HPSourceWatcher_c::StampSource(const std::wstring& FullPath)
+{
+	Stamp_s Stamp;
+
+	std::error_code Error;
+	Stamp.Size = std::filesystem::file_size(FullPath, Error);
+	if (Error)
+		return {};
+
+	Stamp.WriteTime = std::filesystem::last_write_time(FullPath, Error).time_since_epoch().count();
+	if (Error)
+		return {};
+
+	Stamp.Exists = true;
+	return Stamp;
+}
+
+bool HPSourceWatcher_c::Poll(uint32_t TimeoutMs, std::vector<std::wstring>& OutChanged)
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(TimeoutMs));
+
+	bool Changed = false;
+	for (auto& [Path, Stamp] : Polled)
+	{
+		const Stamp_s Current = StampSource(SourceDir + L"/" + Path);
+		if (Current.Exists == Stamp.Exists && Current.Size == Stamp.Size && Current.WriteTime == Stamp.WriteTime)
+			continue;
+
+		Stamp = Current;
+		OutChanged.push_back(Path);
+		Changed = true;
+	}
+
+	return Changed;
+}
+
+#if defined(__linux__)
+
+namespace
+{
+
+// Written or moved into place, editors that save to a temporary file and rename it over the source only send the move
+constexpr uint32_t WatchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+
+}
+
+bool HPSourceWatcher_c::Start(const std::wstring& InSourceDir)
+{
+	Stop();
+
+	SourceDir = InSourceDir;
+
+	NotifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (NotifyHandle < 0)
+	{
+		LOGWARNING("[HPSourceWatcher] inotify unavailable, polling %S instead", SourceDir.c_str());
+		return true;
+	}
+
+	WatchDirectory({});
+	LOGINFO("[HPSourceWatcher] Watching %u directories under %S", static_cast<uint32_t>(WatchedDirs.size()), SourceDir.c_str());
+
+	return true;
+}
+
+void HPSourceWatcher_c::Stop()
+{
+	if (NotifyHandle >= 0)
+	{
+		close(NotifyHandle);
+		NotifyHandle = -1;
+	}
+
+	WatchedDirs.clear();
+}
+
+void HPSourceWatcher_c::WatchDirectory(const std::wstring& RelativeDir)
+{
+	const std::wstring FullDir = RelativeDir.empty() ? SourceDir : SourceDir + L"/" + RelativeDir;
+
+	const int Watch = inotify_add_watch(NotifyHandle, WideToNarrow(FullDir).c_str(), WatchMask);
+	if (Watch < 0)
+	{
+		LOGWARNING("[HPSourceWatcher] Failed to watch %S, errno %d", FullDir.c_str(), errno);
+		return;
+	}
+	WatchedDirs[Watch] = RelativeDir;
+
+	std::error_code Error;
+	for (const std::filesystem::directory_entry& Entry : std::filesystem::directory_iterator(FullDir, Error))
+	{
+		if (Entry.is_directory(Error))
+		{
+			const std::wstring Name = Entry.path().filename().wstring();
+			WatchDirectory(RelativeDir.empty() ? Name : RelativeDir + L"/" + Name);
+		}
+	}
+}
+
+bool HPSourceWatcher_c::Wait(uint32_t TimeoutMs, std::vector<std::wstring>& OutChanged)
+{
+	if (NotifyHandle < 0)
+		return Poll(TimeoutMs, OutChanged);
+
+	pollfd PollHandle = { NotifyHandle, POLLIN, 0 };
+	if (poll(&PollHandle, 1, static_cast<int>(TimeoutMs)) <= 0)
+		return false;
+
+	const size_t ChangedCount = OutChanged.size();
+
+	alignas(inotify_event) char Buffer[16 * 1024];
+	for (;;)
+	{
+		const ssize_t ReadSize = read(NotifyHandle, Buffer, sizeof(Buffer));
+		if (ReadSize <= 0)
+			break;
+
+		for (ssize_t Offset = 0; Offset < ReadSize;)
+		{
+			const inotify_event* Event = reinterpret_cast<const inotify_event*>(Buffer + Offset);
+			Offset += sizeof(inotify_event) + Event->len;
+
+			if (Event->mask & IN_Q_OVERFLOW)
+			{
+				Overflow = true;
+				continue;
+			}
+
+			auto DirIt = WatchedDirs.find(Event->wd);
+			if (DirIt == WatchedDirs.end())
+				continue;
+
+			if (Event->mask & IN_IGNORED)
+			{
+				WatchedDirs.erase(DirIt);
+				continue;
+			}
+
+			if (Event->len == 0)
+				continue;
+
+			const std::wstring Name = NarrowToWide(Event->name);
+			const std::wstring Path = DirIt->second.empty() ? Name : DirIt->second + L"/" + Name;
+
+			if (!(Event->mask & IN_ISDIR))
+			{
+				OutChanged.push_back(Path);
+				continue;
+			}
+
+			if (Event->mask & (IN_CREATE | IN_MOVED_TO))
+			{
+				WatchDirectory(Path);
+
+				// Files written before the watch was added sent no events of their own
+				std::error_code Error;
+				for (const std::filesystem::directory_entry& Entry : std::filesystem::recursive_directory_iterator(SourceDir + L"/" + Path, Error))
+				{
+					if (Entry.is_regular_file(Error))
+					{
+						OutChanged.push_back(NarrowToWide(std::filesystem::relative(Entry.path(), SourceDir, Error).generic_string()));
+					}
+				}
+			}
+		}
+	}
+
+	return OutChanged.size() > ChangedCount || Overflow;
+}
+
+#else
+
+bool HPSourceWatcher_c::Start(const std::wstring& InSourceDir)
+{
+	SourceDir = InSourceDir;
+	Polled.clear();
+
+	LOGINFO("[HPSourceWatcher] Polling sources under %S", SourceDir.c_str());
+	return true;
+}
+
+void HPSourceWatcher_c::Stop()
+{
+	Polled.clear();
+}
+
+bool HPSourceWatcher_c::Wait(uint32_t TimeoutMs, std::vector<std::wstring>& OutChanged)
+{
+	return Poll(TimeoutMs, OutChanged);
+}
+
+#endif
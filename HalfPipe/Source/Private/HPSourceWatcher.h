@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Reports source files that change under a source dir. On Linux the whole dir is watched with inotify, elsewhere
+// the polled sources are stat'ed every wait.
+class HPSourceWatcher_c
+{
+public:
+
+	HPSourceWatcher_c() = default;
+	~HPSourceWatcher_c();
+
+	HPSourceWatcher_c(const HPSourceWatcher_c&) = delete;
+	HPSourceWatcher_c& operator=(const HPSourceWatcher_c&) = delete;
+
+	bool Start(const std::wstring& InSourceDir);
+	void Stop();
+
+	// Paths relative to the source dir checked when polling, sources already polled keep their last stamp so a
+	// change made while the set is replaced is still seen
+	void SetPolledSources(const std::vector<std::wstring>& Paths);
+
+	// Waits up to TimeoutMs for changes and appends the changed paths, relative to the source dir. True if any were.
+	bool Wait(uint32_t TimeoutMs, std::vector<std::wstring>& OutChanged);
+
+	// Events were dropped and anything may have changed since, cleared once read
+	bool TakeOverflow();
+
+private:
+
+	struct Stamp_s
+	{
+		uint64_t Size = 0;
+		int64_t WriteTime = 0;
+		bool Exists = false;
+	};
+
+	static Stamp_s StampSource(const std::wstring& FullPath);
+	bool Poll(uint32_t TimeoutMs, std::vector<std::wstring>& OutChanged);
+
+	std::wstring SourceDir;
+	std::unordered_map<std::wstring, Stamp_s> Polled;
+	bool Overflow = false;
+
+#if defined(__linux__)
+	void WatchDirectory(const std::wstring& RelativeDir);
+
+	int NotifyHandle = -1;
+	std::unordered_map<int, std::wstring> WatchedDirs;
+#endif
+};
@@ -12,6 +12,13 @@ bool HPTexture_s::Serialize(const std::wstring& Path, FileStreamMode_e Mode)
         return false;
     }
 
+    return Serialize(Stream);
+}
+
+bool HPTexture_s::Serialize(FileStream_s& Stream)
+{
+    CHECK(Stream.IsOpen());
+
     Stream.Stream(&Version);
 
     if (Version != HPTextureVersion_e::CURRENT)
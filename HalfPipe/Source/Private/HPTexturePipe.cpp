@@ -12,13 +12,13 @@ static std::wstring GenerateOutputPath(const std::wstring& OutputDir, const std:
 	return OutputDir + L"/" + ReplacePathExtension(AssetPath, L"hp_tex");
 }
 
-void HPTexturePipe_c::Cook(const std::wstring& SourceDir, const std::wstring& OutputDir, const HPArgs_t& Args)
+bool HPTexturePipe_c::Cook(const std::wstring& SourceDir, const std::wstring& OutputDir, const HPArgs_t& Args)
 {
 	std::wstring AssetPath;
 	if (!ParseArgs(Args, L"-src", AssetPath))
 	{
 		LOGERROR("[HPTexturePipe] No source path provided for asset");
-		return;
+		return false;
 	}
 
 	std::wstring AbsSrcPath = SourceDir + L"/" + AssetPath;
@@ -42,14 +42,14 @@ void HPTexturePipe_c::Cook(const std::wstring& SourceDir, const std::wstring& Ou
 	if (!SupportedExt)
 	{
 		LOGERROR("[HPTexturePipe] Unsupported path extension for texture %S", AssetPath.c_str());
-		return;
+		return false;
 	}
 
 	DDSTexture_s LoadedTexture;
 	if (!LoadDDSTexture(AbsSrcPath.c_str(), &LoadedTexture))
 	{
 		LOGERROR("[HPTexturePipe] Failed to load DDS texture %S", AssetPath.c_str());
-		return;
+		return false;
 	}
 
 	CookedAsset.SourcePath = AssetPath;
@@ -71,10 +71,17 @@ void HPTexturePipe_c::Cook(const std::wstring& SourceDir, const std::wstring& Ou
 	if (!CookedAsset.Serialize(AssetOutputPath, FileStreamMode_e::WRITE))
 	{
 		LOGERROR("[HPTexturePipe] Failed to write asset [%S]", AssetOutputPath.c_str());
-		return;
+		return false;
 	}
 
 	LOGINFO("[HPTexturePipe] Cooked texture [%S]", AssetOutputPath.c_str());
+
+	return true;
+}
+
+uint32_t HPTexturePipe_c::GetVersion() const
+{
+	return static_cast<uint32_t>(HPTextureVersion_e::CURRENT);
 }
 
 std::wstring HPTexturePipe_c::GetCookedAssetPath(const std::wstring& OutputDir, const HPArgs_t& Args) const
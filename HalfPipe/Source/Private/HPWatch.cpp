@@ -0,0 +1,184 @@
+#include "HalfPipe.h"
+
+#include "HPCookManifest.h"
+#include "HPPipe.h"
+#include "HPSourceWatcher.h"
+
+#include <Logging/Logging.h>
+
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+
+// What each output of the cook was cooked from and what its cook pushed, like a model's material library and the
+// library's textures, rebuilt from the cook manifest after every cook
+struct HPWatchGraph_s
+{
+	struct Output_s
+	{
+		HPAssetArgs_s Args;
+		std::vector<std::wstring> Dependencies;
+	};
+
+	std::unordered_map<std::wstring, Output_s> Outputs;
+
+	// Keyed by normalized source path
+	std::unordered_map<std::wstring, std::vector<std::wstring>> SourceOutputs;
+	std::vector<std::wstring> Sources;
+
+	uint32_t EdgeCount = 0;
+};
+
+void BuildGraph(const std::wstring& SourceDir, const std::wstring& OutputDir, const std::vector<HPAssetArgs_s>& Roots, HPWatchGraph_s& OutGraph)
+{
+	OutGraph = {};
+
+	HPCookManifest_c Manifest;
+	Manifest.Load(OutputDir);
+
+	std::deque<HPAssetArgs_s> Pending(Roots.begin(), Roots.end());
+	while (!Pending.empty())
+	{
+		HPAssetArgs_s Args = std::move(Pending.front());
+		Pending.pop_front();
+
+		IHPPipe_c* Pipe = GetPipeForAsset(Args.AssetType.c_str());
+		if (!Pipe)
+			continue;
+
+		const std::wstring Key = NormalizeCookPath(Pipe->GetPackageAssetPath(Args.Args));
+		if (Key.empty() || OutGraph.Outputs.contains(Key))
+			continue;
+
+		// From the pipe rather than the manifest, an asset that failed to cook is still recooked once its source is fixed
+		std::vector<std::wstring> SourcePaths;
+		Pipe->GetSourcePaths(SourceDir, Args.Args, SourcePaths);
+		for (const std::wstring& SourcePath : SourcePaths)
+		{
+			std::vector<std::wstring>& SourceOutputs = OutGraph.SourceOutputs[NormalizeCookPath(SourcePath)];
+			if (SourceOutputs.empty())
+			{
+				OutGraph.Sources.push_back(SourcePath);
+			}
+			SourceOutputs.push_back(Key);
+		}
+
+		HPWatchGraph_s::Output_s& Output = OutGraph.Outputs[Key];
+
+		HPCookManifest_c::Entry_s Entry;
+		if (Manifest.GetEntry(Key, Entry))
+		{
+			for (HPAssetArgs_s& Dependency : Entry.Dependencies)
+			{
+				Output.Dependencies.push_back(NormalizeCookPath(GetPackagePathForAssetFromArgs(Dependency)));
+				Pending.push_back(std::move(Dependency));
+			}
+			OutGraph.EdgeCount += static_cast<uint32_t>(Output.Dependencies.size());
+		}
+
+		Output.Args = std::move(Args);
+	}
+}
+
+}
+
+void HPWatch(const std::wstring& SourceDir, const std::wstring& OutputDir, const std::vector<HPAssetArgs_s>& Args, const HPCookSettings_s& Settings,
+	const HPWatchSettings_s& WatchSettings)
+{
+	HPCookSettings_s WatchCookSettings = Settings;
+	if (!WatchCookSettings.PackagePath.empty())
+	{
+		// A recook only knows the outputs it cooked, a package written from them would be missing the rest
+		LOGWARNING("HPWatch - Not writing package %S while watching", WatchCookSettings.PackagePath.c_str());
+		WatchCookSettings.PackagePath.clear();
+	}
+
+	HPCook(SourceDir, OutputDir, Args, WatchCookSettings);
+
+	// Recooks check the manifest, so the outputs a recooked asset pushes again are skipped unless they changed too
+	WatchCookSettings.Incremental = true;
+
+	HPWatchGraph_s Graph;
+	BuildGraph(SourceDir, OutputDir, Args, Graph);
+
+	HPSourceWatcher_c Watcher;
+	Watcher.Start(SourceDir);
+	Watcher.SetPolledSources(Graph.Sources);
+
+	LOGINFO("HPWatch - Watching %u sources of %u outputs, %u dependencies between them", static_cast<uint32_t>(Graph.Sources.size()),
+		static_cast<uint32_t>(Graph.Outputs.size()), Graph.EdgeCount);
+
+	auto ShouldStop = [&WatchSettings]() { return WatchSettings.Stop && WatchSettings.Stop->load(); };
+
+	std::vector<std::wstring> Changed;
+	while (!ShouldStop())
+	{
+		Changed.clear();
+		if (!Watcher.Wait(WatchSettings.PollMs, Changed))
+			continue;
+
+		// Saving one file often sends several events, and saving several files sends them in a burst
+		const std::chrono::steady_clock::time_point FirstChange = std::chrono::steady_clock::now();
+		while (std::chrono::steady_clock::now() - FirstChange < std::chrono::milliseconds(WatchSettings.MaxDelayMs) && Watcher.Wait(WatchSettings.DebounceMs, Changed))
+		{
+		}
+
+		std::vector<HPAssetArgs_s> Recook;
+		std::unordered_set<std::wstring> RecookKeys;
+		uint32_t ChangedSourceCount = 0;
+
+		if (Watcher.TakeOverflow())
+		{
+			// Everything may have changed, the manifest sorts out what did
+			LOGWARNING("HPWatch - Missed file events, checking every output");
+			for (const auto& [Key, Output] : Graph.Outputs)
+			{
+				RecookKeys.insert(Key);
+				Recook.push_back(Output.Args);
+			}
+		}
+
+		std::unordered_set<std::wstring> ChangedSources;
+		for (const std::wstring& Path : Changed)
+		{
+			const std::wstring Source = NormalizeCookPath(Path);
+			if (!ChangedSources.insert(Source).second)
+				continue;
+
+			auto It = Graph.SourceOutputs.find(Source);
+			if (It == Graph.SourceOutputs.end())
+				continue;
+
+			ChangedSourceCount++;
+
+			// Outputs that use a changed output refer to it by path, so only the outputs reading the source recook
+			for (const std::wstring& Key : It->second)
+			{
+				if (RecookKeys.insert(Key).second)
+				{
+					Recook.push_back(Graph.Outputs[Key].Args);
+				}
+			}
+		}
+
+		if (Recook.empty())
+			continue;
+
+		LOGINFO("HPWatch - %u sources changed, recooking %u outputs", ChangedSourceCount, static_cast<uint32_t>(Recook.size()));
+
+		const std::chrono::steady_clock::time_point CookStart = std::chrono::steady_clock::now();
+		HPCook(SourceDir, OutputDir, Recook, WatchCookSettings);
+
+		// A recooked material library may have picked up new textures
+		BuildGraph(SourceDir, OutputDir, Args, Graph);
+		Watcher.SetPolledSources(Graph.Sources);
+
+		const std::chrono::steady_clock::time_point CookEnd = std::chrono::steady_clock::now();
+		LOGINFO("HPWatch - Recooked in %.0f ms, %.0f ms after the first change", std::chrono::duration<double, std::milli>(CookEnd - CookStart).count(),
+			std::chrono::duration<double, std::milli>(CookEnd - FirstChange).count());
+	}
+}
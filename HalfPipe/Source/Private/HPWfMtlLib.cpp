@@ -12,6 +12,13 @@ bool HPWfMtlLib_s::Serialize(const std::wstring& Path, FileStreamMode_e Mode)
         return false;
     }
 
+    return Serialize(Stream);
+}
+
+bool HPWfMtlLib_s::Serialize(FileStream_s& Stream)
+{
+    CHECK(Stream.IsOpen());
+
     Stream.Stream(&Version);
 
     if (Version != HPWfMtlLibVersion_e::CURRENT)
@@ -13,13 +13,13 @@ static std::wstring GenerateOutputPath(const std::wstring& OutputDir, const std:
 	return OutputDir + L"/" + ReplacePathExtension(AssetPath, L"hp_wml");
 }
 
-void HPWfMtlLibPipe_c::Cook(const std::wstring& SourceDir, const std::wstring& OutputDir, const HPArgs_t& Args)
+bool HPWfMtlLibPipe_c::Cook(const std::wstring& SourceDir, const std::wstring& OutputDir, const HPArgs_t& Args)
 {
 	std::wstring AssetPath;
 	if (!ParseArgs(Args, L"-src", AssetPath))
 	{
 		LOGERROR("[HPWfMtlLibPipe] No source path provided for asset");
-		return;
+		return false;
 	}
 
 	if (AssetPath.empty())
@@ -34,14 +34,14 @@ void HPWfMtlLibPipe_c::Cook(const std::wstring& SourceDir, const std::wstring& O
 	if (!HasPathExtension(AbsSrcPath, L".mtl"))
 	{
 		LOGERROR("[HPWfMtlLibPipe] Unsupported file extension for source asset [%S]", AbsSrcPath.c_str());
-		return;
+		return false;
 	}
 
 	WaveFrontMtlReader_c MtlReader;
 	if (!MtlReader.Load(AbsSrcPath.c_str()))
 	{
 		LOGERROR("[HPWfMtlLibPipe] Failed to parse mtl file [%S]", AbsSrcPath.c_str());
-		return;
+		return false;
 	}
 
 	CookedAsset.Materials.resize(MtlReader.Materials.size());
@@ -78,10 +78,17 @@ void HPWfMtlLibPipe_c::Cook(const std::wstring& SourceDir, const std::wstring& O
 	if (!CookedAsset.Serialize(AssetOutputPath, FileStreamMode_e::WRITE))
 	{
 		LOGERROR("[HPWfMtlLibPipe] Failed to write asset [%S]", AssetOutputPath.c_str());
-		return;
+		return false;
 	}
 
 	LOGINFO("[HPWfMtlLibPipe] Cooked material [%S]", AssetOutputPath.c_str());
+
+	return true;
+}
+
+uint32_t HPWfMtlLibPipe_c::GetVersion() const
+{
+	return static_cast<uint32_t>(HPWfMtlLibVersion_e::CURRENT);
 }
 
 std::wstring HPWfMtlLibPipe_c::GetCookedAssetPath(const std::wstring& OutputDir, const HPArgs_t& Args) const
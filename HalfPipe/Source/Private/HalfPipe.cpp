@@ -1,7 +1,7 @@
 #include "HalfPipe.h"
 #include "HPPipe.h"
 
-void HPCook(const std::wstring& SourceDir, const std::wstring& OutputDir, const std::vector<HPAssetArgs_s>& Args)
+void HPCook(const std::wstring& SourceDir, const std::wstring& OutputDir, const std::vector<HPAssetArgs_s>& Args, const HPCookSettings_s& Settings)
 {
 	InitPipes();
 
@@ -10,5 +10,5 @@ void HPCook(const std::wstring& SourceDir, const std::wstring& OutputDir, const
 		PushCookCommand(AssetArgs);
 	}
 
-	ProcessCookCommands(SourceDir, OutputDir);
+	ProcessCookCommands(SourceDir, OutputDir, Settings);
 }
@@ -1,8 +1,10 @@
 #include "MeshProcessing.h"
 #include "Logging/Logging.h"
+#include "Threading/TaskPool.h"
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <unordered_map>
 #include <memory>
 #include <mutex>
@@ -784,6 +786,86 @@ bool MeshProcessing::OptimizeFacesLRU(index_t* Indices, size_t NumFaces, uint32_
 
     return true;
 }
+
+// Faces per chunk when a subset is split for OptimizeFacesLRU, the cache misses a few hits at each chunk's edges
+constexpr uint32_t kLRUChunkFaceCount = 64 * 1024;
+
+// Splits each subset of faces into chunks of at most ChunkFaceCount faces. The split depends only on the subsets,
+// never on the thread count, so work run per chunk gives the same result on any machine.
+std::vector<Subset_s> SplitSubsets(const Subset_s* Subsets, size_t SubsetCount, uint32_t ChunkFaceCount)
+{
+    std::vector<Subset_s> Chunks;
+
+    for (size_t SubsetIt = 0; SubsetIt < SubsetCount; ++SubsetIt)
+    {
+        const Subset_s& Subset = Subsets[SubsetIt];
+
+        // Evenly sized so the last chunk isn't a sliver
+        const uint32_t ChunkCount = (Subset.Count + ChunkFaceCount - 1) / ChunkFaceCount;
+        for (uint32_t ChunkIt = 0; ChunkIt < ChunkCount; ++ChunkIt)
+        {
+            const uint32_t Begin = static_cast<uint32_t>(uint64_t(Subset.Count) * ChunkIt / ChunkCount);
+            const uint32_t End = static_cast<uint32_t>(uint64_t(Subset.Count) * (ChunkIt + 1) / ChunkCount);
+            Chunks.emplace_back(Subset.Offset + Begin, End - Begin);
+        }
+    }
+
+    return Chunks;
+}
+
+bool MeshProcessing::OptimizeFacesLRU(index_t* Indices, size_t NumFaces, const Subset_s* Subsets, size_t SubsetCount, uint32_t* FaceRemap)
+{
+    if (!Indices || !NumFaces || !Subsets || !SubsetCount || !FaceRemap)
+    {
+        LOGERROR("Invalid args");
+        return false;
+    }
+
+    if (uint64_t(NumFaces) * 3 >= UINT32_MAX)
+    {
+        LOGERROR("Arithmetic overflow");
+        return false;
+    }
+
+    for (size_t SubsetIt = 0; SubsetIt < SubsetCount; ++SubsetIt)
+    {
+        if (uint64_t(Subsets[SubsetIt].Offset) + Subsets[SubsetIt].Count > NumFaces)
+        {
+            LOGERROR("Invalid args");
+            return false;
+        }
+    }
+
+    // Faces are only reordered within their chunk, so they stay in their subset
+    const std::vector<Subset_s> Chunks = SplitSubsets(Subsets, SubsetCount, kLRUChunkFaceCount);
+
+    std::atomic<bool> Failed = false;
+    TaskPool_c::Get().ParallelFor(static_cast<uint32_t>(Chunks.size()), 1, [&](uint32_t Begin, uint32_t End)
+    {
+        for (uint32_t ChunkIt = Begin; ChunkIt < End; ++ChunkIt)
+        {
+            const Subset_s& Chunk = Chunks[ChunkIt];
+            uint32_t* ChunkRemap = FaceRemap + Chunk.Offset;
+
+            if (!OptimizeFacesLRU(Indices + size_t(Chunk.Offset) * 3, Chunk.Count, ChunkRemap))
+            {
+                Failed = true;
+                continue;
+            }
+
+            for (uint32_t FaceIt = 0; FaceIt < Chunk.Count; ++FaceIt)
+            {
+                if (ChunkRemap[FaceIt] != UNUSED32)
+                {
+                    ChunkRemap[FaceIt] += Chunk.Offset;
+                }
+            }
+        }
+    });
+
+    return !Failed;
+}
+
 bool MeshProcessing::OptimizeVertices(index_t* Indices, size_t NumFaces, size_t NumVerts, uint32_t* VertexRemap) noexcept
 {
     if (!Indices || !NumFaces || !NumVerts || !VertexRemap)
@@ -1093,27 +1175,20 @@ std::vector<Subset_s> MeshProcessing::ComputeSubsets(const uint32_t* Attributes,
     return Subsets;
 }
 
-struct AlignedDeleter_s { void operator()(void* p) noexcept { _aligned_free(p); } };
-using AlignedArray_float4 = std::unique_ptr<float4[], AlignedDeleter_s>;
-AlignedArray_float4 MakeAlignedArray_float4(uint64_t Count)
-{
-    const uint64_t Size = sizeof(float4) * Count;
-    if (Size > static_cast<uint64_t>(UINT32_MAX))
-        return nullptr;
-
-    auto Ptr = _aligned_malloc(static_cast<size_t>(Size), 16);
+// Vertices per batch when normals and tangents are gathered across the task pool
+constexpr uint32_t kVertexBatchSize = 4096;
 
-    return AlignedArray_float4(static_cast<float4*>(Ptr));
-}
-
-bool ComputeNormalsWeightedByAngle(const index_t* Indices, size_t NumFaces, const float3* Positions, size_t NumVerts,float3* Normals) noexcept
+// The corners of the faces using each vertex, in face order. Sums gathered per vertex over them add in the same
+// order as a scatter over the faces would, so the result doesn't depend on how the vertices are split across threads.
+struct VertexCorners_s
 {
-    auto Temp = MakeAlignedArray_float4(NumVerts);
-    if (!Temp)
-        return RET_OUT_OF_MEM;
+    std::vector<uint32_t> Offsets;
+    std::vector<uint32_t> Corners;
+};
 
-    float4* VertNormals = Temp.get();
-    memset(VertNormals, 0, sizeof(float4) * NumVerts);
+bool BuildVertexCorners(const index_t* Indices, size_t NumFaces, size_t NumVerts, VertexCorners_s& Out)
+{
+    Out.Offsets.assign(NumVerts + 1, 0);
 
     for (size_t FaceIt = 0; FaceIt < NumFaces; ++FaceIt)
     {
@@ -1131,56 +1206,87 @@ bool ComputeNormalsWeightedByAngle(const index_t* Indices, size_t NumFaces, cons
             || I2 >= NumVerts)
             return RET_UNEXPECTED;
 
-        const float3 P0 = Positions[I0];
-        const float3 P1 = Positions[I1];
-        const float3 P2 = Positions[I2];
+        Out.Offsets[I0 + 1]++;
+        Out.Offsets[I1 + 1]++;
+        Out.Offsets[I2 + 1]++;
+    }
 
-        const float3 U = P1 - P0;
-        const float3 V = P2 - P0;
+    for (size_t VertIt = 0; VertIt < NumVerts; ++VertIt)
+    {
+        Out.Offsets[VertIt + 1] += Out.Offsets[VertIt];
+    }
 
-        const float3 FaceNormal = Normalize(Cross(U, V));
+    Out.Corners.resize(Out.Offsets[NumVerts]);
 
-        // Corner 0 -> 1 - 0, 2 - 0
-        const float3 A = Normalize(U);
-        const float3 B = Normalize(V);
-        float W0 = Dot(A, B);
-        W0 = Clamp(W0, -1.0f, 1.0f);
-        W0 = ACos(W0);
+    std::vector<uint32_t> Next(Out.Offsets.begin(), Out.Offsets.end() - 1);
+    for (size_t FaceIt = 0; FaceIt < NumFaces; ++FaceIt)
+    {
+        if (Indices[FaceIt * 3] == index_t(-1)
+            || Indices[FaceIt * 3 + 1] == index_t(-1)
+            || Indices[FaceIt * 3 + 2] == index_t(-1))
+            continue;
 
-        // Corner 1 -> 2 - 1, 0 - 1
-        const float3 C = Normalize(P2 - P1);
-        const float3 D = Normalize(P0 - P1);
-        float W1 = Dot(C, D);
-        W1 = Clamp(W1, -1.0f, 1.0f);
-        W1 = ACos(W1);
+        for (uint32_t CornerIt = 0; CornerIt < 3; ++CornerIt)
+        {
+            Out.Corners[Next[Indices[FaceIt * 3 + CornerIt]]++] = static_cast<uint32_t>(FaceIt * 3 + CornerIt);
+        }
+    }
 
-        // Corner 2 -> 0 - 2, 1 - 2
-        const float3 E = Normalize(P0 - P2);
-        const float3 F = Normalize(P1 - P2);
-        float W2 = Dot(E, F);
-        W2 = Clamp(W2, -1.0f, 1.0f);
-        W2 = ACos(W2);
+    return true;
+}
 
-        VertNormals[I0] = MultiplyAdd(FaceNormal, W0, VertNormals[I0].xyz);
-        VertNormals[I1] = MultiplyAdd(FaceNormal, W1, VertNormals[I1].xyz);
-        VertNormals[I2] = MultiplyAdd(FaceNormal, W2, VertNormals[I2].xyz);
-    }
+bool ComputeNormalsWeightedByAngle(const index_t* Indices, size_t NumFaces, const float3* Positions, size_t NumVerts, float3* Normals)
+{
+    VertexCorners_s VertexCorners;
+    if (!BuildVertexCorners(Indices, NumFaces, NumVerts, VertexCorners))
+        return false;
 
-    // Store results
-    for (size_t VertIt = 0; VertIt < NumVerts; ++VertIt)
+    TaskPool_c::Get().ParallelFor(static_cast<uint32_t>(NumVerts), kVertexBatchSize, [&](uint32_t Begin, uint32_t End)
     {
-        Normals[VertIt] = Normalize(VertNormals[VertIt].xyz);
-    }
+        for (uint32_t VertIt = Begin; VertIt < End; ++VertIt)
+        {
+            float3 VertNormal = k_Vec3Zero;
+
+            for (uint32_t It = VertexCorners.Offsets[VertIt]; It < VertexCorners.Offsets[VertIt + 1]; ++It)
+            {
+                const uint32_t Corner = VertexCorners.Corners[It] % 3;
+                const uint32_t Face = VertexCorners.Corners[It] - Corner;
+
+                const float3 P[3] =
+                {
+                    Positions[Indices[Face]],
+                    Positions[Indices[Face + 1]],
+                    Positions[Indices[Face + 2]],
+                };
+
+                const float3 U = P[1] - P[0];
+                const float3 V = P[2] - P[0];
+
+                const float3 FaceNormal = Normalize(Cross(U, V));
+
+                // Weighted by the angle between the corner's edges, corner 0 -> 1 - 0, 2 - 0
+                const float3 A = Normalize(P[(Corner + 1) % 3] - P[Corner]);
+                const float3 B = Normalize(P[(Corner + 2) % 3] - P[Corner]);
+                float W = Dot(A, B);
+                W = Clamp(W, -1.0f, 1.0f);
+                W = ACos(W);
+
+                VertNormal = MultiplyAdd(FaceNormal, W, VertNormal);
+            }
+
+            Normals[VertIt] = Normalize(VertNormal);
+        }
+    });
 
     return true;
 }
 
-bool MeshProcessing::ComputeNormals(const index_t* Indices, size_t NumFaces, const float3* Positions, size_t NumVerts, float3* Normals) noexcept
+bool MeshProcessing::ComputeNormals(const index_t* Indices, size_t NumFaces, const float3* Positions, size_t NumVerts, float3* Normals)
 {
     if (!Indices || !Positions || !NumFaces || !NumVerts || !Normals)
         return RET_INVALID_ARGS;
 
-    if (NumVerts >= UINT16_MAX)
+    if (NumVerts >= index_t(-1))
         return RET_INVALID_ARGS;
 
     if ((uint64_t(NumFaces) * 3) >= UINT32_MAX)
@@ -1189,7 +1295,7 @@ bool MeshProcessing::ComputeNormals(const index_t* Indices, size_t NumFaces, con
     return ComputeNormalsWeightedByAngle(Indices, NumFaces, Positions, NumVerts, Normals);
 }
 
-bool MeshProcessing::ComputeTangents(const index_t* Indices, size_t NumFaces, const float3* Positions, const float3* Normals, const float2* Texcoords, size_t NumVerts, float4* Tangents4, float3* Bitangents) noexcept
+bool MeshProcessing::ComputeTangents(const index_t* Indices, size_t NumFaces, const float3* Positions, const float3* Normals, const float2* Texcoords, size_t NumVerts, float4* Tangents4, float3* Bitangents)
 {
     if (!Tangents4 && !Bitangents)
         return RET_INVALID_ARGS;
@@ -1206,141 +1312,129 @@ bool MeshProcessing::ComputeTangents(const index_t* Indices, size_t NumFaces, co
     static constexpr float EPSILON = 0.0001f;
     static constexpr float4 kFlips = { 1.f, -1.f, -1.f, 1.f };
 
-    auto Temp = MakeAlignedArray_float4(uint64_t(NumVerts) * 2);
-    if (!Temp)
-        return RET_OUT_OF_MEM;
-
-    memset(Temp.get(), 0, sizeof(float4) * NumVerts * 2);
-
-    float4* Tangent1 = Temp.get();
-    float4* Tangent2 = Temp.get() + NumVerts;
+    VertexCorners_s VertexCorners;
+    if (!BuildVertexCorners(Indices, NumFaces, NumVerts, VertexCorners))
+        return false;
 
-    for (size_t FaceIt = 0; FaceIt < NumFaces; ++FaceIt)
+    TaskPool_c::Get().ParallelFor(static_cast<uint32_t>(NumVerts), kVertexBatchSize, [&](uint32_t Begin, uint32_t End)
     {
-        index_t I0 = Indices[FaceIt * 3];
-        index_t I1 = Indices[FaceIt * 3 + 1];
-        index_t I2 = Indices[FaceIt * 3 + 2];
+        for (uint32_t VertIt = Begin; VertIt < End; ++VertIt)
+        {
+            float4 Tangent1 = k_Vec4Zero;
+            float4 Tangent2 = k_Vec4Zero;
 
-        if (I0 == index_t(-1)
-            || I1 == index_t(-1)
-            || I2 == index_t(-1))
-            continue;
+            for (uint32_t It = VertexCorners.Offsets[VertIt]; It < VertexCorners.Offsets[VertIt + 1]; ++It)
+            {
+                const uint32_t Face = VertexCorners.Corners[It] - VertexCorners.Corners[It] % 3;
 
-        if (I0 >= NumVerts
-            || I1 >= NumVerts
-            || I2 >= NumVerts)
-            return RET_UNEXPECTED;
+                index_t I0 = Indices[Face];
+                index_t I1 = Indices[Face + 1];
+                index_t I2 = Indices[Face + 2];
 
-        const float2 T0 = Texcoords[I0];
-        const float2 T1 = Texcoords[I1];
-        const float2 T2 = Texcoords[I2];
+                const float2 T0 = Texcoords[I0];
+                const float2 T1 = Texcoords[I1];
+                const float2 T2 = Texcoords[I2];
 
-        float4 S = MergeXY(T1 - T0, T2 - T0);
+                float4 S = MergeXY(T1 - T0, T2 - T0);
 
-        float4 Tmp = S;
+                float4 Tmp = S;
 
-        float D = Tmp.x * Tmp.w - Tmp.z * Tmp.y;
-        D = (fabsf(D) <= EPSILON) ? 1.f : (1.f / D);
-        S = S * D;
-        S = S * kFlips;
+                float D = Tmp.x * Tmp.w - Tmp.z * Tmp.y;
+                D = (fabsf(D) <= EPSILON) ? 1.f : (1.f / D);
+                S = S * D;
+                S = S * kFlips;
 
-        matrix M0;
-        M0.r[0] = float4{ S.w, S.z, 0.0f, 0.0f };
-        M0.r[1] = float4{ S.y, S.x, 0.0f, 0.0f };
+                matrix M0;
+                M0.r[0] = float4{ S.w, S.z, 0.0f, 0.0f };
+                M0.r[1] = float4{ S.y, S.x, 0.0f, 0.0f };
 
-        M0.r[2] = M0.r[3] = float4{ 0.0f };
+                M0.r[2] = M0.r[3] = float4{ 0.0f };
 
-        const float3 P0 = Positions[I0];
-        const float3 P1 = Positions[I1];
-        float3 P2 = Positions[I2];
+                const float3 P0 = Positions[I0];
+                const float3 P1 = Positions[I1];
+                float3 P2 = Positions[I2];
 
-        matrix M1;
-        M1.r[0] = P1 - P0;
-        M1.r[1] = P2 - P0;
-        M1.r[2] = M1.r[3] = float4{ 0.0f };
+                matrix M1;
+                M1.r[0] = P1 - P0;
+                M1.r[1] = P2 - P0;
+                M1.r[2] = M1.r[3] = float4{ 0.0f };
 
-        const matrix UV = M0 * M1;
+                const matrix UV = M0 * M1;
 
-        Tangent1[I0] = Tangent1[I0] + UV.r[0];
-        Tangent1[I1] = Tangent1[I1] + UV.r[0];
-        Tangent1[I2] = Tangent1[I2] + UV.r[0];
-                                    
-        Tangent2[I0] = Tangent2[I0] + UV.r[1];
-        Tangent2[I1] = Tangent2[I1] + UV.r[1];
-        Tangent2[I2] = Tangent2[I2] + UV.r[1];
-    }
+                Tangent1 = Tangent1 + UV.r[0];
+                Tangent2 = Tangent2 + UV.r[1];
+            }
 
-    for (size_t VertIt = 0; VertIt < NumVerts; ++VertIt)
-    {
-        // Gram-Schmidt orthonormalization
-        float4 B0 = Normals[VertIt];
-        B0 = Normalize(B0.xyz);
+            // Gram-Schmidt orthonormalization
+            float4 B0 = Normals[VertIt];
+            B0 = Normalize(B0.xyz);
 
-        const float4 Tan1 = Tangent1[VertIt];
-        float4 B1 = Tan1 - (Dot3(B0, Tan1) * B0);
-        B1 = Normalize(B1.xyz);
+            const float4 Tan1 = Tangent1;
+            float4 B1 = Tan1 - (Dot3(B0, Tan1) * B0);
+            B1 = Normalize(B1.xyz);
 
-        const float4 Tan2 = Tangent2[VertIt];
+            const float4 Tan2 = Tangent2;
 
-        float4 B2 = ((Tan2 - (Dot3(B0, Tan2) * B0)) - (Dot3(B1, Tan2) * B1));
+            float4 B2 = ((Tan2 - (Dot3(B0, Tan2) * B0)) - (Dot3(B1, Tan2) * B1));
 
-        B2 = Normalize(B2.xyz);
+            B2 = Normalize(B2.xyz);
 
-        // handle degenerate vectors
-        const float Len1 = Length(B1);
-        const float Len2 = Length(B2);
+            // handle degenerate vectors
+            const float Len1 = Length(B1);
+            const float Len2 = Length(B2);
 
-        if ((Len1 <= EPSILON) || (Len2 <= EPSILON))
-        {
-            if (Len1 > 0.5f)
-            {
-                // Reset bi-tangent from tangent and normal
-                B2 = Cross3(B0, B1);
-            }
-            else if (Len2 > 0.5f)
+            if ((Len1 <= EPSILON) || (Len2 <= EPSILON))
             {
-                // Reset tangent from bi-tangent and normal
-                B1 = Cross3(B2, B0);
-            }
-            else
-            {
-                // Reset both tangent and bi-tangent from normal
-                float4 Axis;
-
-                const float D0 = fabsf(Dot3(K_IdentityR0, B0));
-                const float D1 = fabsf(Dot3(K_IdentityR1, B0));
-                const float D2 = fabsf(Dot3(K_IdentityR2, B0));
-                if (D0 < D1)
+                if (Len1 > 0.5f)
                 {
-                    Axis = (D0 < D2) ? K_IdentityR0 : K_IdentityR2;
+                    // Reset bi-tangent from tangent and normal
+                    B2 = Cross3(B0, B1);
                 }
-                else if (D1 < D2)
+                else if (Len2 > 0.5f)
                 {
-                    Axis = K_IdentityR1;
+                    // Reset tangent from bi-tangent and normal
+                    B1 = Cross3(B2, B0);
                 }
                 else
                 {
-                    Axis = K_IdentityR2;
-                }
+                    // Reset both tangent and bi-tangent from normal
+                    float4 Axis;
+
+                    const float D0 = fabsf(Dot3(K_IdentityR0, B0));
+                    const float D1 = fabsf(Dot3(K_IdentityR1, B0));
+                    const float D2 = fabsf(Dot3(K_IdentityR2, B0));
+                    if (D0 < D1)
+                    {
+                        Axis = (D0 < D2) ? K_IdentityR0 : K_IdentityR2;
+                    }
+                    else if (D1 < D2)
+                    {
+                        Axis = K_IdentityR1;
+                    }
+                    else
+                    {
+                        Axis = K_IdentityR2;
+                    }
 
-                B1 = Cross3(B0, Axis);
-                B2 = Cross3(B0, B1);
+                    B1 = Cross3(B0, Axis);
+                    B2 = Cross3(B0, B1);
+                }
             }
-        }
 
-        if (Tangents4)
-        {
-            float4 Bi = Cross3(B0, Tan1);
-            const float W = AllLess(Dot3(Bi, Tan2), k_Vec3Zero) ? -1.f : 1.f;
+            if (Tangents4)
+            {
+                float4 Bi = Cross3(B0, Tan1);
+                const float W = AllLess(Dot3(Bi, Tan2), k_Vec3Zero) ? -1.f : 1.f;
 
-            Tangents4[VertIt] = float4{ Bi.xyz, W };
-        }
+                Tangents4[VertIt] = float4{ Bi.xyz, W };
+            }
 
-        if (Bitangents)
-        {
-            Bitangents[VertIt] = B2.xyz;
+            if (Bitangents)
+            {
+                Bitangents[VertIt] = B2.xyz;
+            }
         }
-    }
+    });
 
     return true;
 }
@@ -1384,16 +1478,10 @@ namespace std
     template <> struct hash<float3> { size_t operator()(const float3& Value) const { return CRCHash(reinterpret_cast<const uint32_t*>(&Value), sizeof(Value) / 4); } };
 }
 
-void BuildAdjacencyList(
-    const index_t* Indices, uint32_t IndexCount,
-    const float3* Positions, uint32_t VertexCount,
-    uint32_t* Adjacency
-)
+// Find point reps (unique positions) in the position stream
+// Create a mapping of non-unique vertex indices to point reps
+void ComputePointReps(const float3* Positions, uint32_t VertexCount, std::vector<index_t>& PointRep)
 {
-    const uint32_t TriCount = IndexCount / 3;
-    // Find point reps (unique positions) in the position stream
-    // Create a mapping of non-unique vertex indices to point reps
-    std::vector<index_t> PointRep;
     PointRep.resize(VertexCount);
 
     std::unordered_map<size_t, index_t> UniquePositionMap;
@@ -1417,9 +1505,19 @@ void BuildAdjacencyList(
             PointRep[VertexIt] = static_cast<index_t>(VertexIt);
         }
     }
+}
+
+void BuildAdjacencyList(
+    const index_t* Indices, uint32_t IndexCount,
+    const float3* Positions, const index_t* PointRep,
+    uint32_t* Adjacency
+)
+{
+    const uint32_t TriCount = IndexCount / 3;
 
     // Create a linked list of edges for each vertex to determine adjacency
-    const uint32_t HashSize = VertexCount / 3;
+    // Opposite edges share a bucket whatever its size, so sizing it by the faces only changes the chain lengths
+    const uint32_t HashSize = std::max(TriCount, 1u);
 
     std::unique_ptr<EdgeEntry_s* []> HashTable(new EdgeEntry_s * [HashSize]);
     std::unique_ptr<EdgeEntry_s[]> Entries(new EdgeEntry_s[TriCount * 3]);
@@ -1783,6 +1881,7 @@ void Meshletize(
     uint32_t MaxVerts, uint32_t MaxPrims,
     const index_t* Indices, uint32_t IndexCount,
     const float3* Positions, uint32_t VertexCount,
+    const index_t* PointRep,
     std::vector<InlineMeshlet>& Output
 )
 {
@@ -1792,7 +1891,7 @@ void Meshletize(
     std::vector<uint32_t> Adjacency;
     Adjacency.resize(IndexCount);
 
-    BuildAdjacencyList(Indices, IndexCount, Positions, VertexCount, Adjacency.data());
+    BuildAdjacencyList(Indices, IndexCount, Positions, PointRep, Adjacency.data());
 
     // Rest our outputs
     Output.clear();
@@ -1977,6 +2076,9 @@ void Meshletize(
     }
 }
 
+// Faces per chunk when a subset is split for Meshletize, meshlets don't cross a chunk's edges
+constexpr uint32_t kMeshletChunkFaceCount = 64 * 1024;
+
 bool MeshProcessing::ComputeMeshlets(
     uint32_t MaxVerts, uint32_t MaxPrims, 
     const index_t* Indices, uint32_t indexCount, 
@@ -1987,58 +2089,93 @@ bool MeshProcessing::ComputeMeshlets(
     std::vector<uint8_t>& UniqueVertexIndices, 
     std::vector<PackedTriangle_s>& PrimitiveIndices)
 {
+    std::vector<index_t> PointRep;
+    ComputePointReps(Positions, VertexCount, PointRep);
+
+    // Chunks of faces, in subset order, with the subset each came from
+    std::vector<Subset_s> Chunks;
+    std::vector<uint32_t> ChunkSubsets;
+
     for (uint32_t SubsetIt = 0; SubsetIt < SubsetCount; ++SubsetIt)
     {
         Subset_s Subset = IndexSubsets[SubsetIt];
 
         assert(Subset.Offset + Subset.Count <= indexCount);
 
-        std::vector<InlineMeshlet> BuiltMeshlets;
-        Meshletize(MaxVerts, MaxPrims, Indices + Subset.Offset, Subset.Count, Positions, VertexCount, BuiltMeshlets);
+        const Subset_s FaceSubset = { Subset.Offset / 3, Subset.Count / 3 };
+        for (const Subset_s& Chunk : SplitSubsets(&FaceSubset, 1, kMeshletChunkFaceCount))
+        {
+            Chunks.push_back(Chunk);
+            ChunkSubsets.push_back(SubsetIt);
+        }
+    }
+
+    std::vector<std::vector<InlineMeshlet>> ChunkMeshlets;
+    ChunkMeshlets.resize(Chunks.size());
 
+    TaskPool_c::Get().ParallelFor(static_cast<uint32_t>(Chunks.size()), 1, [&](uint32_t Begin, uint32_t End)
+    {
+        for (uint32_t ChunkIt = Begin; ChunkIt < End; ++ChunkIt)
+        {
+            Meshletize(MaxVerts, MaxPrims, Indices + size_t(Chunks[ChunkIt].Offset) * 3, Chunks[ChunkIt].Count * 3, Positions, VertexCount, PointRep.data(), ChunkMeshlets[ChunkIt]);
+        }
+    });
+
+    uint32_t ChunkIt = 0;
+    for (uint32_t SubsetIt = 0; SubsetIt < SubsetCount; ++SubsetIt)
+    {
         Subset_s MeshletSubset;
         MeshletSubset.Offset = static_cast<uint32_t>(Meshlets.size());
-        MeshletSubset.Count = static_cast<uint32_t>(BuiltMeshlets.size());
-        MeshletSubsets.push_back(MeshletSubset);
 
-        // Determine final unique vertex index and primitive index counts & offsets.
-        uint32_t StartVertCount = static_cast<uint32_t>(UniqueVertexIndices.size()) / sizeof(index_t);
-        uint32_t StartPrimCount = static_cast<uint32_t>(PrimitiveIndices.size());
+        for (; ChunkIt < Chunks.size() && ChunkSubsets[ChunkIt] == SubsetIt; ++ChunkIt)
+        {
+            const std::vector<InlineMeshlet>& BuiltMeshlets = ChunkMeshlets[ChunkIt];
+
+            // Determine final unique vertex index and primitive index counts & offsets.
+            uint32_t StartVertCount = static_cast<uint32_t>(UniqueVertexIndices.size()) / sizeof(index_t);
+            uint32_t StartPrimCount = static_cast<uint32_t>(PrimitiveIndices.size());
 
-        uint32_t UniqueVertexIndexCount = StartVertCount;
-        uint32_t PrimitiveIndexCount = StartPrimCount;
+            uint32_t UniqueVertexIndexCount = StartVertCount;
+            uint32_t PrimitiveIndexCount = StartPrimCount;
 
-        // Resize the meshlet output array to hold the newly formed meshlets.
-        uint32_t MeshletCount = static_cast<uint32_t>(Meshlets.size());
-        Meshlets.resize(MeshletCount + BuiltMeshlets.size());
+            // Resize the meshlet output array to hold the newly formed meshlets.
+            uint32_t MeshletCount = static_cast<uint32_t>(Meshlets.size());
+            Meshlets.resize(MeshletCount + BuiltMeshlets.size());
 
-        for (uint32_t BuiltMeshletIt = 0, Dest = MeshletCount; BuiltMeshletIt < static_cast<uint32_t>(BuiltMeshlets.size()); ++BuiltMeshletIt, ++Dest)
-        {
-            Meshlets[Dest].VertOffset = UniqueVertexIndexCount;
-            Meshlets[Dest].VertCount = static_cast<uint32_t>(BuiltMeshlets[BuiltMeshletIt].UniqueVertexIndices.size());
-            UniqueVertexIndexCount += static_cast<uint32_t>(BuiltMeshlets[BuiltMeshletIt].UniqueVertexIndices.size());
+            for (uint32_t BuiltMeshletIt = 0, Dest = MeshletCount; BuiltMeshletIt < static_cast<uint32_t>(BuiltMeshlets.size()); ++BuiltMeshletIt, ++Dest)
+            {
+                Meshlets[Dest].VertOffset = UniqueVertexIndexCount;
+                Meshlets[Dest].VertCount = static_cast<uint32_t>(BuiltMeshlets[BuiltMeshletIt].UniqueVertexIndices.size());
+                UniqueVertexIndexCount += static_cast<uint32_t>(BuiltMeshlets[BuiltMeshletIt].UniqueVertexIndices.size());
 
-            Meshlets[Dest].PrimOffset = PrimitiveIndexCount;
-            Meshlets[Dest].PrimCount = static_cast<uint32_t>(BuiltMeshlets[BuiltMeshletIt].PrimitiveIndices.size());
-            PrimitiveIndexCount += static_cast<uint32_t>(BuiltMeshlets[BuiltMeshletIt].PrimitiveIndices.size());
-        }
+                Meshlets[Dest].PrimOffset = PrimitiveIndexCount;
+                Meshlets[Dest].PrimCount = static_cast<uint32_t>(BuiltMeshlets[BuiltMeshletIt].PrimitiveIndices.size());
+                PrimitiveIndexCount += static_cast<uint32_t>(BuiltMeshlets[BuiltMeshletIt].PrimitiveIndices.size());
+            }
 
-        // Allocate space for the new data.
-        UniqueVertexIndices.resize(UniqueVertexIndexCount * sizeof(index_t));
-        PrimitiveIndices.resize(PrimitiveIndexCount);
+            // Allocate space for the new data.
+            UniqueVertexIndices.resize(UniqueVertexIndexCount * sizeof(index_t));
+            PrimitiveIndices.resize(PrimitiveIndexCount);
 
-        // Copy data from the freshly built meshlets into the output buffers.
-        auto VertDest = reinterpret_cast<index_t*>(UniqueVertexIndices.data()) + StartVertCount;
-        auto PrimDest = reinterpret_cast<uint32_t*>(PrimitiveIndices.data()) + StartPrimCount;
+            // Copy data from the freshly built meshlets into the output buffers.
+            auto VertDest = reinterpret_cast<index_t*>(UniqueVertexIndices.data()) + StartVertCount;
+            auto PrimDest = reinterpret_cast<uint32_t*>(PrimitiveIndices.data()) + StartPrimCount;
 
-        for (uint32_t BuiltMeshletIt = 0; BuiltMeshletIt < static_cast<uint32_t>(BuiltMeshlets.size()); ++BuiltMeshletIt)
-        {
-            std::memcpy(VertDest, BuiltMeshlets[BuiltMeshletIt].UniqueVertexIndices.data(), BuiltMeshlets[BuiltMeshletIt].UniqueVertexIndices.size() * sizeof(index_t));
-            std::memcpy(PrimDest, BuiltMeshlets[BuiltMeshletIt].PrimitiveIndices.data(), BuiltMeshlets[BuiltMeshletIt].PrimitiveIndices.size() * sizeof(uint32_t));
+            for (uint32_t BuiltMeshletIt = 0; BuiltMeshletIt < static_cast<uint32_t>(BuiltMeshlets.size()); ++BuiltMeshletIt)
+            {
+                std::memcpy(VertDest, BuiltMeshlets[BuiltMeshletIt].UniqueVertexIndices.data(), BuiltMeshlets[BuiltMeshletIt].UniqueVertexIndices.size() * sizeof(index_t));
+                std::memcpy(PrimDest, BuiltMeshlets[BuiltMeshletIt].PrimitiveIndices.data(), BuiltMeshlets[BuiltMeshletIt].PrimitiveIndices.size() * sizeof(uint32_t));
+
+                VertDest += BuiltMeshlets[BuiltMeshletIt].UniqueVertexIndices.size();
+                PrimDest += BuiltMeshlets[BuiltMeshletIt].PrimitiveIndices.size();
+            }
 
-            VertDest += BuiltMeshlets[BuiltMeshletIt].UniqueVertexIndices.size();
-            PrimDest += BuiltMeshlets[BuiltMeshletIt].PrimitiveIndices.size();
+            // Done with the chunk's meshlets
+            std::vector<InlineMeshlet>().swap(ChunkMeshlets[ChunkIt]);
         }
+
+        MeshletSubset.Count = static_cast<uint32_t>(Meshlets.size()) - MeshletSubset.Offset;
+        MeshletSubsets.push_back(MeshletSubset);
     }
 
     return true;
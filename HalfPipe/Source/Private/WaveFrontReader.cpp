@@ -3,6 +3,7 @@
 
 #include <cstring>
 #include <filesystem>
+#include <sstream>
 
 // Get a path relative to the base objects path
 std::wstring GetFileRelativePath(const std::wstring& BasePath, const std::wstring& InPath)
@@ -13,16 +14,29 @@ std::wstring GetFileRelativePath(const std::wstring& BasePath, const std::wstrin
 
 bool WaveFrontReader_c::Load(const wchar_t* FileName)
 {
-    Clear();
-
-    static const size_t MAX_POLY = 64;
-
     std::wifstream InFile(FileName);
     if (!ENSUREMSG(!InFile.fail(), "File not found: %S", FileName))
     {
+        Clear();
         return false;
     }
 
+    return Parse(InFile, FileName);
+}
+
+bool WaveFrontReader_c::Load(std::span<const uint8_t> Data, const wchar_t* FileName)
+{
+    // Widened byte by byte, as the file stream does
+    std::wistringstream InStream(std::wstring(Data.begin(), Data.end()));
+    return Parse(InStream, FileName);
+}
+
+bool WaveFrontReader_c::Parse(std::wistream& InFile, const wchar_t* FileName)
+{
+    Clear();
+
+    static const size_t MAX_POLY = 64;
+
     wchar_t FName[_MAX_FNAME] = {};
     _wsplitpath_s(FileName, nullptr, 0, nullptr, 0, FName, _MAX_FNAME, nullptr, 0);
 
@@ -305,9 +319,6 @@ bool WaveFrontReader_c::Load(const wchar_t* FileName)
     if (Positions.empty())
         return false;
 
-    // Cleanup
-    InFile.close();
-
     Bounds.InitFromPoints(Positions.data(), Positions.size());
 
     // If an associated material file was found, read that in as well.
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+
+// Cooked level (.hp_clv), written by the Level pipe from a .hp_lvl.
+// Fixed layout plain structs so the runtime can read it straight out of a mapped file: a header, then the
+// class, object and component tables, a string table and the payload blob, at offsets from the start of the file.
+
+enum class HPLevelVersion_e : uint32_t
+{
+	INITIAL = 0,
+
+	CURRENT = INITIAL,
+};
+
+constexpr uint32_t HPLevelMagic = 0x564C5048; // "HPLV"
+
+enum class HPLevelClassKind_e : uint32_t
+{
+	OBJECT,
+	COMPONENT,
+};
+
+// Each distinct class name appears once, so the runtime resolves factories per class rather than per object
+struct HPLevelClass_s
+{
+	uint64_t NameHash; // FNV-1a of the UTF-8 name
+	uint32_t NameOffset; // UTF-8, into the string table, not null terminated
+	uint32_t NameLength;
+	HPLevelClassKind_e Kind;
+	uint32_t Padding;
+};
+
+enum HPLevelObjectFlags_e : uint32_t
+{
+	HPLEVEL_OBJECT_HAS_TRANSFORM = 1 << 0,
+};
+
+struct HPLevelObject_s
+{
+	float Position[3];
+	float Rotation[3];
+	float Scale;
+
+	uint32_t ClassIndex;
+	uint32_t Flags;
+
+	// Into the component table, an object's components are contiguous
+	uint32_t FirstComponent;
+	uint32_t ComponentCount;
+
+	// CBOR encoded fields left over once the class, transform and components are taken out, into the payload blob.
+	// Size is zero when there are none.
+	uint32_t PayloadOffset;
+	uint32_t PayloadSize;
+};
+
+struct HPLevelComponent_s
+{
+	uint32_t ClassIndex;
+	uint32_t PayloadOffset;
+	uint32_t PayloadSize;
+};
+
+struct HPLevelHeader_s
+{
+	uint32_t Magic = HPLevelMagic;
+	HPLevelVersion_e Version = HPLevelVersion_e::CURRENT;
+
+	uint32_t ClassCount = 0;
+	uint32_t ObjectCount = 0;
+	uint32_t ComponentCount = 0;
+
+	uint32_t ClassTableOffset = 0;
+	uint32_t ObjectTableOffset = 0;
+	uint32_t ComponentTableOffset = 0;
+	uint32_t StringTableOffset = 0;
+	uint32_t StringTableSize = 0;
+	uint32_t PayloadOffset = 0;
+	uint32_t PayloadSize = 0;
+};
+
+static_assert(sizeof(HPLevelClass_s) == 24, "HPLevelClass_s layout is part of the file format");
+static_assert(sizeof(HPLevelObject_s) == 52, "HPLevelObject_s layout is part of the file format");
+static_assert(sizeof(HPLevelComponent_s) == 12, "HPLevelComponent_s layout is part of the file format");
+static_assert(sizeof(HPLevelHeader_s) == 48, "HPLevelHeader_s layout is part of the file format");
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <FileUtils/MappedFile.h>
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Cooked package (.hp_pak), written by HalfPipe with every output of a package's cook.
+// A header, then each asset's bytes at a 4K aligned offset, then the table of contents sorted by path hash and
+// the string table of paths. Read straight out of a mapped file, so stored assets are served without a copy.
+
+enum class HPPackageVersion_e : uint32_t
+{
+	INITIAL = 0,
+
+	CURRENT = INITIAL,
+};
+
+constexpr uint32_t HPPackageMagic = 0x4B505048; // "HPPK"
+constexpr uint64_t HPPackageAlignment = 4096;
+
+enum class HPPackageCompression_e : uint32_t
+{
+	NONE,
+	LZ, // LZ4 style block, see HPPackageDecompress
+};
+
+struct HPPackageEntry_s
+{
+	uint64_t PathHash; // HashPackagePath of Path
+	uint64_t Offset;
+	uint64_t StoredSize;
+	uint64_t Size; // Once decompressed, the same as StoredSize when stored as is
+
+	uint32_t PathOffset; // Into the string table, UTF-8, not null terminated
+	uint32_t PathLength;
+	HPPackageCompression_e Compression;
+	uint32_t Padding;
+};
+
+struct HPPackageHeader_s
+{
+	uint32_t Magic = HPPackageMagic;
+	HPPackageVersion_e Version = HPPackageVersion_e::CURRENT;
+
+	uint32_t EntryCount = 0;
+	uint32_t StringTableSize = 0;
+	uint64_t EntryTableOffset = 0;
+	uint64_t StringTableOffset = 0;
+};
+
+static_assert(sizeof(HPPackageEntry_s) == 48, "HPPackageEntry_s layout is part of the file format");
+static_assert(sizeof(HPPackageHeader_s) == 32, "HPPackageHeader_s layout is part of the file format");
+
+// FNV-1a of the path relative to the package root, with / separators and ascii lower cased so it matches however
+// the path was spelt on a case insensitive file system
+uint64_t HashPackagePath(std::wstring_view Path);
+
+// False if Compressed does not decode to exactly OutData.size() bytes
+bool HPPackageDecompress(std::span<const uint8_t> Compressed, std::span<uint8_t> OutData);
+
+class HPPackage_c
+{
+public:
+
+	bool Open(const std::wstring& Path);
+	void Close();
+
+	bool IsOpen() const noexcept { return Header != nullptr; }
+	const std::wstring& GetPath() const noexcept { return PackagePath; }
+
+	std::span<const HPPackageEntry_s> GetEntries() const noexcept;
+	std::string_view GetEntryPath(const HPPackageEntry_s& Entry) const noexcept;
+
+	// Binary search of the table of contents, null if the package does not hold the asset
+	const HPPackageEntry_s* FindEntry(std::wstring_view AssetPath) const noexcept;
+
+	// The entry's bytes in the mapped file, compressed if the entry is
+	std::span<const uint8_t> GetStoredBytes(const HPPackageEntry_s& Entry) const noexcept;
+
+private:
+
+	MappedFile_c File;
+	std::wstring PackagePath;
+
+	const HPPackageHeader_s* Header = nullptr;
+	const HPPackageEntry_s* Entries = nullptr;
+	const char* Strings = nullptr;
+};
+
+// An asset's bytes, either pointing into a mapped package or owning what was decompressed or read from a loose file
+struct HPAssetBytes_s
+{
+	HPAssetBytes_s() = default;
+	HPAssetBytes_s(HPAssetBytes_s&&) = default;
+	HPAssetBytes_s& operator=(HPAssetBytes_s&&) = default;
+
+	// Bytes may point into Owned, a copy would point into the original
+	HPAssetBytes_s(const HPAssetBytes_s&) = delete;
+	HPAssetBytes_s& operator=(const HPAssetBytes_s&) = delete;
+
+	std::span<const uint8_t> Bytes;
+	std::vector<uint8_t> Owned;
+	bool FromPackage = false;
+};
+
+// Serves cooked assets by path out of the mounted packages, falling back to loose files under the loose dir for
+// assets no package holds, so a development cook without packages loads the same way.
+// Mount before loading, Load is safe from several threads at once.
+class HPAssetReader_c
+{
+public:
+
+	// Prefixed to asset paths as is, so ends in a separator
+	void SetLooseDir(const std::wstring& Dir) { LooseDir = Dir; }
+
+	// Packages mounted first are searched first
+	bool MountPackage(const std::wstring& PackagePath);
+
+	// Every .hp_pak directly in Dir, in name order, returns how many were mounted
+	uint32_t MountPackagesInDir(const std::wstring& Dir);
+
+	void UnmountAll() { Packages.clear(); }
+
+	// AssetPath is relative to the package root and the loose dir, as cooked
+	bool Load(const std::wstring& AssetPath, HPAssetBytes_s& OutAsset) const;
+
+	uint32_t GetPackageCount() const noexcept { return static_cast<uint32_t>(Packages.size()); }
+
+private:
+
+	std::vector<std::unique_ptr<HPPackage_c>> Packages;
+	std::wstring LooseDir;
+};
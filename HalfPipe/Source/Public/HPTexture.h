@@ -11,6 +11,7 @@ enum class HPTextureVersion_e
 };
 
 enum class FileStreamMode_e;
+struct FileStream_s;
 
 struct HPTexture_s
 {
@@ -33,4 +34,5 @@ struct HPTexture_s
 	std::wstring SourcePath;
 
 	bool Serialize(const std::wstring& Path, FileStreamMode_e Mode);
+	bool Serialize(FileStream_s& Stream);
 };
\ No newline at end of file
@@ -11,6 +11,7 @@ enum class HPWfMtlLibVersion_e
 };
 
 enum class FileStreamMode_e;
+struct FileStream_s;
 
 struct HPWfMtlLib_s
 {
@@ -30,4 +31,5 @@ struct HPWfMtlLib_s
 	std::wstring SourcePath;
 
 	bool Serialize(const std::wstring& Path, FileStreamMode_e Mode);
+	bool Serialize(FileStream_s& Stream);
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -11,4 +13,57 @@ struct HPAssetArgs_s
 	HPArgs_t Args;
 };
 
-void HPCook(const std::wstring& SourceDir, const std::wstring& OutputDir, const std::vector<HPAssetArgs_s>& Args);
\ No newline at end of file
+struct HPCookSettings_s
+{
+	// Assets cooked at once, 0 for one per hardware thread
+	uint32_t ThreadCount = 0;
+
+	// Skip assets the cook manifest in the output dir says are up to date
+	bool Incremental = true;
+
+	// Bytes the cooks running at once may be estimated to need, cooks wait for others to finish rather than go over.
+	// 0 for no limit.
+	uint64_t MemoryBudget = 0;
+
+	// When set, every output of the cook is also packed into a .hp_pak here
+	std::wstring PackagePath;
+	bool CompressPackage = false;
+};
+
+struct HPCookReportSettings_s
+{
+	// Flagged when the cook time or output size is this far over the baseline, 0.25 for 25%
+	float Threshold = 0.25f;
+
+	// The baseline is the median of up to this many earlier runs of the asset
+	uint32_t BaselineRuns = 5;
+
+	// Slowdowns smaller than this are noise and never flagged
+	double MinSeconds = 0.05;
+};
+
+struct HPWatchSettings_s
+{
+	// A change is cooked once no other arrives for this long, so a burst of saves cooks once
+	uint32_t DebounceMs = 100;
+
+	// Cooked after this long even if changes keep arriving
+	uint32_t MaxDelayMs = 500;
+
+	// How often sources are stat'ed where they can not be watched, and how often Stop is checked
+	uint32_t PollMs = 250;
+
+	// Watches until set, forever when null
+	const std::atomic<bool>* Stop = nullptr;
+};
+
+void HPCook(const std::wstring& SourceDir, const std::wstring& OutputDir, const std::vector<HPAssetArgs_s>& Args, const HPCookSettings_s& Settings = {});
+
+// Compares the latest cook into OutputDir against the history of earlier ones, logging and returning how many
+// assets regressed
+uint32_t HPReportCookRegressions(const std::wstring& OutputDir, const HPCookReportSettings_s& Settings = {});
+
+// Cooks Args, then keeps every output of the cook, including the ones its cooks pushed, up to date as their sources
+// change under SourceDir, recooking only the outputs that read a changed source. Cooks loose, without packages.
+void HPWatch(const std::wstring& SourceDir, const std::wstring& OutputDir, const std::vector<HPAssetArgs_s>& Args, const HPCookSettings_s& Settings = {},
+	const HPWatchSettings_s& WatchSettings = {});
\ No newline at end of file
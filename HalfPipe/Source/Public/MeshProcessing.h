@@ -18,6 +18,8 @@ namespace MeshProcessing
 	bool AttributeSort(size_t NumFaces, uint32_t* Attributes, uint32_t* FaceRemap);
 	bool ReorderIndices(index_t* Indices, size_t NumFaces, const uint32_t* FaceRemap, index_t* OutIndices) noexcept;
 	bool OptimizeFacesLRU(index_t* Indices, size_t NumFaces, uint32_t* FaceRemap);
+	// Optimises each subset of faces on its own across the task pool, faces stay in their subset. Subsets must cover every face.
+	bool OptimizeFacesLRU(index_t* Indices, size_t NumFaces, const Subset_s* Subsets, size_t SubsetCount, uint32_t* FaceRemap);
 	bool OptimizeVertices(index_t* Indices, size_t NumFaces, size_t NumVerts, uint32_t* VertexRemap) noexcept;
 	bool FinalizeIndices(index_t* Indices, size_t NumFaces, const uint32_t* VertexRemap, size_t NumVerts, index_t* OutIndices) noexcept;
 	bool FinalizeVertices(void* Vertices, size_t Stride, size_t NumVerts, const uint32_t* VertexRemap) noexcept;
@@ -25,8 +27,8 @@ namespace MeshProcessing
 
 	std::vector<Subset_s> ComputeSubsets(const uint32_t* Attributes, size_t NumFaces);
 
-	bool ComputeNormals(const index_t* Indices, size_t NumFaces, const float3* Positions, size_t NumVerts, float3* Normals) noexcept;
-	bool ComputeTangents(const index_t* Indices, size_t NumFaces, const float3* Positions, const float3* Normals, const float2* Texcoords, size_t NumVerts, float4* Tangents, float3* Bitangents) noexcept;
+	bool ComputeNormals(const index_t* Indices, size_t NumFaces, const float3* Positions, size_t NumVerts, float3* Normals);
+	bool ComputeTangents(const index_t* Indices, size_t NumFaces, const float3* Positions, const float3* Normals, const float2* Texcoords, size_t NumVerts, float4* Tangents, float3* Bitangents);
 
 
 	struct Meshlet_s
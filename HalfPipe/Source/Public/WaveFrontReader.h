@@ -1,6 +1,7 @@
 #pragma once
 
 #include <fstream>
+#include <span>
 #include <string>
 #include <SurfMath.h>
 #include <unordered_map>
@@ -122,6 +123,9 @@ public:
 
 	bool Load(const wchar_t* FileName);
 
+	// Data is the whole file already in memory, FileName names the mesh and locates its material library
+	bool Load(std::span<const uint8_t> Data, const wchar_t* FileName);
+
 	bool LoadMTL(const wchar_t* FileName);
 
 	void Clear();
@@ -130,6 +134,7 @@ private:
 
 	using VertexCache_t = std::unordered_multimap<uint32_t, uint32_t>;
 
+	bool Parse(std::wistream& InFile, const wchar_t* FileName);
 	uint32_t AddVertex(uint32_t Hash, const Vertex_s* Vertex, VertexCache_t& Cache);
 	void LoadTexturePath(std::wifstream& InFile, const std::wstring& BasePath, std::wstring& Texture);
 	void LoadBumpTexturePath(std::wifstream& InFile, const std::wstring& BasePath, float& Scale, std::wstring& Texture);
@@ -2,7 +2,9 @@
 
 #include "HalfPipe.h"
 
+#include <FileUtils/PathUtils.h>
 #include <Logging/Logging.h>
+#include <cwchar>
 #include <fstream>
 #include <string>
 #include <vector>
@@ -22,6 +24,11 @@ int wmain(int argc, wchar_t* argv[])
 
 	std::vector<std::wstring> PackagesToCook;
 	std::vector<HPAssetArgs_s> AssetsToCook;
+	HPCookSettings_s Settings;
+	bool WritePackages = false;
+	bool Report = false;
+	bool Watch = false;
+	HPCookReportSettings_s ReportSettings;
 
 	std::wstring SrcDir;
 	std::wstring OutDir;
@@ -56,6 +63,46 @@ int wmain(int argc, wchar_t* argv[])
 	LOGINFO("Commands:");
 	for (int arg = 5; arg < argc;)
 	{
+		if (std::wstring(argv[arg]) == L"-f")
+		{
+			// Cook everything, ignoring what the cook manifest says is up to date
+			Settings.Incremental = false;
+			LOGINFO("Full cook");
+
+			arg++;
+			continue;
+		}
+
+		if (std::wstring(argv[arg]) == L"-pak")
+		{
+			// Each package cooks on its own into a .hp_pak in the out dir
+			WritePackages = true;
+			LOGINFO("Writing packages");
+
+			arg++;
+			continue;
+		}
+
+		if (std::wstring(argv[arg]) == L"-z")
+		{
+			WritePackages = true;
+			Settings.CompressPackage = true;
+			LOGINFO("Writing compressed packages");
+
+			arg++;
+			continue;
+		}
+
+		if (std::wstring(argv[arg]) == L"-watch")
+		{
+			// Once cooked, keep recooking whatever sources change until closed
+			Watch = true;
+			LOGINFO("Watching for changes");
+
+			arg++;
+			continue;
+		}
+
 		if (arg + 1 >= argc)
 			break;		
 
@@ -92,11 +139,44 @@ int wmain(int argc, wchar_t* argv[])
 			AssetsToCook.push_back(Asset);
 			LOGINFO("Asset: %S", Input.c_str());
 		}
+		else if (Command == L"-j")
+		{
+			// Threads to cook on, 0 or absent for one per hardware thread
+			Settings.ThreadCount = static_cast<uint32_t>(std::wcstoul(Input.c_str(), nullptr, 10));
+			LOGINFO("Threads: %u", Settings.ThreadCount);
+
+			arg += 2;
+		}
+		else if (Command == L"-mem")
+		{
+			// Megabytes the cooks running at once are estimated to need at most, 0 or absent for no limit
+			Settings.MemoryBudget = std::wcstoull(Input.c_str(), nullptr, 10) * 1024 * 1024;
+			LOGINFO("Memory budget: %llu MB", static_cast<unsigned long long>(Settings.MemoryBudget / (1024 * 1024)));
+
+			arg += 2;
+		}
+		else if (Command == L"-report")
+		{
+			// Percent over the baseline an asset's cook time or size is flagged at, checked once any cooking is done
+			Report = true;
+			ReportSettings.Threshold = static_cast<float>(std::wcstod(Input.c_str(), nullptr) / 100.0);
+			LOGINFO("Report regressions over %.0f%%", ReportSettings.Threshold * 100.0f);
+
+			arg += 2;
+		}
+		else
+		{
+			LOGWARNING("Skipping unknown command %S", Command.c_str());
+			arg++;
+		}
 	}
 
-	for(const std::wstring& Package : PackagesToCook)
+	std::vector<std::vector<HPAssetArgs_s>> PackageAssets(PackagesToCook.size());
+
+	for (size_t PackageIt = 0; PackageIt < PackagesToCook.size(); PackageIt++)
 	{
-		std::vector<std::wstring> FilesToCook;
+		const std::wstring& Package = PackagesToCook[PackageIt];
+		std::vector<HPAssetArgs_s>& ListAssets = WritePackages ? PackageAssets[PackageIt] : AssetsToCook;
 
 		std::wifstream ListStream = std::wifstream(SrcDir + L"/" + Package);
 		if (ListStream.is_open())
@@ -110,8 +190,8 @@ int wmain(int argc, wchar_t* argv[])
 
 				if (!Line.starts_with(L"-"))
 				{
-					AssetsToCook.push_back({});
-					CurrentAsset = &AssetsToCook.back();
+					ListAssets.push_back({});
+					CurrentAsset = &ListAssets.back();
 					CurrentAsset->AssetType = Line;
 				}
 				else
@@ -137,7 +217,43 @@ int wmain(int argc, wchar_t* argv[])
 		}
 	}
 
-	HPCook(SrcDir, OutDir, AssetsToCook);
+	for (size_t PackageIt = 0; PackageIt < PackageAssets.size(); PackageIt++)
+	{
+		if (PackageAssets[PackageIt].empty())
+			continue;
+
+		HPCookSettings_s PackageSettings = Settings;
+		PackageSettings.PackagePath = OutDir + L"/" + ReplacePathExtension(PackagesToCook[PackageIt], L"hp_pak");
+		HPCook(SrcDir, OutDir, PackageAssets[PackageIt], PackageSettings);
+	}
+
+	if (!AssetsToCook.empty())
+	{
+		HPCook(SrcDir, OutDir, AssetsToCook, Settings);
+	}
+
+	const bool Regressed = Report && HPReportCookRegressions(OutDir, ReportSettings) > 0;
+
+	if (Watch)
+	{
+		// Watches everything just cooked, packages included, and recooks loose
+		std::vector<HPAssetArgs_s> WatchAssets = AssetsToCook;
+		for (const std::vector<HPAssetArgs_s>& Assets : PackageAssets)
+		{
+			WatchAssets.insert(WatchAssets.end(), Assets.begin(), Assets.end());
+		}
+
+		HPCookSettings_s WatchSettings = Settings;
+		WatchSettings.Incremental = true;
+		WatchSettings.PackagePath.clear();
+		HPWatch(SrcDir, OutDir, WatchAssets, WatchSettings);
+	}
+
+	if (Regressed)
+	{
+		LOGINFO("HalfPipeApp shutdown, cook regressions found");
+		return 2;
+	}
 
 
 	LOGINFO("HalfPipeApp shutdown");
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <FileUtils/FileStream.h>
+#include <HPPackage.h>
 #include <Render/RenderTypes.h>
 
 #include <map>
@@ -14,7 +16,21 @@ struct RTDGlobals_s
 	std::map<std::wstring, std::shared_ptr<struct RTDMaterial_s>> MaterialMap;
 	std::map<std::wstring, std::shared_ptr<struct RTDTexture_s>> TextureMap;
 	rl::RaytracingScenePtr RaytracingScene = {};
+
+	// Packages in the asset directory, and loose cooked files for anything they do not hold
+	HPAssetReader_c AssetReader;
 };
 
 extern RTDGlobals_s Glob;
-extern const std::wstring s_AssetDirectory;
\ No newline at end of file
+extern const std::wstring s_AssetDirectory;
+
+template<typename Asset_t>
+bool LoadCookedAsset(const std::wstring& AssetPath, Asset_t& OutAsset)
+{
+	HPAssetBytes_s Bytes;
+	if (!Glob.AssetReader.Load(AssetPath, Bytes))
+		return false;
+
+	MemoryIFileStream_s Stream(Bytes.Bytes.data(), Bytes.Bytes.size());
+	return OutAsset.Serialize(Stream);
+}
\ No newline at end of file
@@ -44,19 +44,19 @@ bool RTDMaterial_s::Init(const HPWfMtlLib_s::Material_s& Asset)
 			if (TexPath.empty())
 				return nullptr;
 
-			HPTexture_s TextureAsset;
-			if (!TextureAsset.Serialize(s_AssetDirectory + TexPath, FileStreamMode_e::READ))
-			{
-				LOGERROR("Failed to load texture asset");
-				return nullptr;
-			}
-
 			auto TexIt = Glob.TextureMap.find(TexPath);
 			if (TexIt != Glob.TextureMap.end())
 			{
 				return TexIt->second;
 			}
 
+			HPTexture_s TextureAsset;
+			if (!LoadCookedAsset(TexPath, TextureAsset))
+			{
+				LOGERROR("Failed to load texture asset");
+				return nullptr;
+			}
+
 			std::shared_ptr<RTDTexture_s> NewTexture = std::make_shared<RTDTexture_s>();
 			if (NewTexture->Init(TextureAsset))
 			{
@@ -160,7 +160,7 @@ bool RTDModel_s::Init(const HPModel_s* Asset)
 		return false;
 	}
 	
-	if (!MaterialLib.Serialize(s_AssetDirectory + Asset->MaterialLibPath, FileStreamMode_e::READ))
+	if (!LoadCookedAsset(Asset->MaterialLibPath, MaterialLib))
 	{
 		LOGERROR("Material lib % failed to load for model %S, default materials not handled", Asset->SourcePath);
 		return false;
@@ -179,6 +179,9 @@ bool InitializeApp()
 
 	Glob.RaytracingScene = rl::CreateRaytracingScene();
 
+	Glob.AssetReader.SetLooseDir(s_AssetDirectory);
+	Glob.AssetReader.MountPackagesInDir(s_AssetDirectory);
+
 	std::vector<std::wstring> ModelPaths =
 	{
 		L"Models/bistro2.hp_mdl"
@@ -190,7 +193,7 @@ bool InitializeApp()
 	Concurrency::parallel_for((size_t)0u, ModelPaths.size(), [&](size_t i)
 	{
 		HPModel_s LoadedModel;
-		if (LoadedModel.Serialize(s_AssetDirectory + ModelPaths[i], FileStreamMode_e::READ))
+		if (LoadCookedAsset(ModelPaths[i], LoadedModel))
 		{
 			ModelAssets[i] = std::move(LoadedModel);
 		}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <string>
 #include <vector>
@@ -32,6 +35,15 @@ struct FileStream_s
 		}
 	}
 
+	// Reads from memory rather than a file, such as an asset served by a package
+	explicit FileStream_s(const uint8_t* Data, size_t InSize)
+		: Mode(FileStreamMode_e::READ)
+		, Open(Data != nullptr)
+		, Size(InSize)
+		, MemoryData(Data)
+	{
+	}
+
 	virtual ~FileStream_s()
 	{
 		if (InputStream.is_open())
@@ -46,7 +58,19 @@ struct FileStream_s
 	{
 		if (Mode == FileStreamMode_e::READ)
 		{
-			InputStream.read(reinterpret_cast<char*>(Target), sizeof(T) * Count);
+			if (MemoryData)
+			{
+				// Reading past the end leaves zeros, where a file would leave the target as it was
+				const size_t Bytes = sizeof(T) * Count;
+				const size_t Available = std::min(Bytes, Size - MemoryOffset);
+				memcpy(Target, MemoryData + MemoryOffset, Available);
+				memset(reinterpret_cast<uint8_t*>(Target) + Available, 0, Bytes - Available);
+				MemoryOffset += Available;
+			}
+			else
+			{
+				InputStream.read(reinterpret_cast<char*>(Target), sizeof(T) * Count);
+			}
 		}
 	}
 
@@ -172,6 +196,9 @@ protected:
 
 	bool Open = false;
 	size_t Size = 0;
+
+	const uint8_t* MemoryData = nullptr;
+	size_t MemoryOffset = 0;
 };
 
 struct IFileStream_s : public FileStream_s
@@ -187,6 +214,14 @@ struct IFileStream_s : public FileStream_s
 	}
 };
 
+struct MemoryIFileStream_s : public FileStream_s
+{
+	explicit MemoryIFileStream_s(const uint8_t* Data, size_t InSize)
+		: FileStream_s(Data, InSize)
+	{
+	}
+};
+
 struct OFileStream_s : public FileStream_s
 {
 	explicit OFileStream_s(const std::wstring& Path)
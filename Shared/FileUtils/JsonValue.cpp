@@ -25,4 +25,11 @@ bool LoadJsonFromFile(const std::wstring& Path, Json_t& OutJson)
 	}
 
 	return true;
+}
+
+bool LoadJsonFromBytes(std::span<const uint8_t> Bytes, Json_t& OutJson)
+{
+	constexpr bool AllowExceptions = false;
+	OutJson = Json_t::parse(Bytes.begin(), Bytes.end(), nullptr, AllowExceptions);
+	return !OutJson.is_discarded();
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 
 #include <json.hpp>
 
+#include <span>
+
 using Json_t = nlohmann::json;
 
 // Wraps a json value so other headers can forward declare it, keeping json.hpp out of the
@@ -38,4 +40,6 @@ private:
 	mutable uint64_t Hash = -1;
 };
 
-bool LoadJsonFromFile(const std::wstring& Path, Json_t& OutJson);
\ No newline at end of file
+bool LoadJsonFromFile(const std::wstring& Path, Json_t& OutJson);
+// Json already in memory, e.g. an asset read out of a package. Logs nothing, the caller knows what it was reading.
+bool LoadJsonFromBytes(std::span<const uint8_t> Bytes, Json_t& OutJson);
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "MappedFile.h"
+
+#include "Logging/Logging.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include "StringUtils/StringUtils.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile_c::~MappedFile_c()
+{
+	Close();
+}
+
+#if defined(_WIN32)
+
+bool MappedFile_c::Open(const std::wstring& Path)
+{
+	Close();
+
+	HANDLE File = CreateFileW(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (File == INVALID_HANDLE_VALUE)
+	{
+		LOGERROR("[MappedFile] Failed to open %S", Path.c_str());
+		return false;
+	}
+
+	LARGE_INTEGER FileSize = {};
+	if (!GetFileSizeEx(File, &FileSize) || FileSize.QuadPart == 0)
+	{
+		LOGERROR("[MappedFile] %S is empty or its size could not be read", Path.c_str());
+		CloseHandle(File);
+		return false;
+	}
+
+	HANDLE Mapping = CreateFileMappingW(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!Mapping)
+	{
+		LOGERROR("[MappedFile] Failed to create a mapping for %S", Path.c_str());
+		CloseHandle(File);
+		return false;
+	}
+
+	const void* View = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!View)
+	{
+		LOGERROR("[MappedFile] Failed to map %S", Path.c_str());
+		CloseHandle(Mapping);
+		CloseHandle(File);
+		return false;
+	}
+
+	FileHandle = File;
+	MappingHandle = Mapping;
+	Data = static_cast<const uint8_t*>(View);
+	Size = static_cast<size_t>(FileSize.QuadPart);
+
+	return true;
+}
+
+void MappedFile_c::Close()
+{
+	if (Data)
+	{
+		UnmapViewOfFile(Data);
+	}
+
+	if (MappingHandle)
+	{
+		CloseHandle(MappingHandle);
+	}
+
+	if (FileHandle)
+	{
+		CloseHandle(FileHandle);
+	}
+
+	Data = nullptr;
+	Size = 0;
+	FileHandle = nullptr;
+	MappingHandle = nullptr;
+}
+
+#else
+
+bool MappedFile_c::Open(const std::wstring& Path)
+{
+	Close();
+
+	const int File = open(WideToNarrow(Path).c_str(), O_RDONLY);
+	if (File < 0)
+	{
+		LOGERROR("[MappedFile] Failed to open %S", Path.c_str());
+		return false;
+	}
+
+	struct stat FileStat = {};
+	if (fstat(File, &FileStat) != 0 || FileStat.st_size == 0)
+	{
+		LOGERROR("[MappedFile] %S is empty or its size could not be read", Path.c_str());
+		close(File);
+		return false;
+	}
+
+	void* View = mmap(nullptr, static_cast<size_t>(FileStat.st_size), PROT_READ, MAP_PRIVATE, File, 0);
+
+	// The mapping holds its own reference to the file
+	close(File);
+
+	if (View == MAP_FAILED)
+	{
+		LOGERROR("[MappedFile] Failed to map %S", Path.c_str());
+		return false;
+	}
+
+	Data = static_cast<const uint8_t*>(View);
+	Size = static_cast<size_t>(FileStat.st_size);
+
+	return true;
+}
+
+void MappedFile_c::Close()
+{
+	if (Data)
+	{
+		munmap(const_cast<uint8_t*>(Data), Size);
+	}
+
+	Data = nullptr;
+	Size = 0;
+}
+
+#endif
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read only view of a whole file mapped into memory. The OS pages it in as it is touched,
+// so nothing is copied up front and untouched parts of the file are never read.
+class MappedFile_c
+{
+public:
+
+	MappedFile_c() = default;
+	~MappedFile_c();
+
+	MappedFile_c(const MappedFile_c&) = delete;
+	MappedFile_c& operator=(const MappedFile_c&) = delete;
+
+	bool Open(const std::wstring& Path);
+	void Close();
+
+	bool IsOpen() const noexcept { return Data != nullptr; }
+
+	const uint8_t* GetData() const noexcept { return Data; }
+	size_t GetSize() const noexcept { return Size; }
+
+private:
+
+	const uint8_t* Data = nullptr;
+	size_t Size = 0;
+
+#if defined(_WIN32)
+	void* FileHandle = nullptr;
+	void* MappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,98 @@
+#include "SlabPool.h"
+
+#include "Logging/Logging.h"
+
+#include <algorithm>
+
+namespace
+{
+
+// Slabs are sized to hold at least this many bytes of blocks, and never fewer than MinBlocksPerSlab blocks
+constexpr size_t TargetSlabSize = 64 * 1024;
+constexpr uint32_t MinBlocksPerSlab = 16;
+
+size_t AlignUp(size_t Value, size_t Alignment)
+{
+	return (Value + Alignment - 1) & ~(Alignment - 1);
+}
+
+}
+
+SlabPool_c::SlabPool_c(size_t InBlockSize, size_t InBlockAlignment)
+	: BlockSize(AlignUp(std::max(InBlockSize, sizeof(FreeBlock_s)), std::max(InBlockAlignment, alignof(FreeBlock_s))))
+	, BlockAlignment(std::max(InBlockAlignment, alignof(FreeBlock_s)))
+{
+}
+
+SlabPool_c::~SlabPool_c()
+{
+	// Pools are static, anything still alive at exit keeps its memory rather than pointing into freed slabs
+	if (LiveCount > 0)
+	{
+		LOGWARNING("[SlabPool] Pool of %zu byte blocks destroyed with %u blocks still allocated", BlockSize, LiveCount);
+		return;
+	}
+
+	for (void* Slab : Slabs)
+	{
+		::operator delete(Slab, std::align_val_t(BlockAlignment));
+	}
+}
+
+void* SlabPool_c::Allocate()
+{
+	std::lock_guard Lock(Mutex);
+
+	if (!FreeList)
+	{
+		AddSlab(std::max(MinBlocksPerSlab, static_cast<uint32_t>(TargetSlabSize / BlockSize)));
+	}
+
+	FreeBlock_s* Block = FreeList;
+	FreeList = Block->Next;
+	LiveCount++;
+
+	return Block;
+}
+
+void SlabPool_c::Free(void* Block) noexcept
+{
+	if (!Block)
+		return;
+
+	std::lock_guard Lock(Mutex);
+
+	FreeBlock_s* FreedBlock = static_cast<FreeBlock_s*>(Block);
+	FreedBlock->Next = FreeList;
+	FreeList = FreedBlock;
+	LiveCount--;
+}
+
+SlabPool_c::Stats_s SlabPool_c::GetStats() const
+{
+	std::lock_guard Lock(Mutex);
+
+	Stats_s Stats;
+	Stats.BlockSize = BlockSize;
+	Stats.SlabCount = static_cast<uint32_t>(Slabs.size());
+	Stats.LiveCount = LiveCount;
+	Stats.Capacity = Capacity;
+	return Stats;
+}
+
+void SlabPool_c::AddSlab(uint32_t BlockCount)
+{
+	uint8_t* const Slab = static_cast<uint8_t*>(::operator new(BlockCount * BlockSize, std::align_val_t(BlockAlignment)));
+	Slabs.push_back(Slab);
+	Capacity += BlockCount;
+
+	// Thread the new blocks onto the free list in address order, so fresh allocations walk forward through the slab
+	FreeBlock_s* Next = FreeList;
+	for (uint32_t BlockIt = BlockCount; BlockIt-- > 0;)
+	{
+		FreeBlock_s* Block = reinterpret_cast<FreeBlock_s*>(Slab + BlockIt * BlockSize);
+		Block->Next = Next;
+		Next = Block;
+	}
+	FreeList = Next;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// Fixed size blocks carved out of large slabs, recycled through an intrusive free list.
+// Blocks of one pool sit next to each other in memory and a free is reused by the next allocation,
+// so instances of a class stay packed however they come and go. Allocate and Free may be called from any thread.
+class SlabPool_c
+{
+public:
+
+	struct Stats_s
+	{
+		size_t BlockSize = 0;
+		uint32_t SlabCount = 0;
+		uint32_t LiveCount = 0;
+		uint32_t Capacity = 0;
+	};
+
+	SlabPool_c(size_t InBlockSize, size_t InBlockAlignment);
+	~SlabPool_c();
+
+	SlabPool_c(const SlabPool_c&) = delete;
+	SlabPool_c& operator=(const SlabPool_c&) = delete;
+
+	void* Allocate();
+	void Free(void* Block) noexcept;
+
+	Stats_s GetStats() const;
+
+	// One pool per type, shared by everything that allocates it
+	template<class Type>
+	static SlabPool_c& Get()
+	{
+		static SlabPool_c Pool(sizeof(Type), alignof(Type));
+		return Pool;
+	}
+
+private:
+
+	struct FreeBlock_s
+	{
+		FreeBlock_s* Next;
+	};
+
+	void AddSlab(uint32_t BlockCount);
+
+	const size_t BlockSize;
+	const size_t BlockAlignment;
+
+	mutable std::mutex Mutex;
+	FreeBlock_s* FreeList = nullptr;
+	std::vector<void*> Slabs;
+	uint32_t LiveCount = 0;
+	uint32_t Capacity = 0;
+};
+
+// Allocator for std::allocate_shared that takes single allocations from the SlabPool_c of the type being allocated.
+// allocate_shared rebinds it to its own block holding the control block and the instance, so each class gets a pool
+// sized for exactly that, and the instance keeps plain shared_ptr ownership.
+template<class Type>
+struct SlabAllocator_t
+{
+	using value_type = Type;
+
+	SlabAllocator_t() noexcept = default;
+
+	template<class OtherType>
+	SlabAllocator_t(const SlabAllocator_t<OtherType>&) noexcept {}
+
+	Type* allocate(size_t Count)
+	{
+		if (Count != 1)
+			return static_cast<Type*>(::operator new(Count * sizeof(Type), std::align_val_t(alignof(Type))));
+
+		return static_cast<Type*>(SlabPool_c::Get<Type>().Allocate());
+	}
+
+	void deallocate(Type* Pointer, size_t Count) noexcept
+	{
+		if (Count != 1)
+		{
+			::operator delete(Pointer, std::align_val_t(alignof(Type)));
+			return;
+		}
+
+		SlabPool_c::Get<Type>().Free(Pointer);
+	}
+
+	template<class OtherType>
+	bool operator==(const SlabAllocator_t<OtherType>&) const noexcept { return true; }
+};
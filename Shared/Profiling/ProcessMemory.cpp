@@ -0,0 +1,82 @@
+#include "ProcessMemory.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#include <Psapi.h>
+#elif defined(__linux__)
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+uint64_t GetProcessResidentBytes()
+{
+	PROCESS_MEMORY_COUNTERS Counters = {};
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &Counters, sizeof(Counters)))
+		return 0;
+
+	return Counters.WorkingSetSize;
+}
+
+uint64_t GetProcessPeakResidentBytes()
+{
+	PROCESS_MEMORY_COUNTERS Counters = {};
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &Counters, sizeof(Counters)))
+		return 0;
+
+	return Counters.PeakWorkingSetSize;
+}
+
+#elif defined(__linux__)
+
+uint64_t GetProcessResidentBytes()
+{
+	FILE* File = fopen("/proc/self/statm", "r");
+	if (!File)
+		return 0;
+
+	unsigned long long Pages = 0;
+	unsigned long long ResidentPages = 0;
+	const int Read = fscanf(File, "%llu %llu", &Pages, &ResidentPages);
+	fclose(File);
+
+	return Read == 2 ? ResidentPages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) : 0;
+}
+
+uint64_t GetProcessPeakResidentBytes()
+{
+	FILE* File = fopen("/proc/self/status", "r");
+	if (!File)
+		return 0;
+
+	uint64_t Peak = 0;
+	char Line[256];
+	while (fgets(Line, sizeof(Line), File))
+	{
+		unsigned long long Kilobytes = 0;
+		if (strncmp(Line, "VmHWM:", 6) == 0 && sscanf(Line + 6, "%llu", &Kilobytes) == 1)
+		{
+			Peak = Kilobytes * 1024;
+			break;
+		}
+	}
+	fclose(File);
+
+	return Peak;
+}
+
+#else
+
+uint64_t GetProcessResidentBytes()
+{
+	return 0;
+}
+
+uint64_t GetProcessPeakResidentBytes()
+{
+	return 0;
+}
+
+#endif
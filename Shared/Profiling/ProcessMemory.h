@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+
+// Resident memory of this process in bytes, the working set on Windows, 0 where it can not be read
+uint64_t GetProcessResidentBytes();
+
+// The most the process has been resident at since it started
+uint64_t GetProcessPeakResidentBytes();
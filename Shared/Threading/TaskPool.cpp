@@ -0,0 +1,169 @@
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+TaskPool_c::TaskPool_c(uint32_t WorkerCount)
+{
+	Workers.reserve(WorkerCount);
+	for (uint32_t WorkerIt = 0; WorkerIt < WorkerCount; WorkerIt++)
+	{
+		Workers.emplace_back([this]() { WorkerMain(); });
+	}
+}
+
+TaskPool_c::~TaskPool_c()
+{
+	{
+		std::lock_guard Lock(QueueMutex);
+		Stopping = true;
+	}
+	QueueCondition.notify_all();
+
+	for (std::thread& Worker : Workers)
+	{
+		Worker.join();
+	}
+}
+
+TaskPool_c& TaskPool_c::Get()
+{
+	static TaskPool_c Pool(std::max(std::thread::hardware_concurrency(), 2u) - 1u);
+	return Pool;
+}
+
+void TaskPool_c::Push(Task_t Task)
+{
+	{
+		std::lock_guard Lock(QueueMutex);
+		Queue.push_back(std::move(Task));
+	}
+	QueueCondition.notify_one();
+}
+
+void TaskPool_c::Wait()
+{
+	while (TryRunTask()) {}
+
+	std::unique_lock Lock(QueueMutex);
+	IdleCondition.wait(Lock, [this]() { return Queue.empty() && RunningCount == 0; });
+}
+
+bool TaskPool_c::TryRunTask()
+{
+	Task_t Task;
+	{
+		std::lock_guard Lock(QueueMutex);
+		if (Queue.empty())
+			return false;
+
+		Task = std::move(Queue.front());
+		Queue.pop_front();
+		RunningCount++;
+	}
+
+	Task();
+
+	{
+		std::lock_guard Lock(QueueMutex);
+		RunningCount--;
+	}
+	IdleCondition.notify_all();
+
+	return true;
+}
+
+void TaskPool_c::WorkerMain()
+{
+	for (;;)
+	{
+		Task_t Task;
+		{
+			std::unique_lock Lock(QueueMutex);
+			QueueCondition.wait(Lock, [this]() { return Stopping || !Queue.empty(); });
+
+			if (Queue.empty())
+				return; // Stopping
+
+			Task = std::move(Queue.front());
+			Queue.pop_front();
+			RunningCount++;
+		}
+
+		Task();
+
+		{
+			std::lock_guard Lock(QueueMutex);
+			RunningCount--;
+		}
+		IdleCondition.notify_all();
+	}
+}
+
+void TaskPool_c::ParallelFor(uint32_t Count, uint32_t BatchSize, const RangeTask_t& Function)
+{
+	ParallelForWithScratch(Count, BatchSize, [&Function](uint32_t, uint32_t Begin, uint32_t End)
+	{
+		Function(Begin, End);
+	});
+}
+
+void TaskPool_c::ParallelForWithScratch(uint32_t Count, uint32_t BatchSize, const ScratchRangeTask_t& Function)
+{
+	if (Count == 0)
+		return;
+
+	BatchSize = std::max(BatchSize, 1u);
+	const uint32_t BatchCount = (Count + BatchSize - 1) / BatchSize;
+
+	if (BatchCount == 1 || Workers.empty())
+	{
+		Function(0, 0, Count);
+		return;
+	}
+
+	// Helpers that start after every batch has been claimed find nothing to do and return, so the state
+	// is shared with them rather than living on this stack frame
+	struct ParallelForState_s
+	{
+		std::atomic<uint32_t> NextBatch = 0;
+		std::atomic<uint32_t> CompletedBatches = 0;
+		std::atomic<uint32_t> NextScratchIndex = 0;
+	};
+
+	std::shared_ptr<ParallelForState_s> State = std::make_shared<ParallelForState_s>();
+
+	// Each call runs start to end on one thread and there is one per helper plus the caller, so a scratch index
+	// per call is unique among the batches running and stays below GetMaxParallelism()
+	auto RunBatches = [State, Count, BatchSize, BatchCount, &Function]()
+	{
+		uint32_t Batch = State->NextBatch.fetch_add(1);
+		if (Batch >= BatchCount)
+			return;
+
+		const uint32_t ScratchIndex = State->NextScratchIndex.fetch_add(1);
+		for (; Batch < BatchCount; Batch = State->NextBatch.fetch_add(1))
+		{
+			const uint32_t Begin = Batch * BatchSize;
+			Function(ScratchIndex, Begin, std::min(Begin + BatchSize, Count));
+			State->CompletedBatches.fetch_add(1, std::memory_order_release);
+		}
+	};
+
+	const uint32_t HelperCount = std::min(BatchCount - 1, GetWorkerCount());
+	for (uint32_t HelperIt = 0; HelperIt < HelperCount; HelperIt++)
+	{
+		// Function is only referenced by helpers that claim a batch, which completes before this call returns
+		Push(RunBatches);
+	}
+
+	RunBatches();
+
+	// Every batch is claimed, the rest are already running on other threads. Not helping with other queued tasks
+	// here, they may be long and the caller is often a frame waiting on its own work.
+	while (State->CompletedBatches.load(std::memory_order_acquire) < BatchCount)
+	{
+		std::this_thread::yield();
+	}
+}
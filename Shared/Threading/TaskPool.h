@@ -0,0 +1,60 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads pulling tasks from a shared queue.
+class TaskPool_c
+{
+public:
+
+	using Task_t = std::function<void()>;
+	using RangeTask_t = std::function<void(uint32_t Begin, uint32_t End)>;
+	using ScratchRangeTask_t = std::function<void(uint32_t ScratchIndex, uint32_t Begin, uint32_t End)>;
+
+	explicit TaskPool_c(uint32_t WorkerCount);
+	~TaskPool_c();
+
+	TaskPool_c(const TaskPool_c&) = delete;
+	TaskPool_c& operator=(const TaskPool_c&) = delete;
+
+	// Shared pool with a worker per hardware thread, less one for the thread that waits on it
+	static TaskPool_c& Get();
+
+	uint32_t GetWorkerCount() const noexcept { return static_cast<uint32_t>(Workers.size()); }
+
+	void Push(Task_t Task);
+
+	// Runs queued tasks on the calling thread until the queue is empty and no task is running
+	void Wait();
+
+	// Splits [0, Count) into batches of at most BatchSize and runs them across the workers and the calling thread.
+	// Returns once every batch has finished. Safe to call from inside a task.
+	void ParallelFor(uint32_t Count, uint32_t BatchSize, const RangeTask_t& Function);
+
+	// ParallelFor that also passes each batch a ScratchIndex below GetMaxParallelism(). Batches running at the same time
+	// never share an index, so per-thread scratch can be an array indexed by it without locking.
+	void ParallelForWithScratch(uint32_t Count, uint32_t BatchSize, const ScratchRangeTask_t& Function);
+
+	// The workers plus the thread calling ParallelFor
+	uint32_t GetMaxParallelism() const noexcept { return GetWorkerCount() + 1; }
+
+private:
+
+	bool TryRunTask();
+	void WorkerMain();
+
+	std::vector<std::thread> Workers;
+
+	std::mutex QueueMutex;
+	std::condition_variable QueueCondition;
+	std::condition_variable IdleCondition;
+	std::deque<Task_t> Queue;
+	uint32_t RunningCount = 0;
+	bool Stopping = false;
+};